@@ -0,0 +1,22 @@
+# Rodado a cada build pelo alvo GrauB2Commit (cmake -P): grava o commit atual em OUTPUT.
+# O arquivo so e reescrito quando o commit muda, entao o GrauB2Bench so recompila nesse caso.
+set(CONTENT "// Gerado pelo build: commit atual para o JSON do GrauB2Bench\n")
+if(GIT_EXECUTABLE)
+    execute_process(
+        COMMAND ${GIT_EXECUTABLE} rev-parse --short HEAD
+        WORKING_DIRECTORY ${SOURCE_DIR}
+        OUTPUT_VARIABLE COMMIT
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        ERROR_QUIET)
+    if(COMMIT)
+        string(APPEND CONTENT "#define GRAUB2_GIT_COMMIT \"${COMMIT}\"\n")
+    endif()
+endif()
+
+set(OLD_CONTENT "")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} OLD_CONTENT)
+endif()
+if(NOT OLD_CONTENT STREQUAL CONTENT)
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
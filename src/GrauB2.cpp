@@ -18,12 +18,37 @@
 #include <set>
 #include <algorithm>
 #include <regex>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+#include <thread>
+#include <cstdlib>
+#include <random>
+#include <memory>
+#include <sys/stat.h>
+#include <cfloat>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+#include <string_view>
+#include <unordered_map>
+#include <new>
 
 #ifdef _WIN32
 #include <direct.h>
 #define getcwd _getcwd
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
 #endif
 
 using namespace std;
@@ -38,10 +63,25 @@ using namespace std;
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+// Commit atual, gravado a cada build pelo alvo GrauB2Commit (so no GrauB2Bench)
+#ifdef GRAUB2_COMMIT_HEADER
+#include "GrauB2Commit.h"
+#endif
+
+// EGL para o modo headless (contexto sem janela, ex.: Mesa llvmpipe)
+#ifdef GRAUB2_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 using namespace glm;
 
 #include <cmath>
@@ -50,6 +90,224 @@ using namespace glm;
 #define M_PI 3.14159265358979323846
 #endif
 
+// Profiler de CPU: PROFILE_SCOPE("nome") mede o escopo atual e grava a amostra no ring
+// buffer da thread (um escritor por buffer, sem locks no caminho quente). O trace pode
+// ser salvo no formato trace_event do Chrome (chrome://tracing ou ui.perfetto.dev).
+// Sem GRAUB2_PROFILER as macros nao geram codigo.
+#ifdef GRAUB2_PROFILER
+struct ProfileSample {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+};
+
+const size_t PROFILE_RING_SIZE = 1 << 16; // Potencia de 2: o indice usa mascara
+
+struct ProfileThreadBuffer {
+    ProfileSample samples[PROFILE_RING_SIZE];
+    std::atomic<uint64_t> writeIndex{0};      // Total de amostras ja escritas
+    uint32_t threadId = 0;
+    const char* trackName = nullptr;          // Nome exibido no trace (ex.: "GPU")
+};
+
+struct Profiler {
+    std::mutex registryMutex;                 // So usado no registro de cada thread e no dump
+    std::vector<ProfileThreadBuffer*> buffers;
+    std::vector<ProfileThreadBuffer*> freeBuffers; // De threads que ja terminaram, para reuso
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+} profiler;
+
+inline uint64_t profilerNowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - profiler.origin).count();
+}
+
+// Devolve o buffer a lista livre quando a thread termina (ex.: uma thread por hot reload):
+// a memoria fica limitada ao numero de threads vivas ao mesmo tempo. As amostras continuam
+// no buffer e aparecem no dump; a proxima thread continua na mesma trilha.
+struct ProfileThreadSlot {
+    ProfileThreadBuffer* buffer = nullptr;
+    ~ProfileThreadSlot() {
+        if (buffer != nullptr) {
+            std::lock_guard<std::mutex> lock(profiler.registryMutex);
+            profiler.freeBuffers.push_back(buffer);
+        }
+    }
+};
+
+// Buffer da thread atual, pego da lista livre ou criado e registrado na primeira amostra
+inline ProfileThreadBuffer* profilerThreadBuffer() {
+    thread_local ProfileThreadSlot slot;
+    if (slot.buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(profiler.registryMutex);
+        if (!profiler.freeBuffers.empty()) {
+            slot.buffer = profiler.freeBuffers.back();
+            profiler.freeBuffers.pop_back();
+        } else {
+            slot.buffer = new ProfileThreadBuffer();
+            slot.buffer->threadId = (uint32_t)profiler.buffers.size() + 1;
+            profiler.buffers.push_back(slot.buffer);
+        }
+    }
+    return slot.buffer;
+}
+
+// Cria uma trilha extra no trace que nao pertence a uma thread (ex.: tempos da GPU)
+inline ProfileThreadBuffer* profilerCreateTrack(const char* trackName) {
+    ProfileThreadBuffer* buffer = new ProfileThreadBuffer();
+    buffer->trackName = trackName;
+    std::lock_guard<std::mutex> lock(profiler.registryMutex);
+    buffer->threadId = (uint32_t)profiler.buffers.size() + 1;
+    profiler.buffers.push_back(buffer);
+    return buffer;
+}
+
+// Grava uma amostra; cada buffer deve ter um unico escritor
+inline void profilerRecord(ProfileThreadBuffer* buffer, const char* name, uint64_t startNs, uint64_t endNs) {
+    uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+    ProfileSample& sample = buffer->samples[index & (PROFILE_RING_SIZE - 1)];
+    sample.name = name;
+    sample.startNs = startNs;
+    sample.endNs = endNs;
+    buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+struct ProfileScope {
+    const char* name;
+    uint64_t start;
+    explicit ProfileScope(const char* scopeName) : name(scopeName), start(profilerNowNs()) {}
+    ~ProfileScope() {
+        profilerRecord(profilerThreadBuffer(), name, start, profilerNowNs());
+    }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+// Log assincrono: LOG_INFO("texto " << valor) formata na thread que chama, copia a linha
+// para uma fila circular sem locks (varios produtores, um consumidor) e volta; uma thread
+// de fundo escreve no stdout em lotes, com um unico flush por lote. Fila cheia descarta
+// a mensagem em vez de bloquear o frame. Niveis abaixo de GRAUB2_LOG_LEVEL somem na
+// compilacao (padrao: INFO, ou seja, LOG_DEBUG nao gera codigo).
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+
+#ifndef GRAUB2_LOG_LEVEL
+#define GRAUB2_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+const size_t LOG_QUEUE_SIZE = 1024;       // Potencia de 2: o indice usa mascara
+const size_t LOG_MESSAGE_MAX = 512;       // Mensagens maiores sao truncadas
+
+struct LogEntry {
+    std::atomic<size_t> sequence{0};      // Indica se a celula esta livre ou pronta para leitura
+    int level = LOG_LEVEL_INFO;
+    char text[LOG_MESSAGE_MAX];
+};
+
+struct AsyncLogger {
+    LogEntry entries[LOG_QUEUE_SIZE];
+    std::atomic<size_t> enqueuePos{0};
+    size_t dequeuePos = 0;                // So a thread escritora mexe
+    std::atomic<bool> running{false};
+    std::atomic<unsigned> dropped{0};
+    std::thread writer;
+
+    AsyncLogger() {
+        for (size_t i = 0; i < LOG_QUEUE_SIZE; i++) {
+            entries[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+} logger;
+
+// Enfileira sem bloquear; retorna false (e conta o descarte) se a fila estiver cheia
+inline bool logPush(int level, const std::string& message) {
+    size_t pos = logger.enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        LogEntry& entry = logger.entries[pos & (LOG_QUEUE_SIZE - 1)];
+        size_t sequence = entry.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (logger.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                entry.level = level;
+                size_t length = std::min(message.size(), LOG_MESSAGE_MAX - 1);
+                memcpy(entry.text, message.data(), length);
+                entry.text[length] = '\0';
+                entry.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            logger.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = logger.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Esvazia a fila (somente na thread escritora ou depois que ela terminou)
+inline size_t logDrain(FILE* out) {
+    static const char* LEVEL_PREFIX[] = { "[debug] ", "", "[aviso] ", "[erro] " };
+    size_t written = 0;
+    for (;;) {
+        LogEntry& entry = logger.entries[logger.dequeuePos & (LOG_QUEUE_SIZE - 1)];
+        if (entry.sequence.load(std::memory_order_acquire) != logger.dequeuePos + 1) {
+            break;
+        }
+        fprintf(out, "%s%s\n", LEVEL_PREFIX[entry.level], entry.text);
+        entry.sequence.store(logger.dequeuePos + LOG_QUEUE_SIZE, std::memory_order_release);
+        logger.dequeuePos++;
+        written++;
+    }
+    unsigned dropped = logger.dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        fprintf(out, "[aviso] %u mensagens de log descartadas (fila cheia)\n", dropped);
+    }
+    if (written > 0 || dropped > 0) {
+        fflush(out);
+    }
+    return written;
+}
+
+inline void logShutdown() {
+    if (logger.running.exchange(false)) {
+        logger.writer.join();
+    }
+    logDrain(stdout);
+}
+
+// Inicia a thread escritora; o que foi enfileirado antes disso sai no primeiro lote
+inline void logInit() {
+    if (logger.running.exchange(true)) {
+        return;
+    }
+    logger.writer = std::thread([]() {
+        while (logger.running.load(std::memory_order_acquire)) {
+            if (logDrain(stdout) == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+    });
+    std::atexit(logShutdown);
+}
+
+#define LOG_AT(level, expr) do { std::ostringstream logStream_; logStream_ << expr; logPush(level, logStream_.str()); } while (0)
+
+#if GRAUB2_LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(expr) LOG_AT(LOG_LEVEL_DEBUG, expr)
+#else
+#define LOG_DEBUG(expr) ((void)0)
+#endif
+#define LOG_INFO(expr) LOG_AT(LOG_LEVEL_INFO, expr)
+#define LOG_WARN(expr) LOG_AT(LOG_LEVEL_WARN, expr)
+#define LOG_ERROR(expr) LOG_AT(LOG_LEVEL_ERROR, expr)
+
 // Struct para representar propriedades do material
 struct Material {
     std::string name = "default";
@@ -59,6 +317,7 @@ struct Material {
     float shininess = 32.0f;                      // Brilho especular (Ns no .mtl)
     std::string diffuseTexture = "";              // Caminho da textura difusa (map_Kd)
     GLuint textureID = 0;                         // ID da textura carregada
+    std::string texturePath = "";                 // Arquivo de onde a textura foi lida (hot reload)
 };
 
 // Struct para representar uma parte de um modelo com material especifico
@@ -66,19 +325,71 @@ struct ModelPart {
     std::vector<glm::vec3> vertices;
     std::vector<glm::vec2> uvs;
     std::vector<glm::vec3> normals;
-    Material material;
-    GLuint VAO;
+    uint32_t materialId = 0;   // Indice em Model::materials
+    GLuint VAO = 0;
+    GLuint depthVAO = 0;       // VAO apenas com posicoes (pre-pass de profundidade)
     int nVertices;
     std::string materialName;
+    glm::vec3 boundsMin = glm::vec3(0.0f);  // AABB local (computeSceneBounds)
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    bool visible = true;                    // Resultado do frustum culling do frame
+    int node = -1;                          // No proprio na hierarquia (PART), -1 = usa o do modelo
+    bool keepPositions = false;             // Posicoes ficam na CPU em qualquer residencia (linha da pista)
+};
+
+// Parte promovida a no da hierarquia (PART no config): gira em torno de um pivo local
+struct PartNodeConfig {
+    std::string part;                       // Material das partes (uma parte por material)
+    glm::vec3 axis = glm::vec3(1.0f, 0.0f, 0.0f);
+    float speed = 0.0f;                     // Graus por segundo (0 = so acompanha o modelo)
+    glm::vec3 pivot = glm::vec3(0.0f);
+    bool autoPivot = true;                  // Pivo no centro da caixa da parte
 };
 
 // Struct para representar um modelo 3D (pode ter múltiplas partes com materiais diferentes)
 struct Model {
     std::vector<ModelPart> parts;  // Lista de partes com materiais diferentes
+    std::vector<Material> materials; // Materiais do MTL; as partes guardam o indice
     glm::vec3 position = glm::vec3(0.0f);
     glm::vec3 rotation = glm::vec3(0.0f);
     glm::vec3 scale = glm::vec3(1.0f);
     std::string name;              // Nome do modelo para debug
+    glm::mat4 worldMatrix = glm::mat4(1.0f); // Atualizada a cada frame em updateSceneTransforms
+    int parent = -1;                         // Modelo pai (PARENT): transformacao relativa a ele
+    std::vector<PartNodeConfig> partNodes;   // Partes com transformacao propria
+};
+
+// Hierarquia de transformacoes: um no por modelo e um por parte promovida (PART), num
+// vetor em ordem topologica (pai sempre antes do filho). A atualizacao e uma passada
+// linear: so recalcula a matriz de mundo de quem mudou ou tem um ancestral que mudou.
+struct SceneNode {
+    int parent = -1;                         // Indice do no pai em sceneGraph.nodes
+    int model = -1;
+    int part = -1;                           // -1 = no raiz do modelo
+    glm::vec3 position, rotation, scale;     // TRS do modelo usado na ultima matriz local
+    glm::vec3 pivot, axis;                   // Nos de parte: giro em torno do pivo
+    float speed = 0.0f;
+    float angle = 0.0f;
+    glm::mat4 local = glm::mat4(1.0f);
+    glm::mat4 world = glm::mat4(1.0f);
+    bool localDirty = true;                  // Matriz local mudou desde a ultima passada
+    bool worldChanged = false;               // Matriz de mundo recalculada nesta passada
+};
+
+struct SceneGraph {
+    std::vector<SceneNode> nodes;
+    std::vector<int> modelNode;              // No raiz de cada modelo
+    size_t updatedNodes = 0;                 // Matrizes de mundo recalculadas no ultimo frame
+} sceneGraph;
+
+// Entrada da montagem da hierarquia, por modelo: pai (vira -1 se fechar um ciclo), malha
+// (nomes e caixas das partes) e PART. Separada de models para que a thread de recarga
+// monte o grafo da cena seguinte sem tocar na cena atual.
+struct SceneGraphSource {
+    int parent = -1;
+    const Model* mesh = nullptr;
+    const std::vector<PartNodeConfig>* partNodes = nullptr;
+    const std::string* name = nullptr;
 };
 
 // Struct para representar a câmera
@@ -95,7 +406,7 @@ enum AnimationType {
     ANIM_BEZIER,
     ANIM_BEZIER_TRACK,  // Nova animação para seguir pista
     ANIM_ORBIT,
-    ANIM_LINEAR
+    ANIM_LINEAR         // Trilha de keyframes (KEYFRAMES arquivo)
 };
 
 // Struct para curva Bézier cúbica
@@ -108,8 +419,17 @@ struct BezierCurve {
 // Struct para track com múltiplas curvas de Bézier
 struct BezierTrack {
     std::vector<BezierCurve> curves;  // Sequência de curvas
-    float totalDuration;              // Duração total do percurso
-    bool loop;                        // Se deve repetir o percurso
+    float totalDuration = 0.0f;       // Duração total do percurso
+    bool loop = false;                // Se deve repetir o percurso
+
+    // Tabela de comprimento de arco (buildArcLengthTable): distancia acumulada desde o
+    // inicio da pista, curva e t local de cada amostra. Distancias em double e curva
+    // separada do t para nao perder precisao em pistas com muitas curvas.
+    // Vazia = amostragem antiga por tempo de cada curva.
+    std::vector<double> arcDistance;
+    std::vector<uint32_t> arcCurve;
+    std::vector<float> arcT;
+    double totalLength = 0.0;
 };
 
 // Struct para animacao orbital
@@ -120,15 +440,312 @@ struct OrbitAnimation {
     glm::vec3 axis;            // Eixo de rotacao (padrao Y)
 };
 
+// Quaternion unitario comprimido em 48 bits ("smallest three"): a maior componente e
+// descartada (recuperada pela norma) e as outras tres, em [-1/sqrt2, 1/sqrt2], viram
+// inteiros de 15 bits. O indice da descartada ocupa o bit alto de data[0] e data[1].
+struct PackedQuat {
+    uint16_t data[3];
+};
+
+// Trilha de keyframes compartilhada (ANIM_LINEAR). Cada canal guarda so as chaves que
+// sobreviveram a reducao por tolerancia, com seus proprios tempos.
+struct KeyframeTrack {
+    std::vector<float> positionTimes;
+    std::vector<glm::vec3> positions;
+    std::vector<float> rotationTimes;
+    std::vector<PackedQuat> rotations;
+    std::vector<float> scaleTimes;
+    std::vector<glm::vec3> scales;
+    float duration = 0.0f;            // Tempo da ultima chave
+    bool loop = true;
+};
+
+// Ultima chave usada em cada canal: reproducao sequencial acha a proxima em O(1)
+struct KeyframeCursor {
+    size_t position = 0;
+    size_t rotation = 0;
+    size_t scale = 0;
+};
+
 // Struct para animacao de um objeto
 struct ObjectAnimation {
     AnimationType type = ANIM_NONE;
     BezierCurve bezier;
-    BezierTrack bezierTrack;    // Nova animação de pista
+    std::shared_ptr<const BezierTrack> bezierTrack; // Pista compartilhada (trackCache)
     OrbitAnimation orbit;
     glm::vec3 originalPosition; // Posicao original do objeto
+    bool trackFromMesh = false; // ANIMATION track: pista extraida da parte Asphalt da malha
+    std::shared_ptr<const KeyframeTrack> keyframes; // Trilha compartilhada (keyframeCache)
+    KeyframeCursor cursor;      // Estado de reproducao deste objeto
+    float timeOffset = 0.0f;    // PHASE: segundos adiantados em relacao ao tempo global
+};
+
+// SIMD para os kernels de animacao: SimdFloat embrulha AVX2 (8 floats), SSE2 (4) ou um
+// float escalar, conforme o que o compilador habilitou (ver GRAUB2_AVX2 no CMake). Os
+// kernels sao escritos uma vez sobre essas operacoes.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_NAME "AVX2"
+struct SimdFloat {
+    __m256 v;
+    static const int WIDTH = 8;
+    SimdFloat() {}
+    SimdFloat(__m256 x) : v(x) {}
+    SimdFloat(float x) : v(_mm256_set1_ps(x)) {}
+    static SimdFloat load(const float* p) { return _mm256_loadu_ps(p); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+inline SimdFloat operator+(SimdFloat a, SimdFloat b) { return _mm256_add_ps(a.v, b.v); }
+inline SimdFloat operator-(SimdFloat a, SimdFloat b) { return _mm256_sub_ps(a.v, b.v); }
+inline SimdFloat operator*(SimdFloat a, SimdFloat b) { return _mm256_mul_ps(a.v, b.v); }
+inline SimdFloat simdMin(SimdFloat a, SimdFloat b) { return _mm256_min_ps(a.v, b.v); }
+inline SimdFloat simdMax(SimdFloat a, SimdFloat b) { return _mm256_max_ps(a.v, b.v); }
+inline SimdFloat simdFloor(SimdFloat a) { return _mm256_floor_ps(a.v); }
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMD_NAME "SSE2"
+struct SimdFloat {
+    __m128 v;
+    static const int WIDTH = 4;
+    SimdFloat() {}
+    SimdFloat(__m128 x) : v(x) {}
+    SimdFloat(float x) : v(_mm_set1_ps(x)) {}
+    static SimdFloat load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+inline SimdFloat operator+(SimdFloat a, SimdFloat b) { return _mm_add_ps(a.v, b.v); }
+inline SimdFloat operator-(SimdFloat a, SimdFloat b) { return _mm_sub_ps(a.v, b.v); }
+inline SimdFloat operator*(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a.v, b.v); }
+inline SimdFloat simdMin(SimdFloat a, SimdFloat b) { return _mm_min_ps(a.v, b.v); }
+inline SimdFloat simdMax(SimdFloat a, SimdFloat b) { return _mm_max_ps(a.v, b.v); }
+// SSE2 nao tem floor: trunca e corrige os negativos (valido para |x| < 2^31)
+inline SimdFloat simdFloor(SimdFloat a) {
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.0f)));
+}
+#else
+#define SIMD_NAME "escalar"
+struct SimdFloat {
+    float v;
+    static const int WIDTH = 1;
+    SimdFloat() {}
+    SimdFloat(float x) : v(x) {}
+    static SimdFloat load(const float* p) { return *p; }
+    void store(float* p) const { *p = v; }
+};
+inline SimdFloat operator+(SimdFloat a, SimdFloat b) { return a.v + b.v; }
+inline SimdFloat operator-(SimdFloat a, SimdFloat b) { return a.v - b.v; }
+inline SimdFloat operator*(SimdFloat a, SimdFloat b) { return a.v * b.v; }
+inline SimdFloat simdMin(SimdFloat a, SimdFloat b) { return std::min(a.v, b.v); }
+inline SimdFloat simdMax(SimdFloat a, SimdFloat b) { return std::max(a.v, b.v); }
+inline SimdFloat simdFloor(SimdFloat a) { return std::floor(a.v); }
+#endif
+
+// Seno vetorial: reduz para [-pi, pi], reflete para [-pi/2, pi/2] e usa o polinomio de
+// Taylor de grau 9 (erro < 4e-6)
+inline SimdFloat simdSin(SimdFloat x) {
+    const float PI = (float)M_PI;
+    x = x - simdFloor((x + PI) * (float)(0.5 / M_PI)) * (2.0f * PI);
+    x = simdMax(simdMin(x, SimdFloat(PI) - x), SimdFloat(-PI) - x);
+    SimdFloat x2 = x * x;
+    SimdFloat poly = SimdFloat(1.0f / 362880.0f) * x2 + SimdFloat(-1.0f / 5040.0f);
+    poly = poly * x2 + SimdFloat(1.0f / 120.0f);
+    poly = poly * x2 + SimdFloat(-1.0f / 6.0f);
+    poly = poly * x2 + SimdFloat(1.0f);
+    return poly * x;
+}
+
+// Saida dos kernels: buffer de transformacoes em SoA, na mesma ordem do lote
+struct AnimationStream {
+    std::vector<float> position[3];
+    std::vector<float> rotationX, rotationY;
+
+    void resize(size_t size) {
+        for (auto& array : position) array.assign(size, 0.0f);
+        rotationX.assign(size, 0.0f);
+        rotationY.assign(size, 0.0f);
+    }
+};
+
+// Animacoes agrupadas por tipo em estrutura de arrays (um array por campo), preenchidas
+// ate multiplo de SimdFloat::WIDTH. modelIndex = -1 marca as posicoes de preenchimento.
+struct BezierBatch {
+    std::vector<float> control[12];           // p0x p0y p0z p1x ... p3z
+    std::vector<float> invDuration;
+    std::vector<float> timeOffset;            // PHASE de cada objeto
+    std::vector<float> loop;                  // 1 = repete, 0 = para no fim
+    std::vector<float> spinRate;              // Graus/s da rotacao automatica em Y
+    std::vector<float> wobblePhase;           // Fase da oscilacao em X
+    std::vector<int> modelIndex;
+};
+
+struct OrbitBatch {
+    std::vector<float> center[3];
+    std::vector<float> radius;
+    std::vector<float> angularSpeed;          // Radianos/s
+    std::vector<float> timeOffset;
+    std::vector<float> axisU[3], axisV[3];    // Base do plano da orbita
+    std::vector<float> spinRate;
+    std::vector<float> wobblePhase;
+    std::vector<int> modelIndex;
+};
+
+struct AnimationBatches {
+    BezierBatch bezier;
+    OrbitBatch orbit;
+    // Estados do passo fixo dos lotes (atual e anterior, trocados a cada passo); a
+    // interpolacao do render le daqui e escreve nos modelos
+    AnimationStream bezierCurrent, bezierPrevious;
+    AnimationStream orbitCurrent, orbitPrevious;
+    std::vector<int> tracks;                  // Pistas: avaliadas uma a uma (busca na tabela de arco)
+    std::vector<int> keyframed;               // Trilhas de keyframes (cursor por objeto)
+    size_t sourceCount = 0;                   // Tamanho de objectAnimations quando foi montado
+    bool valid = false;
+} animationBatches;
+
+// Sistema de jobs: pool fixo de workers, cada thread com sua fila (deque). A dona
+// empilha e desempilha no fim; threads sem trabalho roubam do inicio das filas das outras.
+// Contadores atomicos marcam dependencias: quem espera um contador executa jobs enquanto
+// ele nao zera (o thread principal tambem trabalha). Sem workers tudo roda no principal.
+struct Job {
+    std::function<void()> task;
+    std::atomic<int>* counter;                // Decrementado quando o job termina
+};
+
+struct WorkerQueue {
+    std::mutex mutex;                         // Curto: so protege push/pop/steal
+    std::deque<Job> jobs;
 };
 
+struct JobSystem {
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;  // [0] = thread principal
+    std::atomic<bool> running{false};
+    std::atomic<int> queuedJobs{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+} jobSystem;
+
+thread_local int jobThreadIndex = 0;
+
+inline void jobSubmit(std::function<void()> task, std::atomic<int>& counter) {
+    if (jobSystem.queues.empty()) {
+        jobSystem.queues.emplace_back(new WorkerQueue());
+    }
+    counter.fetch_add(1, std::memory_order_relaxed);
+    WorkerQueue& queue = *jobSystem.queues[jobThreadIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(Job{ std::move(task), &counter });
+    }
+    jobSystem.queuedJobs.fetch_add(1, std::memory_order_release);
+}
+
+// Executa um job da propria fila ou roubado de outra; false se nao havia nenhum
+inline bool jobRunOne() {
+    size_t queueCount = jobSystem.queues.size();
+    Job job;
+    bool found = false;
+    for (size_t offset = 0; offset < queueCount && !found; offset++) {
+        WorkerQueue& queue = *jobSystem.queues[(jobThreadIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) continue;
+        if (offset == 0) {
+            job = std::move(queue.jobs.back());   // Propria fila: LIFO (dados ainda no cache)
+            queue.jobs.pop_back();
+        } else {
+            job = std::move(queue.jobs.front());  // Roubo: FIFO (pedacos maiores e mais antigos)
+            queue.jobs.pop_front();
+        }
+        found = true;
+    }
+    if (!found) {
+        return false;
+    }
+    jobSystem.queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    job.task();
+    job.counter->fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+inline void jobWait(std::atomic<int>& counter) {
+    while (counter.load(std::memory_order_acquire) > 0) {
+        if (!jobRunOne()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline void jobSystemStop() {
+    if (!jobSystem.running.exchange(false)) {
+        return;
+    }
+    jobSystem.wake.notify_all();
+    for (std::thread& worker : jobSystem.workers) {
+        worker.join();
+    }
+    jobSystem.workers.clear();
+}
+
+// Inicia workerCount threads alem da principal (0 = tudo no thread principal)
+inline void jobSystemStart(int workerCount) {
+    jobSystemStop();
+    jobSystem.queues.clear();
+    for (int i = 0; i <= workerCount; i++) {
+        jobSystem.queues.emplace_back(new WorkerQueue());
+    }
+    jobSystem.running = true;
+    for (int i = 1; i <= workerCount; i++) {
+        jobSystem.workers.emplace_back([i]() {
+            jobThreadIndex = i;
+            while (jobSystem.running.load(std::memory_order_acquire)) {
+                if (!jobRunOne()) {
+                    std::unique_lock<std::mutex> lock(jobSystem.sleepMutex);
+                    jobSystem.wake.wait_for(lock, std::chrono::milliseconds(1), []() {
+                        return jobSystem.queuedJobs.load(std::memory_order_acquire) > 0 || !jobSystem.running;
+                    });
+                }
+            }
+        });
+    }
+    static bool registered = false;
+    if (!registered) {
+        registered = true;
+        std::atexit(jobSystemStop);
+    }
+}
+
+// Divide [0, count) em pedacos de grain elementos, um job por pedaco, e espera todos
+template <typename Body>
+void parallelFor(size_t count, size_t grain, const Body& body) {
+    if (count <= grain || jobSystem.workers.empty()) {
+        body((size_t)0, count);
+        return;
+    }
+    std::atomic<int> counter{0};
+    for (size_t begin = 0; begin < count; begin += grain) {
+        size_t end = std::min(begin + grain, count);
+        jobSubmit([&body, begin, end]() { body(begin, end); }, counter);
+    }
+    jobSystem.wake.notify_all();
+    jobWait(counter);
+}
+
+// Pistas ja carregadas e pre-processadas, por caminho do arquivo: objetos que seguem a
+// mesma pista compartilham a mesma instancia (tabela de arco calculada uma vez)
+std::map<std::string, std::shared_ptr<const BezierTrack>> trackCache;
+
+// Trilhas de keyframes ja carregadas e comprimidas, por caminho do arquivo
+std::map<std::string, std::shared_ptr<const KeyframeTrack>> keyframeCache;
+
+// mtime de cada arquivo lido por loadTrack/loadKeyframeTrack: a recarga da configuracao
+// tira dos caches os que mudaram (evictChangedAnimationFiles)
+std::map<std::string, time_t> animationFileTimes;
+
+// Protege os caches: loadSceneConfig tambem roda na thread do hot reload. So cobre
+// busca e insercao; a leitura e o pre-processamento dos arquivos ficam fora do lock.
+std::mutex animationCacheMutex;
+
 // Variaveis globais para gerenciamento de modelos
 std::vector<Model> models;
 std::vector<ObjectAnimation> objectAnimations; // Animacões correspondentes aos modelos
@@ -144,34 +761,114 @@ bool cameraControlMode = false;
 bool animationEnabled = false;
 float animationTime = 0.0f;
 
+// Simulacao em passo fixo: as animacoes avancam sempre em passos de 1/hz segundos,
+// independente da taxa de renderizacao. O render interpola entre os dois ultimos estados.
+struct TransformSnapshot {
+    glm::vec3 position;
+    glm::vec3 rotation;
+    glm::vec3 scale;
+};
+
+struct FixedStepSimulation {
+    float hz = 60.0f;
+    float accumulator = 0.0f;
+    int maxStepsPerFrame = 8;                 // Limita a recuperacao apos travamentos longos
+    float alpha = 0.0f;                       // Fracao entre o estado anterior e o atual
+    std::vector<TransformSnapshot> previous;  // Um por modelo
+    std::vector<TransformSnapshot> current;
+    bool primed = false;                      // Falso ate capturar o primeiro estado
+} simulation;
+
 enum Mode { TRANSLATE, ROTATE, SCALE };
 Mode currentMode = ROTATE;
 
-// Função para criar VAO de uma parte de modelo (definida antes para ser usada)
-GLuint createModelPartVAO(const ModelPart& part) {
-    // Cria buffer com dados da parte do modelo
-    std::vector<GLfloat> vBuffer;
-    
-    for (size_t i = 0; i < part.vertices.size(); i++) {
-        // Posicao
-        vBuffer.push_back(part.vertices[i].x);
-        vBuffer.push_back(part.vertices[i].y);
-        vBuffer.push_back(part.vertices[i].z);
-        
-        // Cor baseada no material
-        vBuffer.push_back(part.material.kd.r);
-        vBuffer.push_back(part.material.kd.g);
-        vBuffer.push_back(part.material.kd.b);
-        
-        // Normal
-        vBuffer.push_back(part.normals[i].x);
-        vBuffer.push_back(part.normals[i].y);
-        vBuffer.push_back(part.normals[i].z);
-        
-        // UV
-        vBuffer.push_back(part.uvs[i].x);
-        vBuffer.push_back(part.uvs[i].y);
-    }
+// Estado das teclas: o callback so registra pressionada/solta e o movimento continuo
+// e aplicado uma vez por frame em processInput com o deltaTime real.
+struct InputState {
+    bool keys[GLFW_KEY_LAST + 1] = {};
+} input;
+
+// Velocidades das transformacoes do objeto selecionado (por segundo). Equivalem ao passo
+// antigo por evento (0.1 unidade / 5 graus) assumindo ~60 eventos por segundo.
+const float OBJECT_MOVE_SPEED = 6.0f;
+const float OBJECT_SCALE_SPEED = 6.0f;
+const float OBJECT_ROTATE_SPEED = 300.0f;
+
+// Registro central de estatisticas de renderizacao: o caminho de desenho incrementa os
+// contadores do frame e os recursos somam/subtraem a memoria residente ao serem criados.
+// Lido pelo HUD e pela exportacao CSV por frame.
+const int HUD_HISTORY = 120;
+struct RenderStats {
+    // Contadores do frame atual (zerados no inicio de cada frame)
+    unsigned drawCalls = 0;
+    unsigned triangles = 0;
+    unsigned textureBinds = 0;
+    unsigned uniformUpdates = 0;
+    unsigned culledParts = 0;
+    // Memoria residente estimada
+    size_t textureBytes = 0;
+    size_t bufferBytes = 0;
+    // Historico de tempos de frame para o grafico
+    float frameHistoryMs[HUD_HISTORY] = {};
+    int historyIndex = 0;
+    float lastFrameMs = 0.0f;
+} renderStats;
+
+// Carga de assets fora do thread principal (hot reload): com assetStaging definido na
+// thread, os loaders fazem so a parte de CPU (MTL, OBJ, decodificacao das imagens) e
+// deixam anotado o que falta; o thread principal cria texturas e VAOs depois.
+struct StagedTexture {
+    std::string material;                     // Partes com este material recebem a textura
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = nullptr;          // stbi_load; liberado depois do upload
+};
+
+struct AssetStaging {
+    std::vector<StagedTexture> textures;
+};
+
+thread_local AssetStaging* assetStaging = nullptr;
+
+// Residencia das malhas na CPU depois do upload (--residency)
+enum MeshResidency {
+    RESIDENCY_GPU_ONLY,       // Solta posicoes, normais e UVs (padrao)
+    RESIDENCY_CPU_GPU,        // Mantem tudo (picking, fisica, extracao da pista no hot reload)
+    RESIDENCY_COMPACT         // Mantem so as posicoes, sem folga de capacidade
+};
+MeshResidency meshResidency = RESIDENCY_GPU_ONLY;
+
+// Relatorio de memoria da carga inicial, por asset
+struct LoadMemoryEntry {
+    size_t objects = 0;
+    size_t vertices = 0;
+    size_t cpuLoaded = 0;                     // Malhas na CPU logo depois do upload
+    size_t gpuBytes = 0;                      // Buffers de vertices e texturas
+    size_t peakKb = 0;                        // Alta do RSS durante a leitura do primeiro objeto
+    double loadMs = 0.0;                      // Tempo somado de loadSceneObject
+    std::set<GLuint> textures;                // Texturas ja contadas em gpuBytes
+};
+
+struct LoadMemory {
+    std::map<std::string, LoadMemoryEntry> assets;
+    size_t rssStartKb = 0;                    // RSS antes de carregar a cena
+    bool peakTracked = false;                 // /proc/self/clear_refs disponivel
+} loadMemory;
+
+// Cria o VAO de posicao, cor, normal e UV intercalados (11 floats por vertice). Os vertices
+// sao escritos direto no buffer mapeado, sem uma copia intermediaria do tamanho da malha;
+// se o driver nao mapear, vao em blocos pequenos por glBufferSubData.
+static GLuint createInterleavedVAO(const glm::vec3* positions, const glm::vec3* normals, const glm::vec2* uvs,
+                                   size_t count, const glm::vec3& color) {
+    const size_t FLOATS_PER_VERTEX = 11;
+    const size_t CHUNK_VERTICES = 4096;
+    auto fill = [&](GLfloat* out, size_t first, size_t n) {
+        for (size_t i = first; i < first + n; i++) {
+            *out++ = positions[i].x; *out++ = positions[i].y; *out++ = positions[i].z;
+            *out++ = color.r;        *out++ = color.g;        *out++ = color.b;
+            *out++ = normals[i].x;   *out++ = normals[i].y;   *out++ = normals[i].z;
+            *out++ = uvs[i].x;       *out++ = uvs[i].y;
+        }
+    };
 
     GLuint VAO, VBO;
     glGenVertexArrays(1, &VAO);
@@ -179,7 +876,28 @@ GLuint createModelPartVAO(const ModelPart& part) {
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
+    GLsizeiptr bytes = (GLsizeiptr)(count * FLOATS_PER_VERTEX * sizeof(GLfloat));
+    glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STATIC_DRAW);
+    renderStats.bufferBytes += bytes;
+
+    bool written = false;
+    if (bytes > 0) {
+        GLfloat* mapped = (GLfloat*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
+                                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped != NULL) {
+            fill(mapped, 0, count);
+            written = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+        }
+    }
+    if (!written) {
+        std::vector<GLfloat> chunk(std::min(count, CHUNK_VERTICES) * FLOATS_PER_VERTEX);
+        for (size_t first = 0; first < count; first += CHUNK_VERTICES) {
+            size_t n = std::min(CHUNK_VERTICES, count - first);
+            fill(chunk.data(), first, n);
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(first * FLOATS_PER_VERTEX * sizeof(GLfloat)),
+                            (GLsizeiptr)(n * FLOATS_PER_VERTEX * sizeof(GLfloat)), chunk.data());
+        }
+    }
 
     // Configurar atributos
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(0));
@@ -195,24 +913,264 @@ GLuint createModelPartVAO(const ModelPart& part) {
     return VAO;
 }
 
-// Loader OBJ que suporta multiplos materiais
-bool loadOBJWithMaterials(const char * path, Model& model, const std::vector<Material>& materials) {
+// Função para criar VAO de uma parte de modelo (definida antes para ser usada)
+GLuint createModelPartVAO(const ModelPart& part, const Material& material) {
+    // Cor baseada no material
+    return createInterleavedVAO(part.vertices.data(), part.normals.data(), part.uvs.data(),
+                                part.vertices.size(), material.kd);
+}
+
+// Cria um VAO apenas com posicoes para o pre-pass de profundidade (12 bytes por vertice)
+GLuint createModelPartDepthVAO(const ModelPart& part) {
+    GLuint VAO, VBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, part.vertices.size() * sizeof(glm::vec3), part.vertices.data(), GL_STATIC_DRAW);
+    renderStats.bufferBytes += part.vertices.size() * sizeof(glm::vec3);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)(0));
+    glEnableVertexAttribArray(0);
+
+    glBindVertexArray(0);
+    return VAO;
+}
+
+// Id do material na lista (ModelPart::materialId), ou -1 se nao existir
+int findMaterialByName(const std::vector<Material>& materials, const std::string& name) {
+    for (size_t i = 0; i < materials.size(); i++) {
+        if (materials[i].name == name) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Contagem de alocacoes por thread para o microbenchmark objload (GrauB2Bench). O operator
+// new contador fica em GrauB2Allocations.cpp, so no executavel de benchmark.
+#ifdef GRAUB2_COUNT_ALLOCATIONS
+size_t allocationCounter();
+#elif defined(GRAUB2_BENCH)
+static size_t allocationCounter() { return 0; }
+#endif
+
+// Arena linear para os dados temporarios da carga de OBJ (v/vt/vn e indices por material):
+// blocos grandes que ficam com a thread e sao reaproveitados de uma carga para a seguinte.
+// Nao ha free por objeto; um ScratchScope devolve tudo o que foi alocado no seu escopo.
+struct ScratchArena {
+    static constexpr size_t BLOCK_SIZE = 4u << 20;
+    struct Block {
+        char* data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t current = 0;                       // Bloco em uso
+    size_t offset = 0;                        // Proximo byte livre no bloco em uso
+
+    void* allocate(size_t bytes, size_t alignment) {
+        for (; current < blocks.size(); current++, offset = 0) {
+            size_t start = (offset + alignment - 1) & ~(alignment - 1);
+            if (start + bytes <= blocks[current].size) {
+                offset = start + bytes;
+                return blocks[current].data + start;
+            }
+        }
+        // malloc ja devolve memoria alinhada para qualquer tipo basico
+        Block block = { (char*)malloc(std::max(BLOCK_SIZE, bytes)), std::max(BLOCK_SIZE, bytes) };
+        if (block.data == NULL) {
+            return nullptr;
+        }
+        blocks.push_back(block);
+        current = blocks.size() - 1;
+        offset = bytes;
+        return block.data;
+    }
+
+    // Devolve os blocos ao sistema (fim da carga da cena)
+    void release() {
+        for (Block& block : blocks) {
+            free(block.data);
+        }
+        blocks.clear();
+        current = offset = 0;
+    }
+
+    ~ScratchArena() { release(); }
+};
+
+thread_local ScratchArena loadScratch;
+
+struct ScratchScope {
+    ScratchArena& arena;
+    size_t current, offset;
+    explicit ScratchScope(ScratchArena& a) : arena(a), current(a.current), offset(a.offset) {}
+    ~ScratchScope() {
+        arena.current = current;
+        arena.offset = offset;
+    }
+};
+
+// Alocador de contêiner sobre a arena: deallocate nao faz nada (o ScratchScope libera)
+template <typename T>
+struct ScratchAllocator {
+    typedef T value_type;
+    ScratchArena* arena;
+    explicit ScratchAllocator(ScratchArena& a) : arena(&a) {}
+    template <typename U>
+    ScratchAllocator(const ScratchAllocator<U>& other) : arena(other.arena) {}
+    T* allocate(size_t count) {
+        void* memory = arena->allocate(count * sizeof(T), alignof(T));
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        return (T*)memory;
+    }
+    void deallocate(T*, size_t) {}
+    template <typename U>
+    bool operator==(const ScratchAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ScratchAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+// Material da parte (do MTL ou padrao), ajustes por nome e VAO; comum aos loaders de OBJ
+static void finishObjPart(Model& model, ModelPart& part) {
+	const std::string& matName = part.materialName;
+	part.nVertices = part.vertices.size();
 	
-	std::vector<glm::vec3> temp_vertices;
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
+	// Encontrar material correspondente
+	int materialId = findMaterialByName(model.materials, matName);
+	if (materialId < 0) {
+		// Criar material padrao
+		materialId = (int)model.materials.size();
+		model.materials.emplace_back();
+		model.materials.back().name = matName;
+		model.materials.back().kd = glm::vec3(0.7f, 0.7f, 0.7f);
+	}
+	part.materialId = (uint32_t)materialId;
+	Material& material = model.materials[materialId];
 	
-	// Map para agrupar faces por material
-	std::map<std::string, std::vector<unsigned int>> materialVertexIndices;
-	std::map<std::string, std::vector<unsigned int>> materialUvIndices;
-	std::map<std::string, std::vector<unsigned int>> materialNormalIndices;
+	// Ajustar propriedades para materiais especificos
+	if (matName == "Decals") {
+		material.ka = glm::vec3(0.8f, 0.8f, 0.8f);
+		material.kd = glm::vec3(1.0f, 1.0f, 1.0f);
+		material.ks = glm::vec3(0.1f, 0.1f, 0.1f);
+		material.shininess = 1.0f;
+	} else if (matName == "Asphalt") {
+		material.ka = glm::vec3(0.1f, 0.1f, 0.1f);
+		material.ks = glm::vec3(0.2f, 0.2f, 0.2f);
+		material.shininess = 4.0f;
+	}
 	
-	std::string currentMaterial = "default";
+	// Criar VAO para esta parte (carga em fundo: fica para uploadStagedModel)
+	if (assetStaging == nullptr) {
+		part.VAO = createModelPartVAO(part, material);
+		part.depthVAO = createModelPartDepthVAO(part);
+	}
+}
+
+// Quantidades de um OBJ, contadas antes do parse para reservar a arena de uma vez (vetores
+// crescendo na arena deixariam para tras os buffers antigos)
+struct ObjCounts {
+    size_t vertices = 0, uvs = 0, normals = 0;
+    size_t corners = 0;                       // Vertices de face ja triangulados (quad = 6)
+};
+
+static ObjCounts countObjElements(FILE* file) {
+    ObjCounts counts;
+    char buffer[65536];
+    char keyword[3];
+    int keywordLength = 0;
+    bool keywordDone = false, inFace = false, inToken = false;
+    int tokens = 0;
+    auto endLine = [&]() {
+        if (inFace) counts.corners += tokens >= 4 ? 6 : (tokens == 3 ? 3 : 0);
+        keywordLength = 0;
+        keywordDone = inFace = inToken = false;
+        tokens = 0;
+    };
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for (size_t i = 0; i < read; i++) {
+            char c = buffer[i];
+            bool blank = c == ' ' || c == '\t' || c == '\r';
+            if (c == '\n') {
+                endLine();
+            } else if (!keywordDone) {
+                if (blank && keywordLength > 0) {
+                    keywordDone = true;
+                    std::string_view word(keyword, keywordLength);
+                    if (word == "v") counts.vertices++;
+                    else if (word == "vt") counts.uvs++;
+                    else if (word == "vn") counts.normals++;
+                    else if (word == "f") inFace = true;
+                } else if (!blank) {
+                    if (keywordLength < 3) keyword[keywordLength++] = c;
+                    if (keywordLength == 3) keywordDone = true;  // Palavra longa (usemtl, mtllib...)
+                }
+            } else if (inFace) {
+                if (blank) {
+                    inToken = false;
+                } else if (!inToken) {
+                    inToken = true;
+                    tokens++;
+                }
+            }
+        }
+    }
+    endLine();
+    rewind(file);
+    return counts;
+}
+
+// Loader OBJ que suporta multiplos materiais
+bool loadOBJWithMaterials(const char * path, Model& model, std::vector<Material> materials) {
+	PROFILE_SCOPE("loadOBJWithMaterials");
 	
 	FILE * file = fopen(path, "r");
 	if (file == NULL) {
 		return false;
 	}
+	ObjCounts counts = countObjElements(file);
+	
+	// Dados temporarios na arena da thread, devolvidos ao sair da funcao
+	ScratchScope scratch(loadScratch);
+	ScratchAllocator<char> allocator(loadScratch);
+	ScratchVector<glm::vec3> temp_vertices(allocator);
+	ScratchVector<glm::vec2> temp_uvs(allocator);
+	ScratchVector<glm::vec3> temp_normals(allocator);
+	temp_vertices.reserve(counts.vertices);
+	temp_uvs.reserve(counts.uvs);
+	temp_normals.reserve(counts.normals);
+	
+	// Vertices de face na ordem do arquivo, com o grupo de material de cada um. Um grupo por
+	// usemtl distinto, com o nome internado na arena; o grupo atual fica em cache.
+	struct ObjCorner {
+		unsigned int v, vt, vn;
+		uint32_t group;
+	};
+	ScratchVector<ObjCorner> corners(allocator);
+	corners.reserve(counts.corners);
+	ScratchVector<std::string_view> groups(allocator);
+	groups.reserve(16);
+	auto useMaterial = [&](const char* name) {
+		std::string_view key(name);
+		for (size_t i = 0; i < groups.size(); i++) {
+			if (groups[i] == key) return (uint32_t)i;
+		}
+		char* interned = (char*)loadScratch.allocate(key.size(), 1);
+		if (interned == nullptr) {
+			throw std::bad_alloc();
+		}
+		memcpy(interned, key.data(), key.size());
+		groups.push_back(std::string_view(interned, key.size()));
+		return (uint32_t)(groups.size() - 1);
+	};
+	uint32_t currentMaterial = useMaterial("default");
 	
 	while (true) {
 		char lineHeader[128];
@@ -237,7 +1195,7 @@ bool loadOBJWithMaterials(const char * path, Model& model, const std::vector<Mat
 		}
 		else if (strcmp(lineHeader, "usemtl") == 0) {
 			fscanf(file, "%s", lineHeader);
-			currentMaterial = std::string(lineHeader);
+			currentMaterial = useMaterial(lineHeader);
 		}
 		else if (strcmp(lineHeader, "f") == 0) {
 			// Tentar ler como triângulo primeiro
@@ -248,34 +1206,16 @@ bool loadOBJWithMaterials(const char * path, Model& model, const std::vector<Mat
 			// Ler a linha restante
 			char faceLine[1000];
 			fgets(faceLine, 1000, file);
+			uint32_t g = currentMaterial;
 			
 			// Tentar parse como quad primeiro
 			int matches = sscanf(faceLine, "%u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u", 
 				&v1, &vt1, &vn1, &v2, &vt2, &vn2, &v3, &vt3, &vn3, &v4, &vt4, &vn4);
 			
 			if (matches == 12) {
-				// É um quad - converter para 2 triângulos
-				// Primeiro triângulo: v1, v2, v3
-				materialVertexIndices[currentMaterial].push_back(v1);
-				materialVertexIndices[currentMaterial].push_back(v2);
-				materialVertexIndices[currentMaterial].push_back(v3);
-				materialUvIndices[currentMaterial].push_back(vt1);
-				materialUvIndices[currentMaterial].push_back(vt2);
-				materialUvIndices[currentMaterial].push_back(vt3);
-				materialNormalIndices[currentMaterial].push_back(vn1);
-				materialNormalIndices[currentMaterial].push_back(vn2);
-				materialNormalIndices[currentMaterial].push_back(vn3);
-				
-				// Segundo triângulo: v1, v3, v4
-				materialVertexIndices[currentMaterial].push_back(v1);
-				materialVertexIndices[currentMaterial].push_back(v3);
-				materialVertexIndices[currentMaterial].push_back(v4);
-				materialUvIndices[currentMaterial].push_back(vt1);
-				materialUvIndices[currentMaterial].push_back(vt3);
-				materialUvIndices[currentMaterial].push_back(vt4);
-				materialNormalIndices[currentMaterial].push_back(vn1);
-				materialNormalIndices[currentMaterial].push_back(vn3);
-				materialNormalIndices[currentMaterial].push_back(vn4);
+				// É um quad - converter para 2 triângulos: v1, v2, v3 e v1, v3, v4
+				corners.insert(corners.end(), { { v1, vt1, vn1, g }, { v2, vt2, vn2, g }, { v3, vt3, vn3, g },
+				                                { v1, vt1, vn1, g }, { v3, vt3, vn3, g }, { v4, vt4, vn4, g } });
 			} else {
 				// Tentar como triângulo
 				matches = sscanf(faceLine, "%u/%u/%u %u/%u/%u %u/%u/%u", 
@@ -283,15 +1223,7 @@ bool loadOBJWithMaterials(const char * path, Model& model, const std::vector<Mat
 				
 				if (matches == 9) {
 					// É um triângulo
-					materialVertexIndices[currentMaterial].push_back(v1);
-					materialVertexIndices[currentMaterial].push_back(v2);
-					materialVertexIndices[currentMaterial].push_back(v3);
-					materialUvIndices[currentMaterial].push_back(vt1);
-					materialUvIndices[currentMaterial].push_back(vt2);
-					materialUvIndices[currentMaterial].push_back(vt3);
-					materialNormalIndices[currentMaterial].push_back(vn1);
-					materialNormalIndices[currentMaterial].push_back(vn2);
-					materialNormalIndices[currentMaterial].push_back(vn3);
+					corners.insert(corners.end(), { { v1, vt1, vn1, g }, { v2, vt2, vn2, g }, { v3, vt3, vn3, g } });
 				}
 			}
 		}
@@ -304,34 +1236,62 @@ bool loadOBJWithMaterials(const char * path, Model& model, const std::vector<Mat
 	
 	fclose(file);
 	
-	// Criar uma parte do modelo para cada material
-	for (auto& pair : materialVertexIndices) {
-		std::string matName = pair.first;
-		std::vector<unsigned int>& vertexIndices = pair.second;
-		std::vector<unsigned int>& uvIndices = materialUvIndices[matName];
-		std::vector<unsigned int>& normalIndices = materialNormalIndices[matName];
-		
-		ModelPart part;
-		part.materialName = matName;
+	// Vertices agrupados por material (counting sort estavel: a ordem do arquivo se mantem)
+	ScratchVector<size_t> groupStart(groups.size() + 1, 0, allocator);
+	for (const ObjCorner& corner : corners) {
+		groupStart[corner.group + 1]++;
+	}
+	for (size_t i = 0; i < groups.size(); i++) {
+		groupStart[i + 1] += groupStart[i];
+	}
+	ScratchVector<uint32_t> sorted(corners.size(), 0, allocator);
+	{
+		ScratchVector<size_t> next(groupStart.begin(), groupStart.end() - 1, allocator);
+		for (size_t i = 0; i < corners.size(); i++) {
+			sorted[next[corners[i].group]++] = (uint32_t)i;
+		}
+	}
+	
+	// Partes em ordem alfabetica de material, como no loader anterior (std::map)
+	ScratchVector<uint32_t> order(allocator);
+	for (uint32_t i = 0; i < groups.size(); i++) {
+		if (groupStart[i + 1] > groupStart[i]) order.push_back(i);
+	}
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return groups[a] < groups[b]; });
+	
+	// Criar uma parte do modelo para cada material; as partes guardam o indice do material
+	model.materials = std::move(materials);
+	model.parts.reserve(model.parts.size() + order.size());
+	for (uint32_t group : order) {
+		size_t first = groupStart[group], count = groupStart[group + 1] - first;
 		
 		// Verificar se ha faces suficientes para este material
-		if (vertexIndices.size() % 3 != 0) {
+		if (count % 3 != 0) {
 			continue;
 		}
 		
+		model.parts.emplace_back();
+		ModelPart& part = model.parts.back();
+		part.materialName = std::string(groups[group]);
+		part.vertices.reserve(count);
+		part.uvs.reserve(count);
+		part.normals.reserve(count);
+		
 		// Converter indices para vertices
-		for (size_t i = 0; i < vertexIndices.size(); i++) {
-			if (vertexIndices[i] > temp_vertices.size() || 
-			    uvIndices[i] > temp_uvs.size() || 
-			    normalIndices[i] > temp_normals.size()) {
+		for (size_t i = first; i < first + count; i++) {
+			const ObjCorner& corner = corners[sorted[i]];
+			if (corner.v == 0 || corner.vt == 0 || corner.vn == 0 ||
+			    corner.v > temp_vertices.size() || 
+			    corner.vt > temp_uvs.size() || 
+			    corner.vn > temp_normals.size()) {
 				continue;
 			}
 			
-			part.vertices.push_back(temp_vertices[vertexIndices[i] - 1]);
-			part.uvs.push_back(temp_uvs[uvIndices[i] - 1]);
+			part.vertices.push_back(temp_vertices[corner.v - 1]);
+			part.uvs.push_back(temp_uvs[corner.vt - 1]);
 			
 			// Garantir que todas as normais estao normalizadas
-			glm::vec3 normal = temp_normals[normalIndices[i] - 1];
+			glm::vec3 normal = temp_normals[corner.vn - 1];
 			if (length(normal) > 0.0001f) {
 				normal = normalize(normal);
 			} else {
@@ -340,40 +1300,7 @@ bool loadOBJWithMaterials(const char * path, Model& model, const std::vector<Mat
 			part.normals.push_back(normal);
 		}
 		
-		part.nVertices = part.vertices.size();
-		
-		// Encontrar material correspondente
-		bool found = false;
-		for (const auto& mat : materials) {
-			if (mat.name == matName) {
-				part.material = mat;
-				found = true;
-				break;
-			}
-		}
-		
-		if (!found) {
-			// Criar material padrao
-			part.material.name = matName;
-			part.material.kd = glm::vec3(0.7f, 0.7f, 0.7f);
-		}
-		
-		// Ajustar propriedades para materiais especificos
-		if (matName == "Decals") {
-			part.material.ka = glm::vec3(0.8f, 0.8f, 0.8f);
-			part.material.kd = glm::vec3(1.0f, 1.0f, 1.0f);
-			part.material.ks = glm::vec3(0.1f, 0.1f, 0.1f);
-			part.material.shininess = 1.0f;
-		} else if (matName == "Asphalt") {
-			part.material.ka = glm::vec3(0.1f, 0.1f, 0.1f);
-			part.material.ks = glm::vec3(0.2f, 0.2f, 0.2f);
-			part.material.shininess = 4.0f;
-		}
-		
-		// Criar VAO para esta parte
-		part.VAO = createModelPartVAO(part);
-		
-		model.parts.push_back(part);
+		finishObjPart(model, part);
 	}
 	
 	return model.parts.size() > 0;
@@ -386,16 +1313,28 @@ bool loadOBJ(
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals
 ){
-
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices; 
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
+	PROFILE_SCOPE("loadOBJ");
 
 	FILE * file = fopen(path, "r");
 	if( file == NULL ){
 		return false;
 	}
+	ObjCounts counts = countObjElements(file);
+
+	// Dados temporarios na arena da thread, devolvidos ao sair da funcao. Tudo reservado
+	// antes do parse: um vetor crescendo na arena deixaria para tras os buffers antigos.
+	ScratchScope scratch(loadScratch);
+	ScratchAllocator<char> allocator(loadScratch);
+	ScratchVector<unsigned int> vertexIndices(allocator), uvIndices(allocator), normalIndices(allocator);
+	ScratchVector<glm::vec3> temp_vertices(allocator);
+	ScratchVector<glm::vec2> temp_uvs(allocator);
+	ScratchVector<glm::vec3> temp_normals(allocator);
+	temp_vertices.reserve(counts.vertices);
+	temp_uvs.reserve(counts.uvs);
+	temp_normals.reserve(counts.normals);
+	vertexIndices.reserve(counts.corners);
+	uvIndices.reserve(counts.corners);
+	normalIndices.reserve(counts.corners);
 
 	while( 1 ){
 		char lineHeader[128];
@@ -424,7 +1363,7 @@ bool loadOBJ(
 			unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
 			int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2] );
 			if (matches != 9){
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
+				LOG_ERROR("File can't be read by our simple parser :-( Try exporting with other options");
 				fclose(file);
 				return false;
 			}
@@ -444,6 +1383,10 @@ bool loadOBJ(
 		}
 	}
 
+	out_vertices.reserve(out_vertices.size() + vertexIndices.size());
+	out_uvs.reserve(out_uvs.size() + vertexIndices.size());
+	out_normals.reserve(out_normals.size() + vertexIndices.size());
+
 	// For each vertex of each triangle
 	for( unsigned int i=0; i<vertexIndices.size(); i++ ){
 		// Get the indices of its attributes
@@ -480,6 +1423,9 @@ struct SceneConfig {
         glm::vec3 position;
         float intensity;
         bool enabled = true;
+        float radius = 0.0f;                  // Alcance da luz (0 = sem atenuacao, afeta todos os clusters)
+        glm::vec3 color = glm::vec3(1.0f);    // Cor da luz
+        float weight = 1.0f;                  // Peso aplicado na iluminacao (LIGHT1..3 usam pesos fixos)
     };
     std::vector<LightConfig> lights;
     
@@ -490,35 +1436,133 @@ struct SceneConfig {
         glm::vec3 scale;
         std::string materialType;
         ObjectAnimation animation; // Animacao específica do objeto
+        int parent = -1;           // PARENT: indice (ordem no arquivo) do objeto pai
+        std::vector<PartNodeConfig> partNodes; // PART: partes com transformacao propria
     };
     std::vector<ObjectConfig> objects;
+
+    BezierTrack cameraPath;    // Caminho roteirizado da câmera (CAMERA_PATH), usado no benchmark
 };
 
 // Protótipos das funcões
 int setupShader();
+int setupDepthShader();
+GLuint compileShaderProgram(const GLchar* vertexSource, const GLchar* fragmentSource);
 GLuint loadTexture(string filePath, int &width, int &height);
+GLuint createTexture(const unsigned char* data, int width, int height, int nrChannels);
 GLuint createSimpleVAO(const std::vector<vec3>& vertices, const std::vector<vec2>& uvs, const std::vector<vec3>& normals);
 GLuint createModelVAO(const Model& model);
-GLuint createModelPartVAO(const ModelPart& part);
-bool loadOBJWithMaterials(const char * path, Model& model, const std::vector<Material>& materials);
+GLuint createModelPartVAO(const ModelPart& part, const Material& material);
+GLuint createModelPartDepthVAO(const ModelPart& part);
+bool loadOBJWithMaterials(const char * path, Model& model, std::vector<Material> materials);
 
 void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nVertices, vec3 color= vec3(1.0,0.0,0.0), vec3 axis = (vec3(0.0, 0.0, 1.0)));
-void drawModel(GLuint shaderID, const Model& model);
-void updateCameraMatrix(GLuint shaderID);
-void processCameraMovement(int key, float deltaTime);
+enum PartFilter { PARTS_ALL, PARTS_OPAQUE, PARTS_DECALS };
+void drawModel(GLuint shaderID, const Model& model, PartFilter filter = PARTS_ALL);
+void initGpuTimers();
+void initHud();
+void beginFrameStats();
+void endFrameStats(float frameMs, int frameIndex);
+void drawHud(int width, int height);
+void destroyHud();
+void gpuTimersBeginFrame();
+void printGpuPassTable();
+void destroyGpuTimers();
+void drawModelDepth(GLuint depthShaderID, const Model& model);
+mat4 computeModelMatrix(const Model& model);
+void readFragmentQuery();
+mat4 updateCameraMatrix(GLuint shaderID);
+void processInput(float deltaTime);
+void processCameraMovement(float deltaTime);
+std::string findSceneConfigPath(const std::string& filename);
 bool loadSceneConfig(const std::string& filename, SceneConfig& config);
+std::string sceneAssetKey(const SceneConfig::ObjectConfig& object);
+bool writeBinaryScene(const std::string& path, const SceneConfig& config);
+#ifdef GRAUB2_BENCH
+bool loadSceneConfigLegacy(const std::string& filename, SceneConfig& config);
+void runConfigMicrobenchmark();
+void runObjLoadMicrobenchmark();
+#endif
+bool generateScene(const std::string& path);
+void addDefaultLights(SceneConfig& config);
+bool loadSceneObject(const SceneConfig::ObjectConfig& objConfig, Model& model);
+void hotReloadStart(const std::string& path);
+bool hotReloadPoll();
+void hotReloadStop();
+void retainModelGpu(const Model& model);
+void releaseMeshCopies(Model& model);
+void trimHeap();
+void applyMeshResidency();
+size_t processMemoryKb(const char* field);
+bool resetPeakMemory();
+void recordModelLoad(const std::string& asset, const Model& model, size_t rssBeforeKb, bool peakTracked, double loadMs);
+void logLoadMemoryReport(size_t rssLoadedKb);
+void releaseModelGpu(Model& model);
 Material createMaterial(const std::string& materialType);
 bool loadMTL(const std::string& filename, std::vector<Material>& materials);
-Material findMaterialByName(const std::vector<Material>& materials, const std::string& name);
+int findMaterialByName(const std::vector<Material>& materials, const std::string& name);
 std::string getMTLFilename(const std::string& objFilename);
 void updateAnimations(float deltaTime);
+void updateSimulation(float frameDelta);
 void applyAnimationsToModels();
+void simulateAnimations();
+void writeBatchedTransforms(float alpha);
+void buildAnimationBatches(const std::vector<ObjectAnimation>& animations, size_t count, AnimationBatches& batches);
+void updateBezierBatch(const BezierBatch& batch, float time, AnimationStream& out, size_t begin = 0, size_t end = SIZE_MAX);
+void updateOrbitBatch(const OrbitBatch& batch, float time, AnimationStream& out, size_t begin = 0, size_t end = SIZE_MAX);
+void interpolateBatch(const std::vector<int>& modelIndex, const AnimationStream& previous, const AnimationStream& current,
+                      float alpha, Model* out, size_t begin = 0, size_t end = SIZE_MAX);
+void runAnimationMicrobenchmark();
+void computeSceneBounds();
+void computeModelBounds(Model& model);
+void buildSceneGraph();
+void buildSceneGraphNodes(std::vector<SceneGraphSource>& sources, SceneGraph& graph);
+void assignPartNodes(const SceneGraph& graph, std::vector<Model>& target);
+void updateSceneGraph();
+void updateSceneTransforms(const mat4& viewProjection);
+void runJobsMicrobenchmark();
 vec3 calculateLightIntensity(int lightIndex, float time);
 glm::vec3 calculateBezierPosition(const BezierCurve& curve, float t);
 glm::vec3 calculateBezierTrackPosition(const BezierTrack& track, float t, glm::vec3& direction);
+void buildArcLengthTable(BezierTrack& track, float tolerance = 1e-3f);
+std::shared_ptr<const BezierTrack> loadTrack(const std::string& path);
+std::shared_ptr<const BezierTrack> createTrack(const std::string& name, std::vector<glm::vec3> points,
+                                               bool loop, float duration, float speed);
+bool writeTrackFile(const std::string& path, const std::vector<glm::vec3>& points, bool loop, float speed,
+                    const std::string& cacheKey = "");
+std::shared_ptr<const BezierTrack> builtinDriftTrack();
+bool extractTrackCenterline(const Model& model, const mat4& modelMatrix, std::vector<glm::vec3>& centerline);
+void fitBezierPath(const std::vector<glm::vec3>& points, float maxError, std::vector<glm::vec3>& controlPoints);
+std::shared_ptr<const BezierTrack> fitRacingLine(const Model& model, const std::string& objPath, const mat4& modelMatrix);
+bool hasAsphaltPart(const Model& model);
+void keepTrackPositions(Model& model);
+std::shared_ptr<const BezierTrack> meshRacingLine(const Model& model, const std::string& objPath, const mat4& modelMatrix);
+void resolveMeshTracks();
+void runTrackMicrobenchmark();
+std::shared_ptr<const KeyframeTrack> loadKeyframeTrack(const std::string& path);
+void evictChangedAnimationFiles();
+std::shared_ptr<const KeyframeTrack> createKeyframeTrack(const std::string& name, const std::vector<float>& times,
+                                                         const std::vector<glm::vec3>& positions,
+                                                         const std::vector<glm::quat>& rotations,
+                                                         const std::vector<glm::vec3>& scales, bool loop,
+                                                         const glm::vec3& tolerance);
+void sampleKeyframeTrack(const KeyframeTrack& track, float time, KeyframeCursor& cursor, Model& out);
+void runKeyframeMicrobenchmark();
 glm::vec3 calculateOrbitPosition(const OrbitAnimation& orbit, float time);
 bool parseAnimationConfig(const std::string& line, ObjectAnimation& animation);
 void loadMaterialTextures(std::vector<Material>& materials, const std::string& baseDir);
+bool parseCommandLine(int argc, char** argv);
+bool profilerDumpChromeTrace(const std::string& path);
+void buildDefaultCameraPath(BezierTrack& path, const glm::vec3& eye, const glm::vec3& center);
+void recordBenchFrame(double frameStart, double cpuEnd, double frameEnd);
+void writeBenchResults(const char* renderer, const char* version, int width, int height);
+bool createHeadlessContext(int width, int height);
+void finishHeadlessFrame(int frameIndex);
+void destroyHeadlessContext();
+void initClusteredLighting(int screenWidth, int screenHeight, const mat4& projection);
+void setClusterProjection(const mat4& projection);
+void updateLightClusters(GLuint shaderID, const mat4& view);
+void destroyClusteredLighting();
 
 // Dimensões da janela (pode ser alterado em tempo de execucao)
 const GLuint WIDTH = 2880, HEIGHT = 1800;
@@ -526,9 +1570,228 @@ const GLuint WIDTH = 2880, HEIGHT = 1800;
 // Configuracao de cena carregada do arquivo
 SceneConfig sceneConfig;
 
-bool light1Enabled = true;
-bool light2Enabled = true;
-bool light3Enabled = true;
+// Modo headless: renderiza N frames em um FBO sem abrir janela e encerra
+struct HeadlessOptions {
+#if defined(GRAUB2_BENCH) && defined(GRAUB2_HAS_EGL)
+    bool enabled = true;                      // Benchmark roda sem janela quando ha EGL
+#else
+    bool enabled = false;
+#endif
+    int frames = 300;
+    int width = 1280;
+    int height = 720;
+    std::string dumpDir;                      // Se definido, salva cada frame como PNG
+    std::string configPath = "../src/GrauB2Config";
+    bool animate = false;                     // Liga as animacoes desde o primeiro frame
+    std::string tracePath;                    // Se definido, salva o trace de CPU ao sair
+} headlessOptions;
+
+// Benchmark deterministico: passo de tempo fixo, câmera em caminho Bézier roteirizado,
+// numero fixo de frames e estatisticas de tempo por frame exportadas em JSON.
+// O alvo GrauB2Bench compila este arquivo com GRAUB2_BENCH, que liga o modo por padrao.
+const int BENCH_GPU_QUERY_COUNT = 4;
+struct BenchOptions {
+#ifdef GRAUB2_BENCH
+    bool enabled = true;
+#else
+    bool enabled = false;
+#endif
+    int warmupFrames = 60;                    // Frames descartados antes de medir
+    float fixedDelta = 1.0f / 60.0f;          // Passo fixo da simulacao
+    std::string jsonPath = "bench_results.json";
+    std::string microbenchmark;               // --microbench NOME: roda so o microbenchmark e sai
+    std::string trackExportPath;              // --extract-track ARQUIVO: grava a pista da malha e sai
+    std::string sceneExportPath;              // --export-scene ARQUIVO: grava a cena em binario e sai
+    int workerCount = -1;                     // --workers N (-1 = nucleos - 1)
+} benchOptions;
+
+// Gerador de cenas sinteticas para testes de escala (--generate-scene): grava uma
+// configuracao no formato do GrauB2Config a partir destes parametros e da semente
+struct SceneGeneratorOptions {
+    size_t count = 1000;                      // --gen-count N
+    std::string assets = "suzanne:8,r1:1";    // --gen-assets nome:peso,... (preset ou caminho do OBJ)
+    std::string layout = "grid";              // --gen-layout grid|clustered|track
+    std::string animations = "none:6,orbit:2,bezier:1,track:1"; // --gen-anim tipo:peso,...
+    int lights = 16;                          // --gen-lights N (postes, alem da luz global)
+    uint32_t seed = 1;                        // --gen-seed N
+    std::string trackPath = "../assets/tracks/drift.track"; // --gen-track: pista do layout e da animacao track
+    std::string outputPath;                   // --generate-scene ARQUIVO: grava a cena e sai
+} sceneGenerator;
+
+// Hot reload da configuracao: inotify (Linux) ou mtime (demais sistemas) detecta a gravacao
+// e uma thread de fundo le o arquivo, compara com a cena atual e carrega so os assets novos.
+// O thread principal envia esses assets para a GPU em fatias de tempo por frame e troca a
+// cena inteira de uma vez, em um unico frame.
+const double HOT_RELOAD_SETTLE_SECONDS = 0.15;   // Espera o editor terminar de gravar
+const double HOT_RELOAD_POLL_SECONDS = 0.5;      // Intervalo da verificacao de mtime (sem inotify)
+const double HOT_RELOAD_UPLOAD_BUDGET_MS = 4.0;  // Upload para a GPU por frame
+
+struct SceneReload {
+    SceneConfig config;                       // Configuracao nova
+    std::vector<int> reuse;                   // Por objeto novo: objeto atual reaproveitado ou -1
+    std::vector<int> cloneModel;              // Asset ja na cena: copia as partes deste modelo
+    std::vector<int> cloneLoaded;             // Asset lido nesta recarga por outro objeto novo
+    std::vector<Model> loaded;                // Modelos novos (sem GL ate o upload)
+    std::vector<char> loadedOk;
+    std::vector<AssetStaging> staging;        // Texturas decodificadas de cada modelo lido
+    SceneGraph graph;                         // Hierarquia da cena nova, montada na thread de fundo
+    std::vector<int> parents;                 // Pai de cada modelo novo (ciclos ja cortados)
+    std::shared_ptr<const BezierTrack> racingLine;  // Para "ANIMATION track" novas (nullptr = nenhuma)
+    size_t readCount = 0;                     // Assets lidos do disco
+    size_t uploadObject = 0, uploadPart = 0;  // Progresso do upload entre frames
+    bool ok = false;
+    double startTime = 0.0;
+};
+
+// Recarga de OBJ/MTL/texturas alterados: cada asset e reconstruido uma vez e trocado em
+// todos os modelos que o usam
+struct AssetReload {
+    std::vector<SceneConfig::ObjectConfig> meshes;  // Um objeto de cada asset a reconstruir
+    std::vector<Model> rebuilt;
+    std::vector<char> meshOk;
+    std::vector<AssetStaging> staging;
+    std::vector<std::string> textures;        // Texturas alteradas (caminho lido pelo loader)
+    std::vector<StagedTexture> images;        // Decodificadas na thread de fundo
+    std::vector<GLuint> uploadedTextures;     // 0 = falhou
+    bool racingLineNeeded = false;            // Ha animacao "ANIMATION track" na cena
+    std::shared_ptr<const BezierTrack> racingLine;  // Linha refeita (nullptr = malha da pista intacta)
+    SceneGraph graph;                         // Hierarquia com as partes novas (sem malha nova: vazia)
+    std::vector<int> parents;
+    size_t uploadMesh = 0, uploadPart = 0;
+    double startTime = 0.0;
+};
+
+struct HotReload {
+    bool enabled = true;                      // --no-watch desliga
+    std::string path;                         // Arquivo observado (vazio = desligado)
+    int inotifyFd = -1;
+    time_t lastMtime = 0;
+    double lastPoll = 0.0;
+    double changedAt = -1.0;                  // Ultima gravacao vista (-1 = nenhuma pendente)
+    std::thread worker;
+    std::atomic<bool> ready{false};           // Carga em fundo terminou
+    std::unique_ptr<SceneReload> pending;     // Recarga em andamento
+    std::vector<int> objectModel;             // Por objeto de sceneConfig: modelo carregado ou -1
+    std::string configKey;                    // watchKey do arquivo de configuracao
+    std::map<std::string, time_t> watchedFiles;         // Configuracao + OBJ/MTL/texturas (chave -> mtime)
+    std::map<std::string, int> watchDirectories;        // Diretorio -> watch do inotify
+    std::unordered_map<int, std::string> watchNames;    // Watch -> diretorio
+    std::set<std::string> changedFiles;       // Gravacoes vistas e ainda nao recarregadas
+    std::unique_ptr<AssetReload> pendingAssets;         // Recarga de assets em andamento
+} hotReload;
+
+// O hot reload so observa a cena na janela interativa (nem headless nem benchmark)
+static bool hotReloadWanted() {
+    return hotReload.enabled && !headlessOptions.enabled && !benchOptions.enabled;
+}
+
+// Referencias aos objetos GL compartilhados: varios objetos do mesmo asset usam os mesmos
+// VAOs e texturas, e o hot reload troca esses objetos com a cena rodando. Cada parte que
+// usa um objeto conta uma referencia; quem solta a ultima apaga o objeto.
+struct GpuRefCounts {
+    std::unordered_map<GLuint, int> vertexArrays;
+    std::unordered_map<GLuint, int> textures;
+} gpuRefs;
+
+struct BenchStats {
+    std::vector<double> frameMs;              // Tempo total de cada frame medido
+    std::vector<double> cpuMs;                // Tempo de CPU ate a submissao do frame
+    std::vector<double> gpuMs;                // GL_TIME_ELAPSED do frame (lido com atraso)
+    GLuint gpuQueries[BENCH_GPU_QUERY_COUNT] = {0};
+    int gpuQueryFrame[BENCH_GPU_QUERY_COUNT] = {-1, -1, -1, -1};
+} benchStats;
+
+struct HeadlessContext {
+#ifdef GRAUB2_HAS_EGL
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+#endif
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0;
+    std::vector<unsigned char> pixels;        // Buffer de leitura reutilizado entre frames
+} headlessContext;
+
+// Iluminacao clusterizada (forward+): as luzes ativas ficam em um texture buffer e
+// cada cluster (froxel) do frustum guarda a lista de luzes que o atingem.
+// Usa texture buffers (GL 3.1) pois o loader GLAD do projeto e GL 4.0, sem SSBO.
+const int CLUSTER_X = 16;
+const int CLUSTER_Y = 9;
+const int CLUSTER_Z = 24;
+const float CLUSTER_NEAR = 0.01f;
+const float CLUSTER_FAR = 2000.0f;
+
+// Luz no formato enviado a GPU (2 texels RGBA32F por luz)
+struct GpuLight {
+    glm::vec4 positionRadius;   // xyz = posicao no mundo, w = raio (0 = global)
+    glm::vec4 colorIntensity;   // rgb = cor * intensidade * peso
+};
+
+struct ClusterAABB {
+    glm::vec3 minPoint;
+    glm::vec3 maxPoint;
+};
+
+struct ClusteredLighting {
+    GLuint lightBuffer = 0, lightTexture = 0;     // GpuLight[]
+    GLuint gridBuffer = 0, gridTexture = 0;       // (offset, contagem) por cluster
+    GLuint indexBuffer = 0, indexTexture = 0;     // indices de luzes concatenados
+    int screenWidth = 1, screenHeight = 1;
+    glm::mat4 projection;
+    std::vector<ClusterAABB> clusterBounds;       // AABBs dos clusters no espaco de view
+    std::vector<GpuLight> lights;                 // Luzes globais primeiro, depois as com raio
+    int globalLightCount = 0;
+    std::vector<GLuint> clusterCounts;            // Reutilizados a cada frame (sem realocacao)
+    std::vector<GLuint> clusterGrid;
+    std::vector<GLuint> lightIndices;
+    std::vector<glm::ivec3> lightRangeMin, lightRangeMax;
+    size_t residentBytes = 0;                     // Tamanho atual dos tres buffers (estatisticas)
+} clusteredLighting;
+
+// Pre-pass de profundidade: desenha so a profundidade das partes opacas e depois
+// sombreia com GL_EQUAL, evitando Phong em fragmentos que seriam sobrescritos
+bool depthPrepassEnabled = false;
+
+// Contagem de fragmentos sombreados (GL_SAMPLES_PASSED) lida com atraso de alguns
+// frames para nao travar o pipeline esperando o resultado
+const int FRAGMENT_QUERY_COUNT = 3;
+struct FragmentQueryStats {
+    GLuint queries[FRAGMENT_QUERY_COUNT] = {0};
+    bool pending[FRAGMENT_QUERY_COUNT] = {false};
+    int current = 0;
+    GLuint lastShadedFragments = 0;
+    double lastReportTime = 0.0;
+} fragmentStats;
+
+// Tempo de GPU por passo: pares de GL_TIMESTAMP (glQueryCounter) em volta de cada passo,
+// lidos GPU_TIMER_LATENCY frames depois para nunca esperar a GPU. Timestamps, e nao
+// GL_TIME_ELAPSED, para poder coexistir com a query de frame inteiro do benchmark.
+enum GpuPass {
+    GPU_PASS_CLEAR,
+    GPU_PASS_DEPTH_PREPASS,
+    GPU_PASS_OPAQUE,
+    GPU_PASS_DECALS,
+    GPU_PASS_COUNT
+};
+const char* GPU_PASS_NAMES[GPU_PASS_COUNT] = { "Clear", "Depth pre-pass", "Opaque", "Decals" };
+const int GPU_TIMER_LATENCY = 3;
+
+struct GpuPassTimers {
+    GLuint queries[GPU_TIMER_LATENCY][GPU_PASS_COUNT][2] = {};
+    bool issued[GPU_TIMER_LATENCY][GPU_PASS_COUNT] = {};
+    int slot = 0;                             // Conjunto de queries do frame atual
+    double rollingMs[GPU_PASS_COUNT] = {};    // Media movel exponencial (~60 frames)
+    double totalMs[GPU_PASS_COUNT] = {};
+    double maxMs[GPU_PASS_COUNT] = {};
+    int samples[GPU_PASS_COUNT] = {};
+    int64_t gpuToCpuOffsetNs = 0;             // Converte timestamps da GPU para o relogio do profiler
+#ifdef GRAUB2_PROFILER
+    ProfileThreadBuffer* traceTrack = nullptr;
+#endif
+} gpuTimers;
+
+void gpuPassBegin(GpuPass pass);
+void gpuPassEnd(GpuPass pass);
 
 // Vertex Shader
 const GLchar *vertexShaderSource = R"(
@@ -546,10 +1809,13 @@ out vec2 texCoord;
 out vec3 vNormal;
 out vec4 fragPos; 
 out vec4 vColor;
+out float viewDepth;
+invariant gl_Position;
 void main()
 {
    	gl_Position = projection * view * model * vec4(position, 1.0);
 	fragPos = model * vec4(position, 1.0);
+	viewDepth = -(view * fragPos).z;
 	texCoord = texc;
 	vNormal = mat3(transpose(inverse(model))) * normal;
 	vColor = vec4(color, 1.0);
@@ -560,25 +1826,51 @@ const GLchar *fragmentShaderSource = R"(
 #version 400
 in vec2 texCoord;
 uniform sampler2D texBuff;
-uniform vec3 lightPos1;
-uniform vec3 lightPos2;
-uniform vec3 lightPos3;
 uniform vec3 camPos;
 uniform vec3 materialKa;
 uniform vec3 materialKd;
 uniform vec3 materialKs;
 uniform float materialShininess;
-uniform float lightIntensity1;
-uniform float lightIntensity2;
-uniform float lightIntensity3;
 uniform int isDecalMaterial;
 out vec4 color;
 in vec4 fragPos;
 in vec3 vNormal;
 in vec4 vColor;
-uniform bool light1Enabled;
-uniform bool light2Enabled;
-uniform bool light3Enabled;
+in float viewDepth;
+
+// Dados da iluminacao clusterizada
+uniform samplerBuffer lightData;     // 2 texels por luz: (posicao, raio), (cor * intensidade)
+uniform usamplerBuffer clusterGrid;  // (offset, contagem) por cluster
+uniform usamplerBuffer lightIndices; // Lista concatenada de indices de luzes
+uniform ivec3 clusterDims;
+uniform vec2 clusterTileSize;
+uniform float clusterSliceScale;
+uniform float clusterSliceBias;
+uniform int globalLightCount;
+
+void addLight(int lightIndex, vec3 N, vec3 V, inout vec3 diffuse, inout vec3 specular)
+{
+	vec4 positionRadius = texelFetch(lightData, lightIndex * 2);
+	vec3 lightColor = texelFetch(lightData, lightIndex * 2 + 1).rgb;
+
+	vec3 toLight = positionRadius.xyz - vec3(fragPos);
+	float attenuation = 1.0;
+	if (positionRadius.w > 0.0) {
+		float ratio = dot(toLight, toLight) / (positionRadius.w * positionRadius.w);
+		attenuation = clamp(1.0 - ratio, 0.0, 1.0);
+		attenuation *= attenuation;
+		if (attenuation <= 0.0) return;
+	}
+
+	vec3 L = normalize(toLight);
+	float diff = max(dot(N, L), 0.0);
+	diffuse += materialKd * diff * lightColor * attenuation;
+
+	vec3 R = normalize(reflect(-L, N));
+	float spec = pow(max(dot(R, V), 0.0), materialShininess);
+	specular += materialKs * spec * lightColor * attenuation;
+}
+
 void main()
 {
 
@@ -611,40 +1903,22 @@ void main()
 	vec3 N = normalize(vNormal);
 	vec3 V = normalize(camPos - vec3(fragPos));
 
-	// Luz Principal
-	if (light1Enabled) {
-		vec3 L1 = normalize(lightPos1 - vec3(fragPos));
-		float diff1 = max(dot(N, L1),0.0);
-		diffuse += materialKd * diff1 * lightIntensity1 * vec3(1.0, 1.0, 1.0);
-		
-		vec3 R1 = normalize(reflect(-L1,N));
-		float spec1 = max(dot(R1,V),0.0);
-		spec1 = pow(spec1, materialShininess);
-		specular += materialKs * spec1 * lightIntensity1 * vec3(1.0, 1.0, 1.0);
-	}
-
-	// Luz de Preenchimento
-	if (light2Enabled) {
-		vec3 L2 = normalize(lightPos2 - vec3(fragPos));
-		float diff2 = max(dot(N, L2),0.0);
-		diffuse += materialKd * diff2 * lightIntensity2 * 0.4 * vec3(1.0, 1.0, 1.0);
-		
-		vec3 R2 = normalize(reflect(-L2,N));
-		float spec2 = max(dot(R2,V),0.0);
-		spec2 = pow(spec2, materialShininess);
-		specular += materialKs * spec2 * lightIntensity2 * 0.4 * vec3(1.0, 1.0, 1.0);
+	// Luzes globais (sem raio) atingem todos os fragmentos
+	for (int i = 0; i < globalLightCount; i++) {
+		addLight(i, N, V, diffuse, specular);
 	}
 
-	// Luz de Fundo
-	if (light3Enabled) {
-		vec3 L3 = normalize(lightPos3 - vec3(fragPos));
-		float diff3 = max(dot(N, L3),0.0);
-		diffuse += materialKd * diff3 * lightIntensity3 * 0.65 * vec3(1.0, 1.0, 1.0);
-		
-		vec3 R3 = normalize(reflect(-L3,N));
-		float spec3 = max(dot(R3,V),0.0);
-		spec3 = pow(spec3, materialShininess);
-		specular += materialKs * spec3 * lightIntensity3 * 0.65 * vec3(1.0, 1.0, 1.0);
+	// Luzes com raio: percorrer apenas as luzes do cluster deste fragmento
+	ivec2 tile = ivec2(gl_FragCoord.xy / clusterTileSize);
+	int slice = int(max(log(viewDepth) * clusterSliceScale - clusterSliceBias, 0.0));
+	tile = clamp(tile, ivec2(0), clusterDims.xy - 1);
+	slice = min(slice, clusterDims.z - 1);
+	int clusterIndex = tile.x + clusterDims.x * (tile.y + clusterDims.y * slice);
+
+	uvec2 cluster = texelFetch(clusterGrid, clusterIndex).xy;
+	for (uint i = 0u; i < cluster.y; i++) {
+		int lightIndex = int(texelFetch(lightIndices, int(cluster.x + i)).r);
+		addLight(lightIndex, N, V, diffuse, specular);
 	}
 
 	vec3 result;
@@ -669,48 +1943,190 @@ void main()
 
 })";
 
+// Shaders do pre-pass de profundidade (mesma transformacao do shader principal,
+// com gl_Position invariante para que GL_EQUAL funcione)
+const GLchar *depthVertexShaderSource = R"(
+#version 400
+layout (location = 0) in vec3 position;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+invariant gl_Position;
+void main()
+{
+   	gl_Position = projection * view * model * vec4(position, 1.0);
+})";
+
+const GLchar *depthFragmentShaderSource = R"(
+#version 400
+void main()
+{
+})";
+
+// HUD de desempenho: painel desenhado por cima da cena com FPS, grafico de tempo de
+// frame e os contadores de renderStats. Tudo vai em um unico VBO dinamico e um draw call.
+struct Hud {
+    bool visible = false;
+    GLuint program = 0;
+    GLuint VAO = 0, VBO = 0;
+    size_t vboCapacity = 0;
+    std::vector<GLfloat> vertices;            // x, y (pixels) + r, g, b, a por vertice
+    FILE* csv = nullptr;                      // Exportacao por frame (--stats-csv)
+} hud;
+
+// Fonte bitmap 3x5: 5 linhas de 3 bits, bit 14 = canto superior esquerdo
+const struct { char c; unsigned short bits; } HUD_FONT[] = {
+    {'0', 0x7B6F}, {'1', 0x2C97}, {'2', 0x73E7}, {'3', 0x73CF}, {'4', 0x5BC9}, {'5', 0x79CF}, {'6', 0x79EF}, {'7', 0x7249},
+    {'8', 0x7BEF}, {'9', 0x7BCF}, {'A', 0x2BED}, {'B', 0x6BAE}, {'C', 0x3923}, {'D', 0x6B6E}, {'E', 0x79A7}, {'F', 0x79A4},
+    {'G', 0x396B}, {'H', 0x5BED}, {'I', 0x7497}, {'J', 0x126A}, {'K', 0x5BAD}, {'L', 0x4927}, {'M', 0x5FED}, {'N', 0x6B6D},
+    {'O', 0x2B6A}, {'P', 0x6BA4}, {'Q', 0x2B73}, {'R', 0x6BAD}, {'S', 0x388E}, {'T', 0x7492}, {'U', 0x5B6F}, {'V', 0x5B6A},
+    {'W', 0x5BFD}, {'X', 0x5AAD}, {'Y', 0x5A92}, {'Z', 0x72A7}, {'.', 0x0002}, {':', 0x0410}, {'/', 0x12A4}, {'-', 0x01C0},
+    {'%', 0x52A5}, {'(', 0x2922}, {')', 0x224A},
+};
+
+const GLchar *hudVertexShaderSource = R"(
+#version 400
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec4 color;
+uniform vec2 screenSize;
+out vec4 vColor;
+void main()
+{
+	// Pixels com origem no canto superior esquerdo -> NDC
+	gl_Position = vec4(position.x / screenSize.x * 2.0 - 1.0, 1.0 - position.y / screenSize.y * 2.0, 0.0, 1.0);
+	vColor = color;
+})";
+
+const GLchar *hudFragmentShaderSource = R"(
+#version 400
+in vec4 vColor;
+out vec4 color;
+void main()
+{
+	color = vColor;
+})";
+
 // Funcao MAIN
-int main()
+int main(int argc, char** argv)
 {
-	// Inicializacao da GLFW
-	glfwInit();
+	logInit();
+
+	if (!parseCommandLine(argc, argv)) {
+		return 1;
+	}
+
+	// Pool de workers (o thread principal tambem executa jobs)
+	jobSystemStart(benchOptions.workerCount >= 0 ? benchOptions.workerCount
+	                                             : std::max(0, (int)std::thread::hardware_concurrency() - 1));
 
-	// Configuracao OpenGL (descomente se necessario para sua placa)
-	/*glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);*/
+	// Microbenchmarks de CPU: nao precisam de janela nem de contexto OpenGL
+	if (benchOptions.microbenchmark == "track") {
+		runTrackMicrobenchmark();
+		return 0;
+	}
+	if (benchOptions.microbenchmark == "animation") {
+		runAnimationMicrobenchmark();
+		return 0;
+	}
+	if (benchOptions.microbenchmark == "jobs") {
+		runJobsMicrobenchmark();
+		return 0;
+	}
+	if (benchOptions.microbenchmark == "keyframes") {
+		runKeyframeMicrobenchmark();
+		return 0;
+	}
+#ifdef GRAUB2_BENCH
+	if (benchOptions.microbenchmark == "config") {
+		runConfigMicrobenchmark();
+		return 0;
+	}
+	if (benchOptions.microbenchmark == "objload") {
+		runObjLoadMicrobenchmark();
+		return 0;
+	}
+#else
+	// Comparam com os loaders antigos, que so existem no GrauB2Bench
+	if (benchOptions.microbenchmark == "config" || benchOptions.microbenchmark == "objload") {
+		LOG_ERROR("--microbench " << benchOptions.microbenchmark << " so esta disponivel no GrauB2Bench");
+		return 1;
+	}
+#endif
+
+	// Converte a configuracao (texto ou binaria) para o formato binario e sai
+	if (!benchOptions.sceneExportPath.empty()) {
+		SceneConfig exported;
+		bool ok = loadSceneConfig(headlessOptions.configPath, exported) &&
+		          writeBinaryScene(benchOptions.sceneExportPath, exported);
+		LOG_INFO((ok ? "Cena binaria gravada em " : "Falha ao gravar a cena binaria ") << benchOptions.sceneExportPath);
+		return ok ? 0 : 1;
+	}
 
-	// Essencial para computadores da Apple
-	// #ifdef __APPLE__
-	//	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-	// #endif
+	// Gera uma cena sintetica para testes de escala e sai
+	if (!sceneGenerator.outputPath.empty()) {
+		return generateScene(sceneGenerator.outputPath) ? 0 : 1;
+	}
 
-	// Criacao da janela GLFW
-	GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "Luzes: 1-3 | TAB: Objeto | TRC: Modo | WASD: Move | ESPACO: Camera/Objeto | F: Animacao", nullptr, nullptr);
-	glfwMakeContextCurrent(window);
+	GLFWwindow *window = nullptr;
+	int width, height;
 
-	// Registro do callback de teclado
-	glfwSetKeyCallback(window, key_callback);
+	if (headlessOptions.enabled) {
+		// Sem display: GLFW so fornece o relogio (plataforma nula), contexto via EGL
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+		glfwInit();
+		if (!createHeadlessContext(headlessOptions.width, headlessOptions.height)) {
+			glfwTerminate();
+			return 1;
+		}
+		width = headlessOptions.width;
+		height = headlessOptions.height;
+	} else {
+		// Inicializacao da GLFW
+		glfwInit();
 
-	// Inicializar GLAD
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-	{
-		std::cout << "Failed to initialize GLAD" << std::endl;
+		// Configuracao OpenGL (descomente se necessario para sua placa)
+		/*glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);*/
+
+		// Essencial para computadores da Apple
+		// #ifdef __APPLE__
+		//	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+		// #endif
+
+		// Criacao da janela GLFW
+		window = glfwCreateWindow(WIDTH, HEIGHT, "Luzes: 1-3 | TAB: Objeto | TRC: Modo | WASD: Move | ESPACO: Camera/Objeto | F: Animacao", nullptr, nullptr);
+		glfwMakeContextCurrent(window);
+
+		// Registro do callback de teclado
+		glfwSetKeyCallback(window, key_callback);
+
+		// Inicializar GLAD
+		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+		{
+			LOG_ERROR("Failed to initialize GLAD");
+		}
+
+		glfwGetFramebufferSize(window, &width, &height);
 	}
 
 	// Informacoes de versao OpenGL
 	const GLubyte *renderer = glGetString(GL_RENDERER);
 	const GLubyte *version = glGetString(GL_VERSION);
-	cout << "Renderer: " << renderer << endl;
-	cout << "OpenGL version supported " << version << endl;
+	LOG_INFO("Renderer: " << renderer);
+	LOG_INFO("OpenGL version supported " << version);
 
 	// Configurar viewport
-	int width, height;
-	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
 	// Compilar shaders
 	GLuint shaderID = setupShader();
+	GLuint depthShaderID = setupDepthShader();
+	glGenQueries(FRAGMENT_QUERY_COUNT, fragmentStats.queries);
+	initGpuTimers();
+	initHud();
 	
 	// Configurar OpenGL
 	glEnable(GL_DEPTH_TEST);
@@ -721,7 +2137,7 @@ int main()
 	glDepthMask(GL_TRUE);
 
 	// Carregar configuracao da cena
-	bool configLoaded = loadSceneConfig("../src/GrauB2Config", sceneConfig);
+	bool configLoaded = loadSceneConfig(headlessOptions.configPath, sceneConfig);
 	if (!configLoaded) {
 		configLoaded = loadSceneConfig("src/GrauB2Config", sceneConfig);
 	}
@@ -734,62 +2150,84 @@ int main()
 
 	// Carregando objetos baseados na configuracao
 	if (configLoaded && !sceneConfig.objects.empty()) {
+		std::vector<int> configToModel;  // Objetos que falharam ao carregar nao viram modelo
+		loadMemory.rssStartKb = processMemoryKb("VmRSS:");
+		models.reserve(sceneConfig.objects.size());
+		objectAnimations.reserve(sceneConfig.objects.size());
 		for (const auto& objConfig : sceneConfig.objects) {
+			configToModel.push_back(-1);
 			Model model;
 			model.name = objConfig.filename;
+			model.parent = objConfig.parent >= 0 ? configToModel[objConfig.parent] : -1;
+			model.partNodes = objConfig.partNodes;
 			model.position = objConfig.position;
 			model.rotation = objConfig.rotation;
 			model.scale = objConfig.scale;
 			
-			// Tentar carregar material do arquivo .mtl primeiro
-			std::string mtlFile = getMTLFilename(objConfig.filename);
-			std::vector<Material> materials;
-			
-			if (loadMTL(mtlFile, materials)) {
-				if (!loadOBJWithMaterials(objConfig.filename.c_str(), model, materials)) {
-					continue;
-				}
-			} else {
-				// Fallback: usar loader antigo e criar material unico
-				std::vector<glm::vec3> vertices, normals;
-				std::vector<glm::vec2> uvs;
-				
-				if (loadOBJ(objConfig.filename.c_str(), vertices, uvs, normals)) {
-					ModelPart part;
-					part.vertices = vertices;
-					part.uvs = uvs;
-					part.normals = normals;
-					part.nVertices = vertices.size();
-					part.materialName = objConfig.materialType;
-					part.material = createMaterial(objConfig.materialType);
-					part.VAO = createModelPartVAO(part);
-					
-					model.parts.push_back(part);
-				} else {
-					continue;
-				}
+			// RSS e pico so no primeiro objeto de cada asset: os demais custam o mesmo, e
+			// ler /proc duas vezes por objeto pesa nas cenas de 100k+ objetos
+			std::string asset = sceneAssetKey(objConfig);
+			bool firstOfAsset = loadMemory.assets.find(asset) == loadMemory.assets.end();
+			size_t rssBeforeKb = firstOfAsset ? processMemoryKb("VmRSS:") : 0;
+			bool peakTracked = firstOfAsset && resetPeakMemory();
+			auto loadStart = std::chrono::steady_clock::now();
+			if (!loadSceneObject(objConfig, model)) {
+				continue;
 			}
+			double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+			retainModelGpu(model);
+			recordModelLoad(asset, model, rssBeforeKb, peakTracked, loadMs);
 			
-			models.push_back(model);
+			configToModel.back() = (int)models.size();
+			models.push_back(std::move(model));
 			objectAnimations.push_back(objConfig.animation);
 		}
+		hotReload.objectModel = configToModel;
+		loadScratch.release();
 	}
 
-	std::cout << "Objetos carregados: " << models.size() << std::endl;
-	std::cout << "Controles: TAB=selecionar | TRC=modo | WASD=mover | 123=luzes | F=animacao" << std::endl;
+	LOG_INFO("Objetos carregados: " << models.size());
+	computeSceneBounds();
+	buildSceneGraph();
+
+	// Pistas extraidas da malha (ANIMATION track); --extract-track grava a pista e sai
+	resolveMeshTracks();
+
+	// Caixas e pistas ja calculadas: as malhas na CPU ficam so se a politica pedir
+	size_t rssLoadedKb = processMemoryKb("VmRSS:");
+	applyMeshResidency();
+	if (!models.empty()) {
+		logLoadMemoryReport(rssLoadedKb);
+	}
+	if (!benchOptions.trackExportPath.empty()) {
+		bool exported = false;
+		for (const ObjectAnimation& animation : objectAnimations) {
+			if (animation.trackFromMesh && animation.bezierTrack) {
+				const BezierTrack& track = *animation.bezierTrack;
+				std::vector<glm::vec3> points(1, track.curves.front().p0);
+				for (const BezierCurve& curve : track.curves) {
+					points.insert(points.end(), { curve.p1, curve.p2, curve.p3 });
+				}
+				exported = writeTrackFile(benchOptions.trackExportPath, points, track.loop, (float)(track.totalLength / track.totalDuration));
+				break;
+			}
+		}
+		LOG_INFO((exported ? "Pista gravada em " : "Nenhuma pista extraida para gravar em ") << benchOptions.trackExportPath);
+		return exported ? 0 : 1;
+	}
+	LOG_INFO("Controles: TAB=selecionar | TRC=modo | WASD=mover | 123=luzes | F=animacao");
 
 
 	
-	// Configurar luzes baseado na configuracao
-	vec3 lightPos, lightPos2, lightPos3;
-	if (configLoaded && sceneConfig.lights.size() >= 3) {
-		lightPos = sceneConfig.lights[0].position;
-		lightPos2 = sceneConfig.lights[1].position;
-		lightPos3 = sceneConfig.lights[2].position;
-	} else {
-		lightPos = vec3(2.0, 3.0, 4.0);
-		lightPos2 = vec3(-2.0, 1.0, 2.0);
-		lightPos3 = vec3(0.0, 1.0, -3.0);
+	// Configurar luzes baseado na configuracao (luzes padrao se nenhuma foi definida)
+	if (!configLoaded || sceneConfig.lights.empty()) {
+		addDefaultLights(sceneConfig);
+	}
+
+	// Observa o arquivo de configuracao para recarregar a cena sem reiniciar
+	if (configLoaded && hotReloadWanted()) {
+		std::string watchedPath = findSceneConfigPath(headlessOptions.configPath);
+		hotReloadStart(watchedPath.empty() ? findSceneConfigPath("src/GrauB2Config") : watchedPath);
 	}
 	
 	vec3 camPos = camera.position;
@@ -807,72 +2245,135 @@ int main()
 
 	// Matriz de projecao perspectiva
 	float fov = (configLoaded) ? sceneConfig.camera.fov : 45.0f;
-	mat4 projection = perspective(radians(fov), (float)WIDTH / (float)HEIGHT, 0.01f, 2000.0f);
+	mat4 projection = perspective(radians(fov), (float)width / (float)height, 0.01f, 2000.0f);
 	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+	glUseProgram(depthShaderID);
+	glUniformMatrix4fv(glGetUniformLocation(depthShaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+	glUseProgram(shaderID);
+
+	// Grade de clusters para as luzes (usa o tamanho real do framebuffer)
+	initClusteredLighting(width, height, projection);
+
+	// Benchmark: caminho da câmera do arquivo ou orbita padrao em torno do alvo
+	if (benchOptions.enabled) {
+		if (sceneConfig.cameraPath.curves.empty()) {
+			buildDefaultCameraPath(sceneConfig.cameraPath, camera.position, camera.target);
+		}
+		buildArcLengthTable(sceneConfig.cameraPath);
+		glGenQueries(BENCH_GPU_QUERY_COUNT, benchStats.gpuQueries);
+		if (window) {
+			glfwSwapInterval(0); // Sem vsync para medir o custo real do frame
+		}
+	}
 
-	// Loop principal
-	float lastFrame = 0.0f;
-	while (!glfwWindowShouldClose(window))
+	// Loop principal (o relogio comeca apos o carregamento para o primeiro deltaTime nao incluir o load)
+	float lastFrame = glfwGetTime();
+	int frameIndex = 0;
+	int totalFrames = headlessOptions.frames + (benchOptions.enabled ? benchOptions.warmupFrames : 0);
+	bool fixedFrameCount = headlessOptions.enabled || benchOptions.enabled;
+	double loopStart = glfwGetTime();
+	if (headlessOptions.animate || benchOptions.enabled) {
+		animationEnabled = true;
+	}
+	while (fixedFrameCount ? frameIndex < totalFrames && !(window && glfwWindowShouldClose(window))
+	                       : !glfwWindowShouldClose(window))
 	{
+		PROFILE_SCOPE("Frame");
+		beginFrameStats();
+
 		// Calcular deltaTime para animacões suaves
-		float currentFrame = glfwGetTime();
+		double frameStart = glfwGetTime();
+		float currentFrame = frameStart;
 		float deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		// Processar eventos de input
-		glfwPollEvents();
+		// Benchmark: tempo fixo e câmera no caminho roteirizado, independentes da maquina
+		if (benchOptions.enabled) {
+			deltaTime = benchOptions.fixedDelta;
+			glm::vec3 pathDirection;
+			camera.position = calculateBezierTrackPosition(sceneConfig.cameraPath, frameIndex * benchOptions.fixedDelta, pathDirection);
+			camera.target = sceneConfig.camera.target;
 
-		// Atualizar animacões se estiverem ativadas
-		if (animationEnabled) {
-			updateAnimations(deltaTime);
-			applyAnimationsToModels();
+			int slot = frameIndex % BENCH_GPU_QUERY_COUNT;
+			glBeginQuery(GL_TIME_ELAPSED, benchStats.gpuQueries[slot]);
+			benchStats.gpuQueryFrame[slot] = frameIndex;
 		}
 
-		// Atualiza a matriz de view da câmera
-		updateCameraMatrix(shaderID);
+		// Processar eventos de input e aplicar o movimento das teclas pressionadas
+		glfwPollEvents();
+		if (!benchOptions.enabled) {
+			processInput(deltaTime);
+		}
 
-		// Posicões das luzes (sempre fixas)
-		glUniform3f(glGetUniformLocation(shaderID, "lightPos1"), lightPos.x, lightPos.y, lightPos.z);
-		glUniform3f(glGetUniformLocation(shaderID, "lightPos2"), lightPos2.x, lightPos2.y, lightPos2.z);
-		glUniform3f(glGetUniformLocation(shaderID, "lightPos3"), lightPos3.x, lightPos3.y, lightPos3.z);
+		// Hot reload: aplica a configuracao nova quando a carga em fundo termina
+		if (hotReloadPoll() && sceneConfig.camera.fov != fov) {
+			fov = sceneConfig.camera.fov;
+			projection = perspective(radians(fov), (float)width / (float)height, 0.01f, 2000.0f);
+			glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+			glUseProgram(depthShaderID);
+			glUniformMatrix4fv(glGetUniformLocation(depthShaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+			glUseProgram(shaderID);
+			setClusterProjection(projection);
+		}
 
-		// Intensidades das luzes (com animacao se ativada)
+		// Atualizar animacões se estiverem ativadas (passos fixos + interpolacao)
 		if (animationEnabled) {
-			// Luzes piscando com intensidades variaveis
-			vec3 light1Intensity = calculateLightIntensity(0, animationTime);
-			vec3 light2Intensity = calculateLightIntensity(1, animationTime);
-			vec3 light3Intensity = calculateLightIntensity(2, animationTime);
-			
-			glUniform1f(glGetUniformLocation(shaderID, "lightIntensity1"), light1Intensity.x);
-			glUniform1f(glGetUniformLocation(shaderID, "lightIntensity2"), light2Intensity.x);
-			glUniform1f(glGetUniformLocation(shaderID, "lightIntensity3"), light3Intensity.x);
+			updateSimulation(deltaTime);
 		} else {
-			// Intensidades normais quando animacao esta desativada
-			glUniform1f(glGetUniformLocation(shaderID, "lightIntensity1"), 1.0f);
-			glUniform1f(glGetUniformLocation(shaderID, "lightIntensity2"), 1.0f);
-			glUniform1f(glGetUniformLocation(shaderID, "lightIntensity3"), 1.0f);
+			simulation.primed = false;
 		}
 
-		// Atualiza os uniformes das luzes no shader
-		glUniform1i(glGetUniformLocation(shaderID, "light1Enabled"), light1Enabled);
-		glUniform1i(glGetUniformLocation(shaderID, "light2Enabled"), light2Enabled);
-		glUniform1i(glGetUniformLocation(shaderID, "light3Enabled"), light3Enabled);
+		// Atualiza a matriz de view da câmera
+		mat4 view = updateCameraMatrix(shaderID);
+
+		// Matrizes de mundo, caixas e frustum culling de todos os modelos (em paralelo)
+		updateSceneTransforms(projection * view);
+
+		// Distribui as luzes ativas nos clusters do frustum e envia para a GPU
+		updateLightClusters(shaderID, view);
+
+		// Coleta os tempos de GPU de frames anteriores
+		gpuTimersBeginFrame();
 
 		// Limpar buffers
+		gpuPassBegin(GPU_PASS_CLEAR);
 		glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		gpuPassEnd(GPU_PASS_CLEAR);
 		
 		// Estado OpenGL
 		glEnable(GL_DEPTH_TEST);
 		glDepthFunc(GL_LESS);
 		glDepthMask(GL_TRUE);
 
+		// Pre-pass: apenas profundidade, sem escrita de cor
+		if (depthPrepassEnabled) {
+			gpuPassBegin(GPU_PASS_DEPTH_PREPASS);
+			glUseProgram(depthShaderID);
+			glUniformMatrix4fv(glGetUniformLocation(depthShaderID, "view"), 1, GL_FALSE, value_ptr(view));
+			renderStats.uniformUpdates++;
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			for (size_t i = 0; i < models.size(); i++) {
+				drawModelDepth(depthShaderID, models[i]);
+			}
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glUseProgram(shaderID);
+
+			gpuPassEnd(GPU_PASS_DEPTH_PREPASS);
+
+			// Passo principal sombreia apenas o fragmento visivel de cada pixel
+			glDepthFunc(GL_EQUAL);
+		}
 
+		// Conta os fragmentos que passam no teste de profundidade no passo principal
+		readFragmentQuery();
+		glBeginQuery(GL_SAMPLES_PASSED, fragmentStats.queries[fragmentStats.current]);
 
-		// Desenha todos os modelos
+		// Desenha todos os modelos (partes opacas)
+		gpuPassBegin(GPU_PASS_OPAQUE);
 		for (size_t i = 0; i < models.size(); i++) {
 			// Destaca o modelo selecionado
-			if (i == selectedModelIndex) {
+			if ((int)i == selectedModelIndex) {
 				glLineWidth(3.0f);
 				glPointSize(8.0f);
 			} else {
@@ -880,171 +2381,920 @@ int main()
 				glPointSize(1.0f);
 			}
 			
-			drawModel(shaderID, models[i]);
+			drawModel(shaderID, models[i], PARTS_OPAQUE);
+		}
+		gpuPassEnd(GPU_PASS_OPAQUE);
+
+		// Placas/decals depois das partes opacas
+		gpuPassBegin(GPU_PASS_DECALS);
+		for (size_t i = 0; i < models.size(); i++) {
+			drawModel(shaderID, models[i], PARTS_DECALS);
+		}
+		gpuPassEnd(GPU_PASS_DECALS);
+
+		glEndQuery(GL_SAMPLES_PASSED);
+		fragmentStats.pending[fragmentStats.current] = true;
+		fragmentStats.current = (fragmentStats.current + 1) % FRAGMENT_QUERY_COUNT;
+		glDepthFunc(GL_LESS);
+
+		// HUD por cima da cena, fora da query de fragmentos (nao entra nos contadores do frame)
+		if (hud.visible) {
+			drawHud(width, height);
+			glUseProgram(shaderID);
+		}
+
+		if (benchOptions.enabled) {
+			glEndQuery(GL_TIME_ELAPSED);
+		}
+		double cpuEnd = glfwGetTime();
+
+		// Troca os buffers da tela (ou finaliza o frame no FBO headless)
+		{
+			PROFILE_SCOPE("Swap");
+			if (headlessOptions.enabled) {
+				finishHeadlessFrame(frameIndex);
+			} else {
+				glfwSwapBuffers(window);
+			}
+		}
+
+		double frameEnd = glfwGetTime();
+		endFrameStats((float)((frameEnd - frameStart) * 1000.0), frameIndex);
+		if (benchOptions.enabled) {
+			recordBenchFrame(frameStart, cpuEnd, frameEnd);
 		}
+		frameIndex++;
+	}
+
+	if (benchOptions.enabled) {
+		writeBenchResults((const char*)renderer, (const char*)version, width, height);
+		glDeleteQueries(BENCH_GPU_QUERY_COUNT, benchStats.gpuQueries);
+	}
 
-		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+	if (!headlessOptions.tracePath.empty()) {
+		profilerDumpChromeTrace(headlessOptions.tracePath);
+	}
+	if (headlessOptions.enabled || benchOptions.enabled) {
+		printGpuPassTable();
+	}
+
+	if (headlessOptions.enabled) {
+		double elapsed = glfwGetTime() - loopStart;
+		LOG_INFO("Headless: " << frameIndex << " frames em " << elapsed << "s ("
+		         << (frameIndex > 0 ? elapsed * 1000.0 / frameIndex : 0.0) << " ms/frame)");
 	}
 	// Cleanup
+	hotReloadStop();
 	for (Model& model : models) {
-		for (ModelPart& part : model.parts) {
-			glDeleteVertexArrays(1, &part.VAO);
-		}
+		releaseModelGpu(model);
+	}
+	destroyClusteredLighting();
+	glDeleteQueries(FRAGMENT_QUERY_COUNT, fragmentStats.queries);
+	destroyGpuTimers();
+	destroyHud();
+	jobSystemStop();
+	if (headlessOptions.enabled) {
+		destroyHeadlessContext();
 	}
 	glfwTerminate();
 	return 0;
 }
 
-// Callback de teclado
-void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
-{
-	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
-		glfwSetWindowShouldClose(window, GL_TRUE);
-	
-	// Alternar entre controle de câmera e objetos
-	if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
-		cameraControlMode = !cameraControlMode;
-		if (cameraControlMode) {
-			std::cout << "=== MODO CAMERA ATIVO === (WASD: mover, QE: subir/descer)" << std::endl;
-		} else {
-			std::cout << "=== MODO OBJETO ATIVO === (TAB: selecionar, TRC: modo)" << std::endl;
+// Cria o diretorio (um nivel) se ainda nao existir
+static bool ensureDirectory(const std::string& path) {
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0) {
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+		if (stat(path.c_str(), &info) != 0) {
+			return false;
 		}
 	}
-	
-	// Controle de animacao
-	if (key == GLFW_KEY_F && action == GLFW_PRESS) {
-		animationEnabled = !animationEnabled;
-		if (animationEnabled) {
-			std::cout << "ANIMACAO ATIVADA!" << std::endl;
+	return (info.st_mode & S_IFMT) == S_IFDIR;
+}
+
+// Le as opcoes de linha de comando. Sem opcoes, roda com janela como antes.
+bool parseCommandLine(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--headless") {
+			headlessOptions.enabled = true;
+		} else if (arg == "--frames" && hasValue) {
+			headlessOptions.frames = atoi(argv[++i]);
+		} else if (arg == "--size" && hasValue) {
+			if (sscanf(argv[++i], "%dx%d", &headlessOptions.width, &headlessOptions.height) != 2 ||
+			    headlessOptions.width <= 0 || headlessOptions.height <= 0) {
+				LOG_ERROR("Tamanho invalido (use LARGURAxALTURA, ambos maiores que zero): " << argv[i]);
+				return false;
+			}
+		} else if (arg == "--dump" && hasValue) {
+			headlessOptions.dumpDir = argv[++i];
+			// Cria o diretorio agora: sem ele cada frame falharia ao salvar o PNG
+			if (!ensureDirectory(headlessOptions.dumpDir)) {
+				LOG_ERROR("Nao foi possivel criar o diretorio " << headlessOptions.dumpDir);
+				return false;
+			}
+		} else if (arg == "--config" && hasValue) {
+			headlessOptions.configPath = argv[++i];
+		} else if (arg == "--animate") {
+			headlessOptions.animate = true;
+		} else if (arg == "--stats-csv" && hasValue) {
+			hud.csv = fopen(argv[++i], "w");
+			if (hud.csv == NULL) {
+				LOG_ERROR("Nao foi possivel escrever " << argv[i]);
+				return false;
+			}
+		} else if (arg == "--hud") {
+			hud.visible = true;
+		} else if (arg == "--trace" && hasValue) {
+			headlessOptions.tracePath = argv[++i];
+		} else if (arg == "--bench") {
+			benchOptions.enabled = true;
+		} else if (arg == "--windowed") {
+			headlessOptions.enabled = false;
+		} else if (arg == "--warmup" && hasValue) {
+			benchOptions.warmupFrames = atoi(argv[++i]);
+		} else if (arg == "--dt" && hasValue) {
+			benchOptions.fixedDelta = (float)atof(argv[++i]);
+		} else if (arg == "--sim-hz" && hasValue) {
+			simulation.hz = std::max(1.0f, (float)atof(argv[++i]));
+		} else if (arg == "--workers" && hasValue) {
+			benchOptions.workerCount = std::max(0, atoi(argv[++i]));
+		} else if (arg == "--residency" && hasValue) {
+			std::string residency = argv[++i];
+			if (residency == "gpu") {
+				meshResidency = RESIDENCY_GPU_ONLY;
+			} else if (residency == "cpu") {
+				meshResidency = RESIDENCY_CPU_GPU;
+			} else if (residency == "compact") {
+				meshResidency = RESIDENCY_COMPACT;
+			} else {
+				LOG_ERROR("Residencia invalida (use gpu|cpu|compact): " << residency);
+				return false;
+			}
+		} else if (arg == "--no-watch") {
+			hotReload.enabled = false;
+		} else if (arg == "--export-scene" && hasValue) {
+			benchOptions.sceneExportPath = argv[++i];
+		} else if (arg == "--generate-scene" && hasValue) {
+			sceneGenerator.outputPath = argv[++i];
+		} else if (arg == "--gen-count" && hasValue) {
+			sceneGenerator.count = (size_t)std::max(0LL, atoll(argv[++i]));
+		} else if (arg == "--gen-assets" && hasValue) {
+			sceneGenerator.assets = argv[++i];
+		} else if (arg == "--gen-layout" && hasValue) {
+			sceneGenerator.layout = argv[++i];
+		} else if (arg == "--gen-anim" && hasValue) {
+			sceneGenerator.animations = argv[++i];
+		} else if (arg == "--gen-lights" && hasValue) {
+			sceneGenerator.lights = std::max(0, atoi(argv[++i]));
+		} else if (arg == "--gen-seed" && hasValue) {
+			sceneGenerator.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+		} else if (arg == "--gen-track" && hasValue) {
+			sceneGenerator.trackPath = argv[++i];
+		} else if (arg == "--extract-track" && hasValue) {
+			benchOptions.trackExportPath = argv[++i];
+		} else if (arg == "--microbench" && hasValue) {
+			benchOptions.microbenchmark = argv[++i];
+		} else if (arg == "--json" && hasValue) {
+			benchOptions.jsonPath = argv[++i];
 		} else {
-			std::cout << "ANIMACAO DESATIVADA" << std::endl;
+			LOG_INFO("Uso: " << argv[0] << " [--headless|--windowed] [--frames N] [--size LxA] [--dump DIR] [--config ARQUIVO] [--animate] [--trace ARQUIVO]");
+			LOG_INFO("      [--hud] [--stats-csv ARQUIVO] [--sim-hz N] [--extract-track ARQUIVO] [--export-scene ARQUIVO] [--no-watch]");
+			LOG_INFO("      [--residency gpu|cpu|compact]");
+			LOG_INFO("      [--generate-scene ARQUIVO] [--gen-count N] [--gen-assets nome:peso,...] [--gen-layout grid|clustered|track]");
+			LOG_INFO("      [--gen-anim none:peso,orbit:peso,bezier:peso,track:peso] [--gen-lights N] [--gen-seed N] [--gen-track ARQUIVO]");
+			LOG_INFO("      [--bench] [--warmup N] [--dt SEGUNDOS] [--json ARQUIVO] [--microbench track|animation|jobs|keyframes|config|objload] [--workers N]");
+			return false;
 		}
 	}
-	
-	// Selecao de objetos (apenas no modo objeto)
-	if (!cameraControlMode && key == GLFW_KEY_TAB && action == GLFW_PRESS) {
-		selectedModelIndex = (selectedModelIndex + 1) % models.size();
-		std::cout << "Modelo selecionado: " << selectedModelIndex << std::endl;
+	return true;
+}
+
+void initHud() {
+	hud.program = compileShaderProgram(hudVertexShaderSource, hudFragmentShaderSource);
+	glGenVertexArrays(1, &hud.VAO);
+	glGenBuffers(1, &hud.VBO);
+
+	glBindVertexArray(hud.VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, hud.VBO);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(0));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+
+	if (hud.csv) {
+		fprintf(hud.csv, "frame,frame_ms,draw_calls,triangles,texture_binds,uniform_updates,culled_parts,texture_bytes,buffer_bytes\n");
 	}
-	
-	// Controle das luzes
-	if (action == GLFW_PRESS) {
-		if (key == GLFW_KEY_1) {
-			light1Enabled = !light1Enabled;
-			std::cout << "Luz Principal " << (light1Enabled ? "ligada" : "desligada") << std::endl;
-		}
-		else if (key == GLFW_KEY_2) {
-			light2Enabled = !light2Enabled;
-			std::cout << "Luz de Preenchimento: " << (light2Enabled ? "ligada" : "desligada") << std::endl;
-		}
-		else if (key == GLFW_KEY_3) {
-			light3Enabled = !light3Enabled;
-			std::cout << "Luz de Fundo: " << (light3Enabled ? "ligada" : "desligada") << std::endl;
+}
+
+void beginFrameStats() {
+	renderStats.drawCalls = 0;
+	renderStats.triangles = 0;
+	renderStats.textureBinds = 0;
+	renderStats.uniformUpdates = 0;
+	renderStats.culledParts = 0;
+}
+
+// Fecha o frame: guarda o tempo no historico do grafico e grava a linha do CSV
+void endFrameStats(float frameMs, int frameIndex) {
+	renderStats.lastFrameMs = frameMs;
+	renderStats.frameHistoryMs[renderStats.historyIndex] = frameMs;
+	renderStats.historyIndex = (renderStats.historyIndex + 1) % HUD_HISTORY;
+
+	if (hud.csv) {
+		fprintf(hud.csv, "%d,%.4f,%u,%u,%u,%u,%u,%zu,%zu\n", frameIndex, frameMs,
+		        renderStats.drawCalls, renderStats.triangles, renderStats.textureBinds,
+		        renderStats.uniformUpdates, renderStats.culledParts,
+		        renderStats.textureBytes, renderStats.bufferBytes);
+	}
+}
+
+static void hudAddRect(float x, float y, float w, float h, const glm::vec4& color) {
+	const float corners[6][2] = { {x, y}, {x + w, y}, {x + w, y + h}, {x, y}, {x + w, y + h}, {x, y + h} };
+	for (const auto& corner : corners) {
+		hud.vertices.insert(hud.vertices.end(), { corner[0], corner[1], color.x, color.y, color.z, color.w });
+	}
+}
+
+static void hudAddText(float x, float y, float pixel, const char* text, const glm::vec4& color) {
+	for (const char* c = text; *c; c++, x += 4.0f * pixel) {
+		char upper = (char)toupper((unsigned char)*c);
+		for (const auto& glyph : HUD_FONT) {
+			if (glyph.c != upper) continue;
+			for (int bit = 0; bit < 15; bit++) {
+				if (glyph.bits & (1 << (14 - bit))) {
+					hudAddRect(x + (bit % 3) * pixel, y + (bit / 3) * pixel, pixel, pixel, color);
+				}
+			}
+			break;
 		}
-		
+	}
+}
+
+void drawHud(int width, int height) {
+	float pixel = (float)std::max(1, height / 360);   // Tamanho de um pixel da fonte
+	float line = 7.0f * pixel;
+	float margin = 4.0f * pixel;
+	float graphHeight = 30.0f * pixel;
+	float barWidth = pixel;
+	float panelWidth = std::max(36.0f * 4.0f * pixel, HUD_HISTORY * barWidth) + 2.0f * margin;
+	float panelHeight = 6.0f * line + graphHeight + 3.0f * margin;
+	glm::vec4 white(1.0f), gray(0.7f, 0.7f, 0.7f, 1.0f);
+
+	hud.vertices.clear();
+	hudAddRect(8.0f, 8.0f, panelWidth, panelHeight, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+
+	char text[96];
+	float x = 8.0f + margin, y = 8.0f + margin;
+	float fps = renderStats.lastFrameMs > 0.0f ? 1000.0f / renderStats.lastFrameMs : 0.0f;
+	snprintf(text, sizeof(text), "FPS %.1f  FRAME %.2f MS", fps, renderStats.lastFrameMs);
+	hudAddText(x, y, pixel, text, white); y += line;
+	snprintf(text, sizeof(text), "DRAWS %u  TRIS %u", renderStats.drawCalls, renderStats.triangles);
+	hudAddText(x, y, pixel, text, white); y += line;
+	snprintf(text, sizeof(text), "TEX BINDS %u  UNIFORMS %u", renderStats.textureBinds, renderStats.uniformUpdates);
+	hudAddText(x, y, pixel, text, white); y += line;
+	snprintf(text, sizeof(text), "CULLED PARTS %u", renderStats.culledParts);
+	hudAddText(x, y, pixel, text, white); y += line;
+	snprintf(text, sizeof(text), "TEX MEM %.1f MB  VBO %.1f MB", renderStats.textureBytes / 1048576.0,
+	         renderStats.bufferBytes / 1048576.0);
+	hudAddText(x, y, pixel, text, white); y += line;
+	hudAddText(x, y, pixel, "FRAME TIME (0-33 MS)", gray); y += line;
+
+	// Grafico: uma barra por frame, do mais antigo ao mais recente; linha em 16.7 ms
+	float graphBottom = y + graphHeight;
+	for (int i = 0; i < HUD_HISTORY; i++) {
+		float ms = renderStats.frameHistoryMs[(renderStats.historyIndex + i) % HUD_HISTORY];
+		float barHeight = std::min(ms / 33.3f, 1.0f) * graphHeight;
+		glm::vec4 color = ms < 16.7f ? glm::vec4(0.2f, 0.9f, 0.2f, 1.0f)
+		                : ms < 33.3f ? glm::vec4(0.9f, 0.8f, 0.2f, 1.0f)
+		                             : glm::vec4(0.9f, 0.2f, 0.2f, 1.0f);
+		hudAddRect(x + i * barWidth, graphBottom - barHeight, barWidth, barHeight, color);
+	}
+	hudAddRect(x, graphBottom - graphHeight * 0.5f, HUD_HISTORY * barWidth, 1.0f, glm::vec4(1.0f, 1.0f, 1.0f, 0.5f));
+
+	// Envia e desenha (o buffer so cresce; orphaning evita esperar o frame anterior)
+	size_t bytes = hud.vertices.size() * sizeof(GLfloat);
+	glBindBuffer(GL_ARRAY_BUFFER, hud.VBO);
+	if (bytes > hud.vboCapacity) {
+		renderStats.bufferBytes += bytes * 2 - hud.vboCapacity;
+		hud.vboCapacity = bytes * 2;
+	}
+	glBufferData(GL_ARRAY_BUFFER, hud.vboCapacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, hud.vertices.data());
+
+	glUseProgram(hud.program);
+	glUniform2f(glGetUniformLocation(hud.program, "screenSize"), (float)width, (float)height);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glBindVertexArray(hud.VAO);
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(hud.vertices.size() / 6));
+	glBindVertexArray(0);
+
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+}
+
+void destroyHud() {
+	glDeleteVertexArrays(1, &hud.VAO);
+	glDeleteBuffers(1, &hud.VBO);
+	glDeleteProgram(hud.program);
+	if (hud.csv) {
+		fclose(hud.csv);
+		hud.csv = nullptr;
+	}
+}
+
+void initGpuTimers() {
+	glGenQueries(GPU_TIMER_LATENCY * GPU_PASS_COUNT * 2, &gpuTimers.queries[0][0][0]);
+
+	// Diferenca entre o relogio da GPU e o do profiler, para alinhar as trilhas no trace
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+#ifdef GRAUB2_PROFILER
+	gpuTimers.gpuToCpuOffsetNs = (int64_t)profilerNowNs() - gpuNow;
+	gpuTimers.traceTrack = profilerCreateTrack("GPU");
+#endif
+}
+
+// Le os resultados do conjunto de queries emitido GPU_TIMER_LATENCY frames atras
+// e o libera para o frame atual
+void gpuTimersBeginFrame() {
+	gpuTimers.slot = (gpuTimers.slot + 1) % GPU_TIMER_LATENCY;
+	int slot = gpuTimers.slot;
+
+	for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+		if (!gpuTimers.issued[slot][pass]) continue;
+		gpuTimers.issued[slot][pass] = false;
+
+		GLuint64 start = 0, end = 0;
+		glGetQueryObjectui64v(gpuTimers.queries[slot][pass][0], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(gpuTimers.queries[slot][pass][1], GL_QUERY_RESULT, &end);
+		double ms = (end - start) / 1.0e6;
+
+		gpuTimers.rollingMs[pass] = gpuTimers.samples[pass] == 0 ? ms : gpuTimers.rollingMs[pass] * 0.95 + ms * 0.05;
+		gpuTimers.totalMs[pass] += ms;
+		gpuTimers.maxMs[pass] = std::max(gpuTimers.maxMs[pass], ms);
+		gpuTimers.samples[pass]++;
+
+#ifdef GRAUB2_PROFILER
+		profilerRecord(gpuTimers.traceTrack, GPU_PASS_NAMES[pass],
+		               (uint64_t)((int64_t)start + gpuTimers.gpuToCpuOffsetNs),
+		               (uint64_t)((int64_t)end + gpuTimers.gpuToCpuOffsetNs));
+#endif
+	}
+}
+
+void gpuPassBegin(GpuPass pass) {
+	glQueryCounter(gpuTimers.queries[gpuTimers.slot][pass][0], GL_TIMESTAMP);
+}
+
+void gpuPassEnd(GpuPass pass) {
+	glQueryCounter(gpuTimers.queries[gpuTimers.slot][pass][1], GL_TIMESTAMP);
+	gpuTimers.issued[gpuTimers.slot][pass] = true;
+}
+
+void printGpuPassTable() {
+	LOG_INFO("Tempo de GPU por passo (ms): media movel | media | maximo | amostras");
+	for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+		int count = gpuTimers.samples[pass];
+		char line[160];
+		snprintf(line, sizeof(line), "  %-16s %8.3f | %8.3f | %8.3f | %d", GPU_PASS_NAMES[pass],
+		         gpuTimers.rollingMs[pass], count > 0 ? gpuTimers.totalMs[pass] / count : 0.0,
+		         gpuTimers.maxMs[pass], count);
+		LOG_INFO(line);
+	}
+}
+
+void destroyGpuTimers() {
+	glDeleteQueries(GPU_TIMER_LATENCY * GPU_PASS_COUNT * 2, &gpuTimers.queries[0][0][0]);
+}
+
+// Salva as amostras ainda presentes nos ring buffers como JSON trace_event do Chrome.
+// Amostras sendo sobrescritas por outras threads durante o dump podem sair inconsistentes.
+bool profilerDumpChromeTrace(const std::string& path) {
+#ifdef GRAUB2_PROFILER
+	FILE* out = fopen(path.c_str(), "w");
+	if (out == NULL) {
+		LOG_ERROR("Nao foi possivel escrever " << path);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(profiler.registryMutex);
+	size_t written = 0;
+	fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (ProfileThreadBuffer* buffer : profiler.buffers) {
+		if (buffer->trackName != nullptr) {
+			fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			        written++ ? ",\n" : "", buffer->threadId, buffer->trackName);
+		}
+		uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+		uint64_t begin = end > PROFILE_RING_SIZE ? end - PROFILE_RING_SIZE : 0;
+		for (uint64_t i = begin; i < end; i++) {
+			const ProfileSample& sample = buffer->samples[i & (PROFILE_RING_SIZE - 1)];
+			fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			        written++ ? ",\n" : "", sample.name, buffer->threadId,
+			        sample.startNs / 1000.0, (sample.endNs - sample.startNs) / 1000.0);
+		}
+	}
+	fprintf(out, "\n]}\n");
+	fclose(out);
+	LOG_INFO("Trace de CPU salvo em " << path << " (" << written << " amostras)");
+	return true;
+#else
+	LOG_WARN("Profiler desativado na compilacao (GRAUB2_PROFILER), trace nao salvo: " << path);
+	return false;
+#endif
+}
+
+// Orbita padrao da câmera para o benchmark: quatro quartos de circulo Bézier em torno
+// do alvo, na altura e distancia da câmera configurada (volta completa em 20 s)
+void buildDefaultCameraPath(BezierTrack& path, const glm::vec3& eye, const glm::vec3& center) {
+	glm::vec3 offset = eye - center;
+	float radius = std::max(length(glm::vec3(offset.x, 0.0f, offset.z)), 1.0f);
+	float height = eye.y;
+	const float k = 0.5523f * radius; // Aproximacao de arco circular com Bézier cúbica
+
+	path.curves.clear();
+	path.loop = true;
+	path.totalDuration = 0.0f;
+	glm::vec3 axisA(radius, 0.0f, 0.0f), axisB(0.0f, 0.0f, radius);
+	for (int q = 0; q < 4; q++) {
+		BezierCurve curve;
+		glm::vec3 dirA = axisA / radius, dirB = axisB / radius;
+		glm::vec3 base(center.x, height, center.z);
+		curve.p0 = base + axisA;
+		curve.p1 = base + axisA + dirB * k;
+		curve.p2 = base + axisB + dirA * k;
+		curve.p3 = base + axisB;
+		curve.duration = 5.0f;
+		curve.loop = false;
+		path.curves.push_back(curve);
+		path.totalDuration += curve.duration;
+
+		// Proximo quarto: gira os eixos 90 graus
+		glm::vec3 next = -axisA;
+		axisA = axisB;
+		axisB = next;
+	}
+}
+
+// Guarda os tempos de um frame (apos o aquecimento) e le a query de GPU mais antiga
+void recordBenchFrame(double frameStart, double cpuEnd, double frameEnd) {
+	static int recordedFrames = 0;
+	int frame = recordedFrames++;
+
+	// Query que sera reutilizada no proximo frame: le agora (emitida ha N-1 frames)
+	int slot = (frame + 1) % BENCH_GPU_QUERY_COUNT;
+	int queryFrame = benchStats.gpuQueryFrame[slot];
+	if (queryFrame >= benchOptions.warmupFrames) {
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(benchStats.gpuQueries[slot], GL_QUERY_RESULT, &elapsed);
+		benchStats.gpuMs.push_back(elapsed / 1.0e6);
+	}
+	benchStats.gpuQueryFrame[slot] = -1;
+
+	if (frame < benchOptions.warmupFrames) return;
+	benchStats.frameMs.push_back((frameEnd - frameStart) * 1000.0);
+	benchStats.cpuMs.push_back((cpuEnd - frameStart) * 1000.0);
+}
+
+static double percentile(std::vector<double> values, double p) {
+	if (values.empty()) return 0.0;
+	std::sort(values.begin(), values.end());
+	size_t index = (size_t)std::ceil(p * values.size());
+	return values[std::min(std::max(index, (size_t)1), values.size()) - 1];
+}
+
+static double mean(const std::vector<double>& values) {
+	if (values.empty()) return 0.0;
+	double sum = 0.0;
+	for (double v : values) sum += v;
+	return sum / values.size();
+}
+
+// Texto como string JSON (sem as aspas): escapa aspas, barras e caracteres de controle,
+// ex.: caminhos do Windows e nomes de renderer vindos do driver
+static std::string jsonEscape(const char* text) {
+	std::string escaped;
+	for (const char* c = text ? text : ""; *c != '\0'; c++) {
+		unsigned char ch = (unsigned char)*c;
+		switch (ch) {
+			case '"':  escaped += "\\\""; break;
+			case '\\': escaped += "\\\\"; break;
+			case '\n': escaped += "\\n"; break;
+			case '\r': escaped += "\\r"; break;
+			case '\t': escaped += "\\t"; break;
+			default:
+				if (ch < 0x20) {
+					char code[8];
+					snprintf(code, sizeof(code), "\\u%04x", ch);
+					escaped += code;
+				} else {
+					escaped += (char)ch;
+				}
+		}
+	}
+	return escaped;
+}
+
+// Drena as queries pendentes e grava min/media/p95/p99 em JSON
+void writeBenchResults(const char* renderer, const char* version, int width, int height) {
+	for (int slot = 0; slot < BENCH_GPU_QUERY_COUNT; slot++) {
+		if (benchStats.gpuQueryFrame[slot] >= benchOptions.warmupFrames) {
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(benchStats.gpuQueries[slot], GL_QUERY_RESULT, &elapsed);
+			benchStats.gpuMs.push_back(elapsed / 1.0e6);
+		}
+	}
+
+	const std::vector<double>& frames = benchStats.frameMs;
+	double frameMin = frames.empty() ? 0.0 : *std::min_element(frames.begin(), frames.end());
+
+	FILE* out = fopen(benchOptions.jsonPath.c_str(), "w");
+	if (out == NULL) {
+		LOG_ERROR("Nao foi possivel escrever " << benchOptions.jsonPath);
+		return;
+	}
+	fprintf(out, "{\n");
+#ifdef GRAUB2_GIT_COMMIT
+	fprintf(out, "  \"commit\": \"%s\",\n", jsonEscape(GRAUB2_GIT_COMMIT).c_str());
+#endif
+	fprintf(out, "  \"renderer\": \"%s\",\n", jsonEscape(renderer).c_str());
+	fprintf(out, "  \"gl_version\": \"%s\",\n", jsonEscape(version).c_str());
+	fprintf(out, "  \"config\": \"%s\",\n", jsonEscape(headlessOptions.configPath.c_str()).c_str());
+	fprintf(out, "  \"headless\": %s,\n", headlessOptions.enabled ? "true" : "false");
+	fprintf(out, "  \"width\": %d,\n  \"height\": %d,\n", width, height);
+	fprintf(out, "  \"warmup_frames\": %d,\n", benchOptions.warmupFrames);
+	fprintf(out, "  \"frames\": %zu,\n", frames.size());
+	fprintf(out, "  \"fixed_dt\": %.6f,\n", benchOptions.fixedDelta);
+	fprintf(out, "  \"frame_ms\": { \"min\": %.4f, \"mean\": %.4f, \"p95\": %.4f, \"p99\": %.4f },\n",
+	        frameMin, mean(frames), percentile(frames, 0.95), percentile(frames, 0.99));
+	fprintf(out, "  \"cpu_ms\": { \"mean\": %.4f, \"p95\": %.4f, \"p99\": %.4f },\n",
+	        mean(benchStats.cpuMs), percentile(benchStats.cpuMs, 0.95), percentile(benchStats.cpuMs, 0.99));
+	fprintf(out, "  \"gpu_ms\": { \"mean\": %.4f, \"p95\": %.4f, \"p99\": %.4f },\n",
+	        mean(benchStats.gpuMs), percentile(benchStats.gpuMs, 0.95), percentile(benchStats.gpuMs, 0.99));
+	fprintf(out, "  \"gpu_pass_ms\": {");
+	for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+		double passMean = gpuTimers.samples[pass] > 0 ? gpuTimers.totalMs[pass] / gpuTimers.samples[pass] : 0.0;
+		fprintf(out, "%s \"%s\": %.4f", pass ? "," : "", jsonEscape(GPU_PASS_NAMES[pass]).c_str(), passMean);
+	}
+	fprintf(out, " }\n");
+	fprintf(out, "}\n");
+	fclose(out);
+
+	LOG_INFO("Benchmark: " << frames.size() << " frames, media " << mean(frames) << " ms, p99 "
+	         << percentile(frames, 0.99) << " ms (CPU " << mean(benchStats.cpuMs) << " ms, GPU "
+	         << mean(benchStats.gpuMs) << " ms) -> " << benchOptions.jsonPath);
+}
+
+// Microbenchmark da amostragem de pistas: gera pistas aleatorias com continuidade C1 e
+// mede amostras por segundo da busca linear antiga e da tabela de comprimento de arco
+void runTrackMicrobenchmark() {
+    const int SEGMENT_COUNTS[] = { 16, 256, 4096, 65536 };
+    const int SAMPLES = 1000000;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> jitter(-10.0f, 10.0f);
+
+    LOG_INFO("Microbenchmark de pista (" << SAMPLES << " amostras por medida)");
+    LOG_INFO("  curvas | tabela (ms) | entradas | linear (amostras/s) | arco (amostras/s)");
+    for (int segments : SEGMENT_COUNTS) {
+        BezierTrack track;
+        track.loop = true;
+        // Voltas em torno da origem (16 curvas por volta) para as coordenadas ficarem limitadas
+        glm::vec3 position(100.0f, 0.0f, 0.0f), previousControl(100.0f, 0.0f, -1.0f);
+        for (int i = 0; i < segments; i++) {
+            float angle = (i + 1) * 2.0f * (float)M_PI / 16.0f;
+            BezierCurve curve;
+            curve.p0 = position;
+            curve.p1 = position + (position - previousControl);   // Tangente continua
+            curve.p3 = glm::vec3((100.0f + jitter(rng)) * cos(angle), jitter(rng) * 0.1f, (100.0f + jitter(rng)) * sin(angle));
+            curve.p2 = curve.p3 + glm::vec3(jitter(rng), 0.0f, jitter(rng));
+            curve.duration = 1.0f + (jitter(rng) + 10.0f) * 0.1f;
+            curve.loop = false;
+            track.curves.push_back(curve);
+            track.totalDuration += curve.duration;
+            position = curve.p3;
+            previousControl = curve.p2;
+        }
+
+        // Tempos de amostra iguais para os dois metodos
+        std::vector<float> times(SAMPLES);
+        std::uniform_real_distribution<float> timeDistribution(0.0f, track.totalDuration);
+        for (float& t : times) t = timeDistribution(rng);
+
+        BezierTrack linearTrack = track;   // Sem tabela: caminho de busca linear
+
+        auto start = std::chrono::steady_clock::now();
+        buildArcLengthTable(track);
+        double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        auto measure = [&](const BezierTrack& sampled) {
+            glm::vec3 direction, checksum(0.0f);
+            // A busca linear e O(n): limita as amostras para pistas grandes
+            int count = sampled.arcDistance.empty() ? std::min(SAMPLES, 20000000 / segments) : SAMPLES;
+            auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < count; i++) {
+                checksum += calculateBezierTrackPosition(sampled, times[i], direction);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            volatile float sink = checksum.x + checksum.y + checksum.z;   // Impede que o loop seja removido
+            (void)sink;
+            return count / seconds;
+        };
+        double linearRate = measure(linearTrack);
+        double arcRate = measure(track);
+
+        char line[128];
+        snprintf(line, sizeof(line), "  %6d | %11.2f | %8zu | %19.0f | %17.0f",
+                 segments, buildMs, track.arcDistance.size(), linearRate, arcRate);
+        LOG_INFO(line);
+    }
+}
+
+// Cria um contexto OpenGL sem superficie (EGL_MESA_platform_surfaceless) e um FBO
+// com cor e profundidade do tamanho pedido, onde todos os frames sao desenhados
+bool createHeadlessContext(int width, int height) {
+#ifdef GRAUB2_HAS_EGL
+	HeadlessContext& ctx = headlessContext;
+
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay) {
+		ctx.display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (ctx.display == EGL_NO_DISPLAY) {
+		ctx.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major, minor;
+	if (ctx.display == EGL_NO_DISPLAY || !eglInitialize(ctx.display, &major, &minor)) {
+		LOG_ERROR("Falha ao inicializar EGL");
+		return false;
+	}
+
+	// Sem superficie nao e preciso escolher config (EGL_KHR_no_config_context)
+	EGLConfig config = (EGLConfig)0;
+	EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLint numConfigs = 0;
+	eglChooseConfig(ctx.display, configAttribs, &config, 1, &numConfigs);
+
+	eglBindAPI(EGL_OPENGL_API);
+	EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 0,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+		EGL_NONE
+	};
+	ctx.context = eglCreateContext(ctx.display, numConfigs > 0 ? config : (EGLConfig)0, EGL_NO_CONTEXT, contextAttribs);
+	if (ctx.context == EGL_NO_CONTEXT ||
+	    !eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx.context)) {
+		LOG_ERROR("Falha ao criar contexto EGL sem superficie (erro 0x" << std::hex << eglGetError() << std::dec << ")");
+		if (ctx.context != EGL_NO_CONTEXT) {
+			eglDestroyContext(ctx.display, ctx.context);
+		}
+		eglTerminate(ctx.display);
+		return false;
+	}
+
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+		LOG_ERROR("Failed to initialize GLAD");
+		// Sem GLAD nao ha funcoes GL: libera so o contexto e o display
+		eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(ctx.display, ctx.context);
+		eglTerminate(ctx.display);
+		return false;
+	}
+
+	// FBO de destino: todos os passos desenham aqui em vez do framebuffer padrao
+	glGenFramebuffers(1, &ctx.framebuffer);
+	glGenRenderbuffers(1, &ctx.colorBuffer);
+	glGenRenderbuffers(1, &ctx.depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, ctx.colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, ctx.depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, ctx.framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ctx.colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, ctx.depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		LOG_ERROR("FBO headless incompleto");
+		destroyHeadlessContext();
+		return false;
+	}
+
+	if (!headlessOptions.dumpDir.empty()) {
+		ctx.pixels.resize((size_t)width * height * 4);
+	}
+	return true;
+#else
+	(void)width; (void)height;
+	LOG_WARN("Modo headless indisponivel: compilado sem suporte a EGL");
+	return false;
+#endif
+}
+
+// Termina o frame headless: salva PNG se pedido, senao apenas espera a GPU
+// (equivalente ao swap, para que o tempo por frame seja real)
+void finishHeadlessFrame(int frameIndex) {
+	if (headlessOptions.dumpDir.empty()) {
+		glFinish();
+		return;
+	}
+
+	int width = headlessOptions.width;
+	int height = headlessOptions.height;
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, headlessContext.pixels.data());
+
+	char path[512];
+	snprintf(path, sizeof(path), "%s/frame_%05d.png", headlessOptions.dumpDir.c_str(), frameIndex);
+	stbi_flip_vertically_on_write(1); // OpenGL le de baixo para cima
+	if (!stbi_write_png(path, width, height, 4, headlessContext.pixels.data(), width * 4)) {
+		LOG_ERROR("Falha ao salvar " << path);
+	}
+}
+
+void destroyHeadlessContext() {
+	HeadlessContext& ctx = headlessContext;
+	glDeleteFramebuffers(1, &ctx.framebuffer);
+	glDeleteRenderbuffers(1, &ctx.colorBuffer);
+	glDeleteRenderbuffers(1, &ctx.depthBuffer);
+#ifdef GRAUB2_HAS_EGL
+	eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(ctx.display, ctx.context);
+	eglTerminate(ctx.display);
+#endif
+}
+
+// Callback de teclado
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
+{
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+	
+	// Alternar entre controle de câmera e objetos
+	if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
+		cameraControlMode = !cameraControlMode;
+		if (cameraControlMode) {
+			LOG_INFO("=== MODO CAMERA ATIVO === (WASD: mover, QE: subir/descer)");
+		} else {
+			LOG_INFO("=== MODO OBJETO ATIVO === (TAB: selecionar, TRC: modo)");
+		}
+	}
+	
+	// Salvar trace de CPU (formato do Chrome) sob demanda
+	if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+		static int traceCount = 0;
+		profilerDumpChromeTrace("trace_" + std::to_string(traceCount++) + ".json");
+	}
+
+	// HUD de desempenho
+	if (key == GLFW_KEY_H && action == GLFW_PRESS) {
+		hud.visible = !hud.visible;
+	}
+
+	// Tabela de tempos de GPU por passo
+	if (key == GLFW_KEY_F10 && action == GLFW_PRESS) {
+		printGpuPassTable();
+	}
+
+	// Pre-pass de profundidade
+	if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+		depthPrepassEnabled = !depthPrepassEnabled;
+		LOG_INFO("Pre-pass de profundidade " << (depthPrepassEnabled ? "ativado" : "desativado"));
+	}
+
+	// Controle de animacao
+	if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+		animationEnabled = !animationEnabled;
+		if (animationEnabled) {
+			LOG_INFO("ANIMACAO ATIVADA!");
+		} else {
+			LOG_INFO("ANIMACAO DESATIVADA");
+		}
+	}
+	
+	// Selecao de objetos (apenas no modo objeto)
+	if (!cameraControlMode && key == GLFW_KEY_TAB && action == GLFW_PRESS) {
+		selectedModelIndex = (selectedModelIndex + 1) % models.size();
+		LOG_INFO("Modelo selecionado: " << selectedModelIndex);
+	}
+	
+	// Controle das luzes
+	if (action == GLFW_PRESS) {
+		if (key == GLFW_KEY_1 && sceneConfig.lights.size() > 0) {
+			sceneConfig.lights[0].enabled = !sceneConfig.lights[0].enabled;
+			LOG_INFO("Luz Principal " << (sceneConfig.lights[0].enabled ? "ligada" : "desligada"));
+		}
+		else if (key == GLFW_KEY_2 && sceneConfig.lights.size() > 1) {
+			sceneConfig.lights[1].enabled = !sceneConfig.lights[1].enabled;
+			LOG_INFO("Luz de Preenchimento: " << (sceneConfig.lights[1].enabled ? "ligada" : "desligada"));
+		}
+		else if (key == GLFW_KEY_3 && sceneConfig.lights.size() > 2) {
+			sceneConfig.lights[2].enabled = !sceneConfig.lights[2].enabled;
+			LOG_INFO("Luz de Fundo: " << (sceneConfig.lights[2].enabled ? "ligada" : "desligada"));
+		}
+		
 		// Modos de transformacao (apenas no modo objeto)
 		else if (!cameraControlMode && key == GLFW_KEY_T) {
 			isTranslating = true;
 			isScaling = false;
 			isRotating = false;
 			currentMode = TRANSLATE;
-			std::cout << "Modo: Translacao" << std::endl;
+			LOG_INFO("Modo: Translacao");
 		}
 		else if (!cameraControlMode && key == GLFW_KEY_C) {
 			isTranslating = false;
 			isScaling = true;
 			isRotating = false;
 			currentMode = SCALE;
-			std::cout << "Modo: Escala" << std::endl;
+			LOG_INFO("Modo: Escala");
 		}
 		else if (!cameraControlMode && key == GLFW_KEY_R) {
 			isTranslating = false;
 			isScaling = false;
 			isRotating = true;
 			currentMode = ROTATE;
-			std::cout << "Modo: Rotacao" << std::endl;
+			LOG_INFO("Modo: Rotacao");
 		}
 	}
 	
-	// Controle da câmera ou transformacões do modelo selecionado
-	if ((action == GLFW_PRESS || action == GLFW_REPEAT)) {
-		float deltaTime = 0.016f; // ~60 FPS
-		
-		if (cameraControlMode) {
-			// Controle da câmera
-			processCameraMovement(key, deltaTime);
-		}
-		else if (models.size() > 0) {
-			// Transformacões do modelo selecionado
-			Model& selectedModel = models[selectedModelIndex];
-			float step = 0.1f;
-			float rotationStep = 5.0f;
-			
-			if (isTranslating) {
-				if (key == GLFW_KEY_LEFT || key == GLFW_KEY_A) {
-					selectedModel.position.x -= step;
-					std::cout << "Movendo para esquerda" << std::endl;
-				}
-				if (key == GLFW_KEY_RIGHT || key == GLFW_KEY_D) {
-					selectedModel.position.x += step;
-					std::cout << "Movendo para direita" << std::endl;
-				}
-				if (key == GLFW_KEY_UP || key == GLFW_KEY_W) {
-					selectedModel.position.y += step;
-					std::cout << "Movendo para cima" << std::endl;
-				}
-				if (key == GLFW_KEY_DOWN || key == GLFW_KEY_S) {
-					selectedModel.position.y -= step;
-					std::cout << "Movendo para baixo" << std::endl;
-				}
-			}
-			else if (isScaling) {
-				if (key == GLFW_KEY_LEFT || key == GLFW_KEY_A) {
-					selectedModel.scale -= vec3(step);
-					std::cout << "Diminuindo escala" << std::endl;
-				}
-				if (key == GLFW_KEY_RIGHT || key == GLFW_KEY_D) {
-					selectedModel.scale += vec3(step);
-					std::cout << "Aumentando escala" << std::endl;
-				}
-				if (key == GLFW_KEY_UP || key == GLFW_KEY_W) {
-					selectedModel.scale += vec3(step);
-					std::cout << "Aumentando escala" << std::endl;
-				}
-				if (key == GLFW_KEY_DOWN || key == GLFW_KEY_S) {
-					selectedModel.scale -= vec3(step);
-					std::cout << "Diminuindo escala" << std::endl;
-				}
-			}
-			else if (isRotating) {
-				if (key == GLFW_KEY_LEFT || key == GLFW_KEY_A) {
-					selectedModel.rotation.y -= rotationStep;
-					std::cout << "Rotacionando Y para esquerda" << std::endl;
-				}
-				if (key == GLFW_KEY_RIGHT || key == GLFW_KEY_D) {
-					selectedModel.rotation.y += rotationStep;
-					std::cout << "Rotacionando Y para direita" << std::endl;
-				}
-				if (key == GLFW_KEY_UP || key == GLFW_KEY_W) {
-					selectedModel.rotation.x += rotationStep;
-					std::cout << "Rotacionando X para cima" << std::endl;
-				}
-				if (key == GLFW_KEY_DOWN || key == GLFW_KEY_S) {
-					selectedModel.rotation.x -= rotationStep;
-					std::cout << "Rotacionando X para baixo" << std::endl;
-				}
-			}
+	// Movimento continuo: apenas registra o estado, aplicado em processInput
+	if (key >= 0 && key <= GLFW_KEY_LAST) {
+		if (action == GLFW_PRESS) {
+			input.keys[key] = true;
+		} else if (action == GLFW_RELEASE) {
+			input.keys[key] = false;
 		}
 	}
 }
 
+// Aplica uma vez por frame o movimento das teclas mantidas pressionadas
+void processInput(float deltaTime)
+{
+	PROFILE_SCOPE("Input");
+
+	if (cameraControlMode) {
+		processCameraMovement(deltaTime);
+		return;
+	}
+	if (models.empty()) {
+		return;
+	}
+
+	// Eixos: -1, 0 ou +1 conforme as teclas (setas ou WASD)
+	float horizontal = 0.0f, vertical = 0.0f;
+	if (input.keys[GLFW_KEY_LEFT] || input.keys[GLFW_KEY_A]) horizontal -= 1.0f;
+	if (input.keys[GLFW_KEY_RIGHT] || input.keys[GLFW_KEY_D]) horizontal += 1.0f;
+	if (input.keys[GLFW_KEY_UP] || input.keys[GLFW_KEY_W]) vertical += 1.0f;
+	if (input.keys[GLFW_KEY_DOWN] || input.keys[GLFW_KEY_S]) vertical -= 1.0f;
+	if (horizontal == 0.0f && vertical == 0.0f) {
+		return;
+	}
+
+	// Transformacões do modelo selecionado
+	Model& selectedModel = models[selectedModelIndex];
+	if (isTranslating) {
+		selectedModel.position.x += horizontal * OBJECT_MOVE_SPEED * deltaTime;
+		selectedModel.position.y += vertical * OBJECT_MOVE_SPEED * deltaTime;
+	}
+	else if (isScaling) {
+		selectedModel.scale += vec3((horizontal + vertical) * OBJECT_SCALE_SPEED * deltaTime);
+	}
+	else if (isRotating) {
+		selectedModel.rotation.y += horizontal * OBJECT_ROTATE_SPEED * deltaTime;
+		selectedModel.rotation.x += vertical * OBJECT_ROTATE_SPEED * deltaTime;
+	}
+}
+
 // Compila e linka os shaders
 int setupShader()
+{
+	return compileShaderProgram(vertexShaderSource, fragmentShaderSource);
+}
+
+// Shader do pre-pass de profundidade (apenas posicoes)
+int setupDepthShader()
+{
+	return compileShaderProgram(depthVertexShaderSource, depthFragmentShaderSource);
+}
+
+GLuint compileShaderProgram(const GLchar* vertexSource, const GLchar* fragmentSource)
 {
 	// Vertex shader
 	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+	glShaderSource(vertexShader, 1, &vertexSource, NULL);
 	glCompileShader(vertexShader);
 	// Checando erros de compilacao
 	GLint success;
@@ -1053,20 +3303,20 @@ int setupShader()
 	if (!success)
 	{
 		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
+		LOG_ERROR("ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
+				  << infoLog);
 	}
 	// Fragment shader
 	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+	glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
 	glCompileShader(fragmentShader);
 	// Checando erros de compilacao
 	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
 	if (!success)
 	{
 		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
+		LOG_ERROR("ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
+				  << infoLog);
 	}
 	// Linkando os shaders e criando o identificador do programa de shader
 	GLuint shaderProgram = glCreateProgram();
@@ -1078,8 +3328,8 @@ int setupShader()
 	if (!success)
 	{
 		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
+		LOG_ERROR("ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+				  << infoLog);
 	}
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
@@ -1088,6 +3338,28 @@ int setupShader()
 }
 
 GLuint loadTexture(string filePath, int &width, int &height)
+{
+	// Carregamento da imagem usando a funcao stbi_load da biblioteca stb_image
+	int nrChannels;
+
+	unsigned char *data;
+	{
+		PROFILE_SCOPE("Texture decode");
+		data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
+	}
+
+	if (!data)
+	{
+		LOG_ERROR("Failed to load texture " << filePath);
+	}
+
+	GLuint texID = createTexture(data, width, height, nrChannels);
+	stbi_image_free(data);
+	return texID;
+}
+
+// Cria a textura a partir de uma imagem ja decodificada (data nulo = textura vazia)
+GLuint createTexture(const unsigned char* data, int width, int height, int nrChannels)
 {
 	GLuint texID; // id da textura a ser carregada
 
@@ -1102,13 +3374,9 @@ GLuint loadTexture(string filePath, int &width, int &height)
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	// Carregamento da imagem usando a funcao stbi_load da biblioteca stb_image
-	int nrChannels;
-
-	unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
 	if (data)
 	{
+		PROFILE_SCOPE("Texture upload");
 		if (nrChannels == 3) // jpg, bmp
 		{
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
@@ -1118,13 +3386,10 @@ GLuint loadTexture(string filePath, int &width, int &height)
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 		}
 		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture " << filePath << std::endl;
-	}
 
-	stbi_image_free(data);
+		// Imagem base + cadeia de mipmaps (~1/3 a mais)
+		renderStats.textureBytes += (size_t)width * height * (nrChannels == 3 ? 3 : 4) * 4 / 3;
+	}
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 
@@ -1150,51 +3415,8 @@ void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, f
 }
 
 GLuint createSimpleVAO(const std::vector<vec3>& vertices, const std::vector<vec2>& uvs, const std::vector<vec3>& normals) {
-    // Buffer simples - apenas posicao, cor fixa, normal basica e UV padrao
-    std::vector<GLfloat> vBuffer;
-    vec3 color = vec3(1.0f, 0.5f, 0.0f); // Laranja
-    
-    for (size_t i = 0; i < vertices.size(); i++) {
-        // Posicao
-        vBuffer.push_back(vertices[i].x);
-        vBuffer.push_back(vertices[i].y);
-        vBuffer.push_back(vertices[i].z);
-        
-        // Cor fixa
-        vBuffer.push_back(color.r);
-        vBuffer.push_back(color.g);
-        vBuffer.push_back(color.b);
-        
-        // Normal basica (apontando pra frente)
-        vBuffer.push_back(normals[i].x);
-        vBuffer.push_back(normals[i].y);
-        vBuffer.push_back(normals[i].z);
-        
-        // UV padrao
-        vBuffer.push_back(uvs[i].x);
-        vBuffer.push_back(uvs[i].y);
-    }
-
-    GLuint VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
-
-    // Configurar atributos
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(0));
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(9 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(3);
-
-    glBindVertexArray(0);
-    return VAO;
+    // Buffer simples - cor fixa laranja
+    return createInterleavedVAO(vertices.data(), normals.data(), uvs.data(), vertices.size(), vec3(1.0f, 0.5f, 0.0f));
 }
 
 GLuint createModelVAO(const Model& model) {
@@ -1206,7 +3428,7 @@ GLuint createModelVAO(const Model& model) {
     return 0;
 }
 
-void drawModel(GLuint shaderID, const Model& model) {
+mat4 computeModelMatrix(const Model& model) {
     // Matriz de modelo: transformacões na geometria (objeto)
     mat4 modelMatrix = mat4(1); // matriz identidade
     
@@ -1216,34 +3438,118 @@ void drawModel(GLuint shaderID, const Model& model) {
     modelMatrix = rotate(modelMatrix, radians(model.rotation.y), vec3(0.0f, 1.0f, 0.0f));
     modelMatrix = rotate(modelMatrix, radians(model.rotation.z), vec3(0.0f, 0.0f, 1.0f));
     modelMatrix = scale(modelMatrix, model.scale);
-    
-    glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(modelMatrix));
+    return modelMatrix;
+}
 
-    // Desenhar cada parte do modelo com seu proprio material
-    for (size_t partIndex = 0; partIndex < model.parts.size(); partIndex++) {
-        const auto& part = model.parts[partIndex];
-        
-        // Garantir que o estado do OpenGL está limpo para esta parte
-        glDisable(GL_BLEND);
-        glEnable(GL_DEPTH_TEST);
-        glDepthMask(GL_TRUE);
-        
-        // Enviar propriedades do material específicas desta parte
-        glUniform3fv(glGetUniformLocation(shaderID, "materialKa"), 1, value_ptr(part.material.ka));
-        glUniform3fv(glGetUniformLocation(shaderID, "materialKd"), 1, value_ptr(part.material.kd));
-        glUniform3fv(glGetUniformLocation(shaderID, "materialKs"), 1, value_ptr(part.material.ks));
-        glUniform1f(glGetUniformLocation(shaderID, "materialShininess"), part.material.shininess);
-        
-        // Indicar se é material de placa/decal
-        int isDecal = (part.materialName == "Decals") ? 1 : 0;
-        glUniform1i(glGetUniformLocation(shaderID, "isDecalMaterial"), isDecal);
+// Matriz de mundo de uma parte: a do proprio no (PART) ou a do modelo
+static const mat4& partWorldMatrix(const Model& model, const ModelPart& part) {
+    return part.node >= 0 ? sceneGraph.nodes[part.node].world : model.worldMatrix;
+}
 
-        // Aplicar textura específica desta parte
-        glActiveTexture(GL_TEXTURE0);
+// Desenha apenas a profundidade do modelo (sem material ou textura)
+void drawModelDepth(GLuint depthShaderID, const Model& model) {
+    GLint modelLocation = glGetUniformLocation(depthShaderID, "model");
+    const mat4* boundMatrix = nullptr;
+
+    for (const auto& part : model.parts) {
+        if (part.visible && part.depthVAO != 0 && part.nVertices > 0) {
+            const mat4& partMatrix = partWorldMatrix(model, part);
+            if (&partMatrix != boundMatrix) {
+                glUniformMatrix4fv(modelLocation, 1, GL_FALSE, value_ptr(partMatrix));
+                renderStats.uniformUpdates++;
+                boundMatrix = &partMatrix;
+            }
+            glBindVertexArray(part.depthVAO);
+            glDrawArrays(GL_TRIANGLES, 0, part.nVertices);
+            renderStats.drawCalls++;
+            renderStats.triangles += part.nVertices / 3;
+        }
+    }
+    glBindVertexArray(0);
+}
+
+// Le o resultado da query que sera reutilizada e reporta uma vez por segundo. Ela foi
+// emitida FRAGMENT_QUERY_COUNT frames atras, entao o resultado normalmente ja esta pronto.
+void readFragmentQuery() {
+    int slot = fragmentStats.current;
+    if (fragmentStats.pending[slot]) {
+        glGetQueryObjectuiv(fragmentStats.queries[slot], GL_QUERY_RESULT, &fragmentStats.lastShadedFragments);
+        fragmentStats.pending[slot] = false;
+    }
+
+    double now = glfwGetTime();
+    if (now - fragmentStats.lastReportTime >= 1.0) {
+        fragmentStats.lastReportTime = now;
+        LOG_INFO("Fragmentos sombreados: " << fragmentStats.lastShadedFragments
+                 << " (pre-pass " << (depthPrepassEnabled ? "ligado" : "desligado") << ")");
+    }
+}
+
+// Desenha as partes do modelo; o filtro separa as placas (Decals) em um passo proprio
+void drawModel(GLuint shaderID, const Model& model, PartFilter filter) {
+    PROFILE_SCOPE("drawModel");
+
+    // Nada a desenhar neste passo: evita enviar a matriz de modelo
+    if (filter != PARTS_ALL) {
+        bool hasParts = false;
+        for (const auto& part : model.parts) {
+            if (part.visible && (part.materialName == "Decals") == (filter == PARTS_DECALS)) {
+                hasParts = true;
+                break;
+            }
+        }
+        if (!hasParts) return;
+    }
+
+    // Matriz de modelo enviada so quando muda (partes com no proprio tem outra)
+    GLint modelLocation = glGetUniformLocation(shaderID, "model");
+    const mat4* boundMatrix = nullptr;
+
+    // Desenhar cada parte do modelo com seu proprio material
+    for (size_t partIndex = 0; partIndex < model.parts.size(); partIndex++) {
+        const auto& part = model.parts[partIndex];
+        if (!part.visible) {
+            continue;
+        }
+        if (filter != PARTS_ALL && (part.materialName == "Decals") != (filter == PARTS_DECALS)) {
+            continue;
+        }
+        
+        const mat4& partMatrix = partWorldMatrix(model, part);
+        if (&partMatrix != boundMatrix) {
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, value_ptr(partMatrix));
+            renderStats.uniformUpdates++;
+            boundMatrix = &partMatrix;
+        }
+
+        // Garantir que o estado do OpenGL está limpo para esta parte
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+        
+        // Enviar propriedades do material específicas desta parte
+        const Material& material = model.materials[part.materialId];
+        glUniform3fv(glGetUniformLocation(shaderID, "materialKa"), 1, value_ptr(material.ka));
+        renderStats.uniformUpdates++;
+        glUniform3fv(glGetUniformLocation(shaderID, "materialKd"), 1, value_ptr(material.kd));
+        renderStats.uniformUpdates++;
+        glUniform3fv(glGetUniformLocation(shaderID, "materialKs"), 1, value_ptr(material.ks));
+        renderStats.uniformUpdates++;
+        glUniform1f(glGetUniformLocation(shaderID, "materialShininess"), material.shininess);
+        renderStats.uniformUpdates++;
+        
+        // Indicar se é material de placa/decal
+        int isDecal = (part.materialName == "Decals") ? 1 : 0;
+        glUniform1i(glGetUniformLocation(shaderID, "isDecalMaterial"), isDecal);
+        renderStats.uniformUpdates++;
+
+        // Aplicar textura específica desta parte
+        glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, 0); // Limpar qualquer textura anterior
         
-        if (part.material.textureID != 0) {
-            glBindTexture(GL_TEXTURE_2D, part.material.textureID);
+        if (material.textureID != 0) {
+            glBindTexture(GL_TEXTURE_2D, material.textureID);
+            renderStats.textureBinds++;
         } else {
             // Criar texturas específicas baseadas no material
             static std::map<std::string, GLuint> textureCache;
@@ -1284,17 +3590,21 @@ void drawModel(GLuint shaderID, const Model& model) {
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
                 
                 textureCache[part.materialName] = newTexture;
+                renderStats.textureBytes += 4;
                 
 
             }
             
             glBindTexture(GL_TEXTURE_2D, textureCache[part.materialName]);
+            renderStats.textureBinds++;
         }
 
         // Desenhar esta parte
         if (part.VAO != 0 && part.nVertices > 0) {
             glBindVertexArray(part.VAO);
             glDrawArrays(GL_TRIANGLES, 0, part.nVertices);
+            renderStats.drawCalls++;
+            renderStats.triangles += part.nVertices / 3;
             glBindVertexArray(0);
         }
         
@@ -1303,171 +3613,1144 @@ void drawModel(GLuint shaderID, const Model& model) {
     }
 }
 
-void updateCameraMatrix(GLuint shaderID) {
+mat4 updateCameraMatrix(GLuint shaderID) {
+    PROFILE_SCOPE("Camera update");
     // Criar e enviar a matriz de view atualizada
     mat4 view = lookAt(camera.position, camera.target, camera.up);
     glUniformMatrix4fv(glGetUniformLocation(shaderID, "view"), 1, GL_FALSE, value_ptr(view));
+    renderStats.uniformUpdates++;
+    return view;
 }
 
-void processCameraMovement(int key, float deltaTime) {
+void processCameraMovement(float deltaTime) {
     float velocity = camera.speed * deltaTime;
     
     // Calcular direcões da câmera
     vec3 forward = normalize(camera.target - camera.position);
     vec3 right = normalize(cross(forward, camera.up));
     
-    // Movimentos da câmera
-    if (key == GLFW_KEY_W) {
-        camera.position += forward * velocity;
-        camera.target += forward * velocity;
-        std::cout << "Câmera: frente" << std::endl;
+    // Movimentos da câmera (teclas mantidas pressionadas somam)
+    vec3 offset(0.0f);
+    if (input.keys[GLFW_KEY_W]) offset += forward;
+    if (input.keys[GLFW_KEY_S]) offset -= forward;
+    if (input.keys[GLFW_KEY_A]) offset -= right;
+    if (input.keys[GLFW_KEY_D]) offset += right;
+    if (input.keys[GLFW_KEY_Q]) offset -= camera.up;
+    if (input.keys[GLFW_KEY_E]) offset += camera.up;
+
+    camera.position += offset * velocity;
+    camera.target += offset * velocity;
+}
+
+// Arquivo inteiro em memoria somente leitura: mmap em POSIX, leitura num buffer no Windows
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#else
+    void* mapping = nullptr;
+#endif
+};
+
+bool mapFile(const std::string& path, MappedFile& file) {
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+    file.buffer.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(file.buffer.data(), file.buffer.size());
+    file.data = file.buffer.data();
+    file.size = file.buffer.size();
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
     }
-    if (key == GLFW_KEY_S) {
-        camera.position -= forward * velocity;
-        camera.target -= forward * velocity;
-        std::cout << "Câmera: tras" << std::endl;
+    file.size = (size_t)info.st_size;
+    if (file.size > 0) {
+        file.mapping = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (file.mapping == MAP_FAILED) {
+            file.mapping = nullptr;
+            ::close(fd);
+            return false;
+        }
+        madvise(file.mapping, file.size, MADV_SEQUENTIAL);
+        file.data = (const char*)file.mapping;
     }
-    if (key == GLFW_KEY_A) {
-        camera.position -= right * velocity;
-        camera.target -= right * velocity;
-        std::cout << "Câmera: esquerda" << std::endl;
+    ::close(fd);
+    return true;
+#endif
+}
+
+void unmapFile(MappedFile& file) {
+#ifdef _WIN32
+    std::vector<char>().swap(file.buffer);
+#else
+    if (file.mapping) munmap(file.mapping, file.size);
+    file.mapping = nullptr;
+#endif
+    file.data = nullptr;
+    file.size = 0;
+}
+
+// Leitor de linhas/tokens sobre o buffer mapeado. Tokens sao string_view para dentro do
+// arquivo (nenhuma alocacao); a coluna dos erros vem da posicao do token na linha.
+struct ConfigReader {
+    const char* path;
+    const char* next;          // Inicio da proxima linha
+    const char* end;
+    const char* lineStart;
+    const char* lineEnd;       // Sem \r\n
+    const char* cursor;        // Posicao do proximo token
+    int line = 0;
+    int errors = 0;
+};
+
+static bool configNextLine(ConfigReader& reader) {
+    if (reader.next >= reader.end) return false;
+    const char* start = reader.next;
+    const char* newline = (const char*)memchr(start, '\n', reader.end - start);
+    const char* stop = newline ? newline : reader.end;
+    reader.next = newline ? newline + 1 : reader.end;
+    if (stop > start && stop[-1] == '\r') stop--;
+    reader.lineStart = reader.cursor = start;
+    reader.lineEnd = stop;
+    reader.line++;
+    return true;
+}
+
+static void configError(ConfigReader& reader, const char* at, const char* message) {
+    int column = (int)(std::min(std::max(at, reader.lineStart), reader.lineEnd) - reader.lineStart) + 1;
+    LOG_ERROR(reader.path << ":" << reader.line << ":" << column << ": " << message);
+    reader.errors++;
+}
+
+// Proximo token da linha: sequencia sem espacos ou texto entre aspas. '#' no inicio de
+// um token comenta o resto da linha. Vazio = fim da linha.
+static std::string_view configToken(ConfigReader& reader) {
+    const char* p = reader.cursor;
+    while (p < reader.lineEnd && (*p == ' ' || *p == '\t')) p++;
+    if (p >= reader.lineEnd || *p == '#') {
+        reader.cursor = reader.lineEnd;
+        return std::string_view();
     }
-    if (key == GLFW_KEY_D) {
-        camera.position += right * velocity;
-        camera.target += right * velocity;
-        std::cout << "Câmera: direita" << std::endl;
+    if (*p == '"') {
+        const char* close = (const char*)memchr(p + 1, '"', reader.lineEnd - (p + 1));
+        if (!close) {
+            configError(reader, p, "aspas sem fechamento");
+            reader.cursor = reader.lineEnd;
+            return std::string_view();
+        }
+        reader.cursor = close + 1;
+        return std::string_view(p + 1, close - (p + 1));
     }
-    if (key == GLFW_KEY_Q) {
-        camera.position -= camera.up * velocity;
-        camera.target -= camera.up * velocity;
-        std::cout << "Câmera: descer" << std::endl;
+    const char* start = p;
+    while (p < reader.lineEnd && *p != ' ' && *p != '\t') p++;
+    reader.cursor = p;
+    return std::string_view(start, p - start);
+}
+
+// Resto da linha sem espacos nas pontas (caminhos de arquivo). Como em configToken, um #
+// no inicio ou depois de espaco (fora de aspas) comeca um comentario; "a#b.track" fica inteiro.
+static std::string_view configRest(ConfigReader& reader) {
+    const char* start = reader.cursor;
+    const char* stop = reader.lineEnd;
+    reader.cursor = reader.lineEnd;
+    while (start < stop && (*start == ' ' || *start == '\t')) start++;
+    if (start < stop && *start == '"') {
+        const char* close = (const char*)memchr(start + 1, '"', stop - (start + 1));
+        if (close) {
+            return std::string_view(start + 1, close - (start + 1));
+        }
     }
-    if (key == GLFW_KEY_E) {
-        camera.position += camera.up * velocity;
-        camera.target += camera.up * velocity;
-        std::cout << "Câmera: subir" << std::endl;
+    for (const char* p = start; p < stop; p++) {
+        if (*p == '#' && (p == start || p[-1] == ' ' || p[-1] == '\t')) {
+            stop = p;
+            break;
+        }
     }
+    while (stop > start && (stop[-1] == ' ' || stop[-1] == '\t')) stop--;
+    return std::string_view(start, stop - start);
 }
 
-bool loadSceneConfig(const std::string& filename, SceneConfig& config) {
-    
-    // Try different paths
-    std::vector<std::string> pathsToTry = {
-        filename,                           // Original path
-        "./" + filename,                    // Explicit current dir
-        ".\\" + filename,                   // Windows style
-        filename.substr(4),                 // Remove "src/" prefix
-        "GrauB2Config"                      // Just filename
-    };
-    
-    std::ifstream file;
-    bool fileOpened = false;
-    std::string workingPath;
-    
-    for (const auto& path : pathsToTry) {
-        file.open(path, std::ios::in);
-        if (file.is_open()) {
-            workingPath = path;
-            fileOpened = true;
-            break;
+// Decimal simples ([-]digitos[.digitos][e[-]digitos]) pelo caminho rapido de Clinger:
+// mantissa inteira exata em double e uma multiplicacao/divisao por potencia de 10 exata.
+// O resto (hex, inf, mantissas longas) cai no strtof.
+static bool parseFloatToken(std::string_view token, float& value) {
+    static const double POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char* p = token.data();
+    const char* tokenEnd = p + token.size();
+    bool negative = p < tokenEnd && (*p == '-' || *p == '+') && *p++ == '-';
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool anyDigit = false, exact = true;
+    for (; p < tokenEnd && *p >= '0' && *p <= '9'; p++, anyDigit = true) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa != 0;
+    }
+    if (p < tokenEnd && *p == '.') {
+        for (p++; p < tokenEnd && *p >= '0' && *p <= '9'; p++, anyDigit = true) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+            exponent--;
         }
-        file.clear(); // Clear error flags
     }
-    
-    if (!fileOpened) {
-        return false;
+    exact = digits <= 15;   // Mantissa representavel exatamente em double
+    if (anyDigit && p < tokenEnd && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exponentNegative = p < tokenEnd && (*p == '-' || *p == '+') && *p++ == '-';
+        int explicitExponent = 0;
+        bool exponentDigit = false;
+        for (; p < tokenEnd && *p >= '0' && *p <= '9' && explicitExponent < 10000; p++, exponentDigit = true) {
+            explicitExponent = explicitExponent * 10 + (*p - '0');
+        }
+        exact = exact && exponentDigit;
+        exponent += exponentNegative ? -explicitExponent : explicitExponent;
     }
-    
-    std::string line;
-    
-    ObjectAnimation pendingAnimation; // Animacao para o próximo objeto
-    bool hasAnimation = false;
-    
-    while (std::getline(file, line)) {
-        // Ignorar comentarios e linhas vazias
-        if (line.empty() || line[0] == '#') {
-            continue;
+    if (anyDigit && exact && p == tokenEnd && exponent >= -22 && exponent <= 22) {
+        double result = exponent < 0 ? (double)mantissa / POW10[-exponent] : (double)mantissa * POW10[exponent];
+        value = (float)(negative ? -result : result);
+        return true;
+    }
+
+    char buffer[64];
+    if (token.empty() || token.size() >= sizeof(buffer)) return false;
+    memcpy(buffer, token.data(), token.size());
+    buffer[token.size()] = '\0';
+    char* stop;
+    value = strtof(buffer, &stop);
+    return stop == buffer + token.size();
+}
+
+// Le count floats; erro aponta o token que faltou ou nao e numero
+static bool configFloats(ConfigReader& reader, float* values, int count) {
+    for (int i = 0; i < count; i++) {
+        std::string_view token = configToken(reader);
+        if (token.empty()) {
+            configError(reader, reader.cursor, "numero esperado");
+            return false;
         }
-        
-        std::istringstream iss(line);
-        std::string command;
-        iss >> command;
-        
-        if (command == "CAMERA") {
-            iss >> config.camera.position.x >> config.camera.position.y >> config.camera.position.z
-                >> config.camera.target.x >> config.camera.target.y >> config.camera.target.z
-                >> config.camera.fov;
-            std::cout << "Câmera configurada: pos(" << config.camera.position.x << "," << config.camera.position.y << "," << config.camera.position.z << ")" << std::endl;
+        if (!parseFloatToken(token, values[i])) {
+            configError(reader, token.data(), "numero invalido");
+            return false;
         }
-        else if (command == "LIGHT1" || command == "LIGHT2" || command == "LIGHT3") {
-            SceneConfig::LightConfig light;
-            iss >> light.position.x >> light.position.y >> light.position.z >> light.intensity;
-            config.lights.push_back(light);
-            std::cout << "Luz " << config.lights.size() << " configurada: pos(" << light.position.x << "," << light.position.y << "," << light.position.z << ") intensidade=" << light.intensity << std::endl;
+    }
+    return true;
+}
+
+// Floats opcionais no fim da linha: 0 se nao ha mais tokens, -1 em erro
+static int configOptionalFloats(ConfigReader& reader, float* values, int count) {
+    const char* saved = reader.cursor;
+    if (configToken(reader).empty()) return 0;
+    reader.cursor = saved;
+    return configFloats(reader, values, count) ? 1 : -1;
+}
+
+// Le x y z
+static bool configVec3(ConfigReader& reader, glm::vec3& value) {
+    float v[3];
+    if (!configFloats(reader, v, 3)) return false;
+    value = glm::vec3(v[0], v[1], v[2]);
+    return true;
+}
+
+static void configExpectEnd(ConfigReader& reader) {
+    std::string_view extra = configToken(reader);
+    if (!extra.empty()) {
+        configError(reader, extra.data(), "texto extra no fim da linha");
+    }
+}
+
+static bool parseAnimationDirective(ConfigReader& reader, ObjectAnimation& animation) {
+    std::string_view type = configToken(reader);
+    if (type == "bezier") {
+        float v[13];
+        if (!configFloats(reader, v, 13)) return false;
+        animation.type = ANIM_BEZIER;
+        animation.bezier.p0 = glm::vec3(v[0], v[1], v[2]);
+        animation.bezier.p1 = glm::vec3(v[3], v[4], v[5]);
+        animation.bezier.p2 = glm::vec3(v[6], v[7], v[8]);
+        animation.bezier.p3 = glm::vec3(v[9], v[10], v[11]);
+        animation.bezier.duration = v[12];
+        animation.bezier.loop = true; // Padrao: loop ativo
+        LOG_DEBUG("Animacao Bézier configurada: duracao=" << animation.bezier.duration << "s");
+    } else if (type == "track") {
+        animation.type = ANIM_BEZIER_TRACK;
+        animation.trackFromMesh = true;   // Resolvida depois de carregar os modelos (resolveMeshTracks)
+        animation.bezierTrack = nullptr;
+        LOG_DEBUG("Animacao de pista configurada: linha extraida da malha Asphalt");
+    } else if (type == "orbit") {
+        float v[5];
+        if (!configFloats(reader, v, 5)) return false;
+        animation.type = ANIM_ORBIT;
+        animation.orbit.center = glm::vec3(v[0], v[1], v[2]);
+        animation.orbit.radius = v[3];
+        animation.orbit.speed = v[4];
+        animation.orbit.axis = glm::vec3(0.0f, 1.0f, 0.0f); // Eixo Y padrao
+        LOG_DEBUG("Animacao orbital configurada: raio=" << animation.orbit.radius << " velocidade=" << animation.orbit.speed << "°/s");
+    } else {
+        configError(reader, type.empty() ? reader.cursor : type.data(), "tipo de animacao desconhecido (bezier, track, orbit)");
+        return false;
+    }
+    configExpectEnd(reader);
+    return true;
+}
+
+// OBJECT arquivo x y z rx ry rz sx sy sz [material]. O arquivo pode estar entre aspas ou
+// conter espacos sem aspas: nesse caso os 9 numeros (e o material) sao os ultimos tokens.
+static bool parseObjectDirective(ConfigReader& reader, SceneConfig::ObjectConfig& obj) {
+    const int MAX_TOKENS = 64;
+    std::string_view tokens[MAX_TOKENS];
+    int count = 0;
+    bool quoted = false;
+    int errorsBefore = reader.errors;
+    for (;;) {
+        const char* before = reader.cursor;
+        while (before < reader.lineEnd && (*before == ' ' || *before == '\t')) before++;
+        std::string_view token = configToken(reader);
+        if (token.empty() && (before >= reader.lineEnd || *before == '#')) break;
+        if (count == MAX_TOKENS) {
+            configError(reader, token.data(), "OBJECT com tokens demais");
+            return false;
         }
-        else if (command == "ANIMATION") {
-            // Parsear animacao para aplicar ao proximo objeto
-            if (parseAnimationConfig(line, pendingAnimation)) {
-                hasAnimation = true;
-            }
+        if (count == 0) quoted = before < reader.lineEnd && *before == '"';
+        tokens[count++] = token;
+    }
+    if (reader.errors != errorsBefore) {
+        return false;   // Aspas sem fechamento (ja reportado)
+    }
+
+    float scratch;
+    int paramStart;
+    if (quoted) {
+        paramStart = 1;
+    } else {
+        // Material presente se o ultimo token nao e numero
+        bool hasMaterial = count > 0 && !parseFloatToken(tokens[count - 1], scratch);
+        paramStart = count - 9 - (hasMaterial ? 1 : 0);
+    }
+    if (count == 0 || paramStart < 1 || count - paramStart < 9) {
+        configError(reader, reader.lineStart, "OBJECT espera: arquivo x y z rx ry rz sx sy sz [material]");
+        return false;
+    }
+
+    float v[9];
+    for (int i = 0; i < 9; i++) {
+        if (!parseFloatToken(tokens[paramStart + i], v[i])) {
+            configError(reader, tokens[paramStart + i].data(), "numero invalido");
+            return false;
         }
-        else if (command == "OBJECT") {
-            SceneConfig::ObjectConfig obj;
-            
-            // Parse manual para lidar com nomes de arquivo com espaços
-            std::string remainingLine;
-            std::getline(iss, remainingLine);
-            
-            // Encontrar onde começam os parâmetros numéricos (posição x y z)
-            // Procurar por padrão: espaço + número + espaço + número + espaço + número
-            std::regex paramPattern(R"(\s+(-?\d+(?:\.\d+)?)\s+(-?\d+(?:\.\d+)?)\s+(-?\d+(?:\.\d+)?))");
-            std::smatch match;
-            
-            if (std::regex_search(remainingLine, match, paramPattern)) {
-                // Extrair filename (tudo antes dos parâmetros)
-                size_t paramStart = match.position();
-                obj.filename = remainingLine.substr(0, paramStart);
-                
-                // Remover espaços do final do filename
-                obj.filename.erase(obj.filename.find_last_not_of(" \t") + 1);
-                // Remover espaço do início se houver
-                if (!obj.filename.empty() && obj.filename[0] == ' ') {
-                    obj.filename = obj.filename.substr(1);
-                }
-                
-                // Parse do resto da linha (números)
-                std::string numbers = remainingLine.substr(paramStart);
-                std::istringstream numberStream(numbers);
-                numberStream >> obj.position.x >> obj.position.y >> obj.position.z
-                            >> obj.rotation.x >> obj.rotation.y >> obj.rotation.z
-                            >> obj.scale.x >> obj.scale.y >> obj.scale.z >> obj.materialType;
+    }
+    if (count - paramStart > 10) {
+        configError(reader, tokens[paramStart + 10].data(), "texto extra no fim da linha");
+    }
+
+    // Nome sem aspas: do inicio do primeiro token ao fim do ultimo antes dos numeros
+    // (preserva os espacos internos do caminho)
+    const char* nameEnd = tokens[paramStart - 1].data() + tokens[paramStart - 1].size();
+    obj.filename.assign(tokens[0].data(), quoted ? tokens[0].size() : nameEnd - tokens[0].data());
+    obj.position = glm::vec3(v[0], v[1], v[2]);
+    obj.rotation = glm::vec3(v[3], v[4], v[5]);
+    obj.scale = glm::vec3(v[6], v[7], v[8]);
+    if (count - paramStart >= 10) {
+        obj.materialType.assign(tokens[paramStart + 9].data(), tokens[paramStart + 9].size());
+    }
+    return true;
+}
+
+// Cena binaria (--export-scene): cabecalho, secoes de registros de tamanho fixo e uma
+// tabela de strings (caminhos de assets, materiais) com cada texto uma vez, terminado em
+// '\0'. Little-endian, todos os campos de 4 bytes. O carregador mapeia o arquivo e le os
+// registros direto do mapeamento; so os caminhos sao resolvidos (OBJ, pistas, keyframes).
+const char BINARY_SCENE_MAGIC[4] = { 'G', 'B', '2', 'S' };
+const uint32_t BINARY_SCENE_VERSION = 1;
+const uint32_t BINARY_SCENE_NO_STRING = 0xFFFFFFFFu;
+
+enum BinarySceneSection {
+    SCENE_OBJECTS, SCENE_ANIMATIONS, SCENE_LIGHTS, SCENE_PART_NODES, SCENE_CAMERA_CURVES, SCENE_SECTION_COUNT
+};
+
+struct BinarySceneHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sectionOffset[SCENE_SECTION_COUNT];  // Bytes desde o inicio do arquivo
+    uint32_t sectionCount[SCENE_SECTION_COUNT];   // Registros em cada secao
+    uint32_t stringOffset;
+    uint32_t stringSize;
+    float camera[7];                               // Posicao, alvo, fov
+};
+
+struct BinaryObjectRecord {
+    float position[3];
+    float rotation[3];
+    float scale[3];
+    uint32_t asset;           // Caminho do OBJ na tabela de strings
+    uint32_t material;        // Material do fallback sem MTL (BINARY_SCENE_NO_STRING = nenhum)
+    int32_t animation;        // Indice em SCENE_ANIMATIONS (-1 = sem animacao)
+    int32_t parent;           // Indice do objeto pai (-1 = raiz)
+    uint32_t firstPartNode;   // Faixa em SCENE_PART_NODES
+    uint32_t partNodeCount;
+    float timeOffset;         // PHASE da animacao (0 nos arquivos sem o campo)
+};
+
+struct BinaryAnimationRecord {
+    uint32_t type;            // AnimationType
+    uint32_t flags;           // 1 = pista extraida da malha, 2 = loop (Bézier)
+    uint32_t path;            // Arquivo do TRACK ou KEYFRAMES
+    float params[13];         // Bézier: p0..p3 + duracao; orbita: centro, raio, velocidade, eixo
+};
+
+struct BinaryLightRecord {
+    float position[3];
+    float intensity;
+    float radius;
+    float color[3];
+    float weight;
+};
+
+struct BinaryPartNodeRecord {
+    uint32_t part;            // Material da parte
+    float axis[3];
+    float speed;
+    float pivot[3];
+    uint32_t autoPivot;
+};
+
+struct BinaryCurveRecord {
+    float points[12];
+    float duration;
+};
+
+static_assert(sizeof(BinaryObjectRecord) == 64, "registro de objeto deve ter 64 bytes");
+static_assert(sizeof(BinaryAnimationRecord) == 64, "registro de animacao deve ter 64 bytes");
+
+// Monta a tabela de strings sem repeticao
+struct BinaryStringTable {
+    std::string data;
+    std::map<std::string, uint32_t> offsets;
+};
+
+static uint32_t binaryString(BinaryStringTable& table, const std::string& text) {
+    auto found = table.offsets.find(text);
+    if (found != table.offsets.end()) return found->second;
+    uint32_t offset = (uint32_t)table.data.size();
+    table.data.append(text);
+    table.data.push_back('\0');
+    table.offsets[text] = offset;
+    return offset;
+}
+
+// Caminho com que uma pista/trilha compartilhada foi carregada (chave no cache)
+template <typename Cache, typename Pointer>
+static const std::string* cachedPath(const Cache& cache, const Pointer& pointer) {
+    std::lock_guard<std::mutex> lock(animationCacheMutex);
+    for (const auto& entry : cache) {
+        if (entry.second == pointer) return &entry.first;
+    }
+    return nullptr;
+}
+
+static void copyVec3(float* out, const glm::vec3& value) {
+    out[0] = value.x;
+    out[1] = value.y;
+    out[2] = value.z;
+}
+
+bool writeBinaryScene(const std::string& path, const SceneConfig& config) {
+    BinaryStringTable strings;
+    std::vector<BinaryObjectRecord> objects;
+    std::vector<BinaryAnimationRecord> animations;
+    std::vector<BinaryLightRecord> lights;
+    std::vector<BinaryPartNodeRecord> partNodes;
+    std::vector<BinaryCurveRecord> curves;
+    std::map<std::string, int32_t> animationIndex;   // Registros iguais sao compartilhados
+
+    objects.reserve(config.objects.size());
+    for (const SceneConfig::ObjectConfig& obj : config.objects) {
+        BinaryObjectRecord record = {};
+        copyVec3(record.position, obj.position);
+        copyVec3(record.rotation, obj.rotation);
+        copyVec3(record.scale, obj.scale);
+        record.asset = binaryString(strings, obj.filename);
+        record.material = obj.materialType.empty() ? BINARY_SCENE_NO_STRING : binaryString(strings, obj.materialType);
+        record.parent = obj.parent;
+        record.animation = -1;
+        record.timeOffset = obj.animation.type != ANIM_NONE ? obj.animation.timeOffset : 0.0f;
+
+        const ObjectAnimation& anim = obj.animation;
+        if (anim.type != ANIM_NONE) {
+            BinaryAnimationRecord animation = {};
+            animation.type = (uint32_t)anim.type;
+            animation.path = BINARY_SCENE_NO_STRING;
+            if (anim.type == ANIM_BEZIER) {
+                const glm::vec3 points[4] = { anim.bezier.p0, anim.bezier.p1, anim.bezier.p2, anim.bezier.p3 };
+                for (int k = 0; k < 4; k++) copyVec3(&animation.params[3 * k], points[k]);
+                animation.params[12] = anim.bezier.duration;
+                animation.flags |= anim.bezier.loop ? 2u : 0u;
+            } else if (anim.type == ANIM_ORBIT) {
+                copyVec3(animation.params, anim.orbit.center);
+                animation.params[3] = anim.orbit.radius;
+                animation.params[4] = anim.orbit.speed;
+                copyVec3(&animation.params[5], anim.orbit.axis);
+            } else if (anim.type == ANIM_BEZIER_TRACK && anim.trackFromMesh) {
+                animation.flags |= 1u;
             } else {
-                // Fallback: tentar split por último espaço antes de números
-                std::vector<std::string> tokens;
-                std::istringstream tokenStream(remainingLine);
-                std::string token;
-                while (tokenStream >> token) {
-                    tokens.push_back(token);
+                const std::string* source = anim.type == ANIM_BEZIER_TRACK ? cachedPath(trackCache, anim.bezierTrack)
+                                                                           : cachedPath(keyframeCache, anim.keyframes);
+                if (source == nullptr) {
+                    LOG_WARN("Animacao sem arquivo de origem em " << obj.filename << ", objeto exportado sem animacao");
+                    animation.type = ANIM_NONE;
+                } else {
+                    animation.path = binaryString(strings, *source);
                 }
-                
-                // Assumir que os últimos 10 tokens são os parâmetros numéricos + material
-                if (tokens.size() >= 10) {
-                    // Reconstruir filename dos primeiros tokens
-                    obj.filename = "";
-                    for (size_t i = 0; i < tokens.size() - 10; i++) {
-                        if (i > 0) obj.filename += " ";
-                        obj.filename += tokens[i];
-                    }
-                    
-                    // Parse dos últimos 10 tokens
-                    size_t paramStart = tokens.size() - 10;
-                    obj.position.x = std::stof(tokens[paramStart]);
-                    obj.position.y = std::stof(tokens[paramStart + 1]);
-                    obj.position.z = std::stof(tokens[paramStart + 2]);
-                    obj.rotation.x = std::stof(tokens[paramStart + 3]);
-                    obj.rotation.y = std::stof(tokens[paramStart + 4]);
-                    obj.rotation.z = std::stof(tokens[paramStart + 5]);
-                    obj.scale.x = std::stof(tokens[paramStart + 6]);
+            }
+            if (animation.type != ANIM_NONE) {
+                std::string key((const char*)&animation, sizeof(animation));
+                auto found = animationIndex.find(key);
+                if (found == animationIndex.end()) {
+                    found = animationIndex.emplace(key, (int32_t)animations.size()).first;
+                    animations.push_back(animation);
+                }
+                record.animation = found->second;
+            }
+        }
+
+        record.firstPartNode = (uint32_t)partNodes.size();
+        record.partNodeCount = (uint32_t)obj.partNodes.size();
+        for (const PartNodeConfig& partNode : obj.partNodes) {
+            BinaryPartNodeRecord node = {};
+            node.part = binaryString(strings, partNode.part);
+            copyVec3(node.axis, partNode.axis);
+            node.speed = partNode.speed;
+            copyVec3(node.pivot, partNode.pivot);
+            node.autoPivot = partNode.autoPivot ? 1u : 0u;
+            partNodes.push_back(node);
+        }
+        objects.push_back(record);
+    }
+
+    for (const SceneConfig::LightConfig& light : config.lights) {
+        BinaryLightRecord record;
+        copyVec3(record.position, light.position);
+        record.intensity = light.intensity;
+        record.radius = light.radius;
+        copyVec3(record.color, light.color);
+        record.weight = light.weight;
+        lights.push_back(record);
+    }
+    for (const BezierCurve& curve : config.cameraPath.curves) {
+        BinaryCurveRecord record;
+        const glm::vec3 points[4] = { curve.p0, curve.p1, curve.p2, curve.p3 };
+        for (int k = 0; k < 4; k++) copyVec3(&record.points[3 * k], points[k]);
+        record.duration = curve.duration;
+        curves.push_back(record);
+    }
+
+    BinarySceneHeader header = {};
+    memcpy(header.magic, BINARY_SCENE_MAGIC, 4);
+    header.version = BINARY_SCENE_VERSION;
+    copyVec3(header.camera, config.camera.position);
+    copyVec3(header.camera + 3, config.camera.target);
+    header.camera[6] = config.camera.fov;
+
+    const void* sectionData[SCENE_SECTION_COUNT] = { objects.data(), animations.data(), lights.data(),
+                                                     partNodes.data(), curves.data() };
+    size_t sectionBytes[SCENE_SECTION_COUNT] = {
+        objects.size() * sizeof(BinaryObjectRecord), animations.size() * sizeof(BinaryAnimationRecord),
+        lights.size() * sizeof(BinaryLightRecord), partNodes.size() * sizeof(BinaryPartNodeRecord),
+        curves.size() * sizeof(BinaryCurveRecord) };
+    uint32_t sectionCount[SCENE_SECTION_COUNT] = { (uint32_t)objects.size(), (uint32_t)animations.size(),
+                                                   (uint32_t)lights.size(), (uint32_t)partNodes.size(),
+                                                   (uint32_t)curves.size() };
+    size_t offset = sizeof(BinarySceneHeader);
+    for (int section = 0; section < SCENE_SECTION_COUNT; section++) {
+        header.sectionOffset[section] = (uint32_t)offset;
+        header.sectionCount[section] = sectionCount[section];
+        offset += sectionBytes[section];
+    }
+    header.stringOffset = (uint32_t)offset;
+    header.stringSize = (uint32_t)strings.data.size();
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (out == NULL) {
+        LOG_ERROR("Nao foi possivel criar " << path);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (int section = 0; section < SCENE_SECTION_COUNT && ok; section++) {
+        ok = sectionBytes[section] == 0 || fwrite(sectionData[section], sectionBytes[section], 1, out) == 1;
+    }
+    ok = ok && (strings.data.empty() || fwrite(strings.data.data(), strings.data.size(), 1, out) == 1);
+    ok = (fclose(out) == 0) && ok;
+    LOG_INFO("Cena binaria: " << objects.size() << " objetos, " << animations.size() << " animacoes, "
+             << lights.size() << " luzes, " << strings.offsets.size() << " strings (" << offset + strings.data.size() << " bytes)");
+    return ok;
+}
+
+// Registros de uma secao direto do mapeamento (nullptr se a secao sai do arquivo)
+template <typename Record>
+static const Record* binarySection(const MappedFile& file, const BinarySceneHeader& header, BinarySceneSection section) {
+    uint64_t begin = header.sectionOffset[section];
+    uint64_t bytes = (uint64_t)header.sectionCount[section] * sizeof(Record);
+    if (begin % alignof(Record) != 0 || begin + bytes > file.size) return nullptr;
+    return (const Record*)(file.data + begin);
+}
+
+// Texto da tabela de strings; nullptr se o deslocamento e invalido ou falta o '\0'
+static const char* binaryStringAt(const MappedFile& file, const BinarySceneHeader& header, uint32_t offset) {
+    if (offset >= header.stringSize) return nullptr;
+    const char* text = file.data + header.stringOffset + offset;
+    return memchr(text, '\0', header.stringSize - offset) ? text : nullptr;
+}
+
+static glm::vec3 loadVec3(const float* values) {
+    return glm::vec3(values[0], values[1], values[2]);
+}
+
+bool loadBinaryScene(const MappedFile& file, const std::string& path, SceneConfig& config) {
+    PROFILE_SCOPE("Binary scene load");
+    if (file.size < sizeof(BinarySceneHeader)) {
+        LOG_ERROR(path << ": cena binaria truncada");
+        return false;
+    }
+    BinarySceneHeader header;
+    memcpy(&header, file.data, sizeof(header));
+    if (header.version != BINARY_SCENE_VERSION) {
+        LOG_ERROR(path << ": versao de cena binaria " << header.version << " nao suportada");
+        return false;
+    }
+    const BinaryObjectRecord* objects = binarySection<BinaryObjectRecord>(file, header, SCENE_OBJECTS);
+    const BinaryAnimationRecord* animations = binarySection<BinaryAnimationRecord>(file, header, SCENE_ANIMATIONS);
+    const BinaryLightRecord* lights = binarySection<BinaryLightRecord>(file, header, SCENE_LIGHTS);
+    const BinaryPartNodeRecord* partNodes = binarySection<BinaryPartNodeRecord>(file, header, SCENE_PART_NODES);
+    const BinaryCurveRecord* curves = binarySection<BinaryCurveRecord>(file, header, SCENE_CAMERA_CURVES);
+    if (!objects || !animations || !lights || !partNodes || !curves ||
+        (uint64_t)header.stringOffset + header.stringSize > file.size) {
+        LOG_ERROR(path << ": secao fora do arquivo");
+        return false;
+    }
+
+    config.camera.position = loadVec3(header.camera);
+    config.camera.target = loadVec3(header.camera + 3);
+    config.camera.fov = header.camera[6];
+
+    for (uint32_t i = 0; i < header.sectionCount[SCENE_LIGHTS]; i++) {
+        const BinaryLightRecord& record = lights[i];
+        SceneConfig::LightConfig light;
+        light.position = loadVec3(record.position);
+        light.intensity = record.intensity;
+        light.radius = record.radius;
+        light.color = loadVec3(record.color);
+        light.weight = record.weight;
+        config.lights.push_back(light);
+    }
+    for (uint32_t i = 0; i < header.sectionCount[SCENE_CAMERA_CURVES]; i++) {
+        BezierCurve curve;
+        curve.p0 = loadVec3(curves[i].points);
+        curve.p1 = loadVec3(curves[i].points + 3);
+        curve.p2 = loadVec3(curves[i].points + 6);
+        curve.p3 = loadVec3(curves[i].points + 9);
+        curve.duration = curves[i].duration;
+        curve.loop = false;
+        config.cameraPath.curves.push_back(curve);
+        config.cameraPath.totalDuration += curve.duration;
+        config.cameraPath.loop = true;
+    }
+
+    // Animacoes compartilhadas: montadas (e pistas/keyframes resolvidos) uma vez cada
+    std::vector<ObjectAnimation> sharedAnimations(header.sectionCount[SCENE_ANIMATIONS]);
+    for (size_t i = 0; i < sharedAnimations.size(); i++) {
+        const BinaryAnimationRecord& record = animations[i];
+        ObjectAnimation& anim = sharedAnimations[i];
+        anim.type = (AnimationType)record.type;
+        if (anim.type == ANIM_BEZIER) {
+            anim.bezier = { loadVec3(record.params), loadVec3(record.params + 3), loadVec3(record.params + 6),
+                            loadVec3(record.params + 9), record.params[12], (record.flags & 2u) != 0 };
+        } else if (anim.type == ANIM_ORBIT) {
+            anim.orbit.center = loadVec3(record.params);
+            anim.orbit.radius = record.params[3];
+            anim.orbit.speed = record.params[4];
+            anim.orbit.axis = loadVec3(record.params + 5);
+        } else if (anim.type == ANIM_BEZIER_TRACK && (record.flags & 1u)) {
+            anim.trackFromMesh = true;
+        } else if (anim.type == ANIM_BEZIER_TRACK || anim.type == ANIM_LINEAR) {
+            const char* source = binaryStringAt(file, header, record.path);
+            if (source && anim.type == ANIM_BEZIER_TRACK) anim.bezierTrack = loadTrack(source);
+            if (source && anim.type == ANIM_LINEAR) anim.keyframes = loadKeyframeTrack(source);
+            if (!anim.bezierTrack && !anim.keyframes) anim.type = ANIM_NONE;
+        } else {
+            anim.type = ANIM_NONE;
+        }
+    }
+
+    // Objetos validados registro a registro; so os validos entram na configuracao.
+    // objectSlot: registro -> indice em config.objects (-1 = ignorado), para o PARENT
+    uint32_t objectCount = header.sectionCount[SCENE_OBJECTS];
+    config.objects.reserve(config.objects.size() + objectCount);
+    std::vector<int> objectSlot(objectCount, -1);
+    uint32_t invalid = 0;
+    for (uint32_t i = 0; i < objectCount; i++) {
+        const BinaryObjectRecord& record = objects[i];
+        const char* asset = binaryStringAt(file, header, record.asset);
+        const char* material = record.material == BINARY_SCENE_NO_STRING ? "" : binaryStringAt(file, header, record.material);
+        if (!asset || !material || record.animation >= (int32_t)sharedAnimations.size() ||
+            record.parent >= (int32_t)i ||
+            (uint64_t)record.firstPartNode + record.partNodeCount > header.sectionCount[SCENE_PART_NODES]) {
+            invalid++;
+            continue;
+        }
+        SceneConfig::ObjectConfig obj;
+        obj.filename = asset;
+        obj.materialType = material;
+        obj.position = loadVec3(record.position);
+        obj.rotation = loadVec3(record.rotation);
+        obj.scale = loadVec3(record.scale);
+        obj.parent = record.parent >= 0 ? objectSlot[record.parent] : -1;   // Pai ignorado: vira raiz
+        if (record.animation >= 0) {
+            obj.animation = sharedAnimations[record.animation];
+            obj.animation.originalPosition = obj.position;
+            obj.animation.timeOffset = std::isfinite(record.timeOffset) ? record.timeOffset : 0.0f;
+        }
+        for (uint32_t k = 0; k < record.partNodeCount; k++) {
+            const BinaryPartNodeRecord& node = partNodes[record.firstPartNode + k];
+            const char* part = binaryStringAt(file, header, node.part);
+            if (!part) continue;
+            PartNodeConfig partNode;
+            partNode.part = part;
+            partNode.axis = loadVec3(node.axis);
+            partNode.speed = node.speed;
+            partNode.pivot = loadVec3(node.pivot);
+            partNode.autoPivot = node.autoPivot != 0;
+            obj.partNodes.push_back(partNode);
+        }
+        objectSlot[i] = (int)config.objects.size();
+        config.objects.push_back(std::move(obj));
+    }
+    if (invalid > 0) {
+        LOG_WARN(path << ": " << invalid << " objeto(s) com referencias invalidas ignorados");
+    }
+    LOG_INFO("Cena binaria " << path << ": " << objectCount - invalid << " objetos, " << sharedAnimations.size()
+             << " animacoes, " << header.sectionCount[SCENE_LIGHTS] << " luzes");
+    return true;
+}
+
+// Primeiro caminho existente para o arquivo de configuracao (execucao a partir da raiz,
+// de build/ ou de src/); vazio se nenhum existe
+std::string findSceneConfigPath(const std::string& filename) {
+    std::string pathsToTry[] = {
+        filename,
+        "./" + filename,
+        filename.size() > 4 ? filename.substr(4) : filename,   // Remove "src/"
+        "GrauB2Config"
+    };
+    struct stat info;
+    for (const std::string& path : pathsToTry) {
+        if (stat(path.c_str(), &info) == 0) {
+            return path;
+        }
+    }
+    return "";
+}
+
+// Parser da configuracao de cena: uma passada sobre o arquivo mapeado, tokens sem copia
+// e erros com linha:coluna. Linhas com erro sao ignoradas e o resto do arquivo carrega.
+// Arquivos que comecam com BINARY_SCENE_MAGIC sao cenas binarias (writeBinaryScene).
+bool loadSceneConfig(const std::string& filename, SceneConfig& config) {
+    PROFILE_SCOPE("Config parse");
+
+    MappedFile file;
+    std::string workingPath = findSceneConfigPath(filename);
+    if (workingPath.empty() || !mapFile(workingPath, file)) {
+        return false;
+    }
+    if (file.size >= 4 && memcmp(file.data, BINARY_SCENE_MAGIC, 4) == 0) {
+        bool loaded = loadBinaryScene(file, workingPath, config);
+        unmapFile(file);
+        return loaded;
+    }
+
+    ConfigReader reader;
+    reader.path = workingPath.c_str();
+    reader.next = file.data;
+    reader.end = file.data + file.size;
+
+    // Reserva os objetos de uma vez: contar linhas "OBJECT" custa so um memchr por linha
+    size_t objectLines = 0;
+    for (const char* p = file.data; p && p < reader.end; ) {
+        objectLines += (size_t)(reader.end - p) > 6 && memcmp(p, "OBJECT", 6) == 0;
+        p = (const char*)memchr(p, '\n', reader.end - p);
+        if (p) p++;
+    }
+    config.objects.reserve(config.objects.size() + objectLines);
+
+    ObjectAnimation pendingAnimation; // Animacao para o próximo objeto
+    bool hasAnimation = false;
+    int pendingParent = -1;           // PARENT para o próximo objeto
+    float pendingPhase = 0.0f;        // PHASE para a animacao do próximo objeto
+    std::vector<PartNodeConfig> pendingPartNodes;
+
+    while (configNextLine(reader)) {
+        std::string_view command = configToken(reader);
+        if (command.empty()) {
+            continue;   // Linha vazia ou comentario
+        }
+
+        if (command == "OBJECT") {
+            SceneConfig::ObjectConfig obj;
+            if (!parseObjectDirective(reader, obj)) {
+                continue;
+            }
+            // Aplicar animacao pendente se houver
+            if (hasAnimation) {
+                obj.animation = pendingAnimation;
+                obj.animation.originalPosition = obj.position;
+                obj.animation.timeOffset = pendingPhase;
+                hasAnimation = false;
+            } else {
+                obj.animation.type = ANIM_NONE;
+            }
+            obj.parent = pendingParent;
+            obj.partNodes.swap(pendingPartNodes);
+            pendingParent = -1;
+            pendingPhase = 0.0f;
+            pendingPartNodes.clear();
+            config.objects.push_back(std::move(obj));
+        }
+        else if (command == "CAMERA") {
+            float fov;
+            if (!configVec3(reader, config.camera.position) || !configVec3(reader, config.camera.target)) continue;
+            if (configOptionalFloats(reader, &fov, 1) > 0) config.camera.fov = fov;
+            configExpectEnd(reader);
+            LOG_INFO("Câmera configurada: pos(" << config.camera.position.x << "," << config.camera.position.y << "," << config.camera.position.z << ")");
+        }
+        else if (command == "LIGHT1" || command == "LIGHT2" || command == "LIGHT3") {
+            SceneConfig::LightConfig light;
+            if (!configVec3(reader, light.position) || !configFloats(reader, &light.intensity, 1)) continue;
+            // Pesos fixos de cada papel: principal, preenchimento e fundo
+            light.weight = (command == "LIGHT1") ? 1.0f : (command == "LIGHT2") ? 0.4f : 0.65f;
+            configExpectEnd(reader);
+            config.lights.push_back(light);
+            LOG_INFO("Luz " << config.lights.size() << " configurada: pos(" << light.position.x << "," << light.position.y << "," << light.position.z << ") intensidade=" << light.intensity);
+        }
+        else if (command == "LIGHT") {
+            // LIGHT x y z intensidade [raio] [r g b] - quantidade arbitraria de luzes
+            SceneConfig::LightConfig light;
+            float v[3];
+            if (!configVec3(reader, light.position) || !configFloats(reader, &light.intensity, 1)) continue;
+            int hasRadius = configOptionalFloats(reader, &light.radius, 1);
+            int hasColor = hasRadius > 0 ? configOptionalFloats(reader, v, 3) : 0;
+            if (hasRadius < 0 || hasColor < 0) continue;
+            if (hasColor > 0) light.color = glm::vec3(v[0], v[1], v[2]);
+            configExpectEnd(reader);
+            light.weight = light.intensity;
+            config.lights.push_back(light);
+            LOG_DEBUG("Luz " << config.lights.size() << " configurada: pos(" << light.position.x << "," << light.position.y << "," << light.position.z << ") intensidade=" << light.intensity);
+        }
+        else if (command == "CAMERA_PATH") {
+            // CAMERA_PATH p0 p1 p2 p3 duracao - cada linha adiciona uma curva ao caminho do benchmark
+            float v[13];
+            if (!configFloats(reader, v, 13)) continue;
+            BezierCurve curve;
+            curve.p0 = glm::vec3(v[0], v[1], v[2]);
+            curve.p1 = glm::vec3(v[3], v[4], v[5]);
+            curve.p2 = glm::vec3(v[6], v[7], v[8]);
+            curve.p3 = glm::vec3(v[9], v[10], v[11]);
+            curve.duration = v[12];
+            curve.loop = false;
+            configExpectEnd(reader);
+            config.cameraPath.curves.push_back(curve);
+            config.cameraPath.totalDuration += curve.duration;
+            config.cameraPath.loop = true;
+        }
+        else if (command == "ANIMATION") {
+            // Animacao para aplicar ao proximo objeto
+            if (parseAnimationDirective(reader, pendingAnimation)) {
+                hasAnimation = true;
+            }
+        }
+        else if (command == "TRACK" || command == "KEYFRAMES") {
+            // TRACK arquivo / KEYFRAMES arquivo - o proximo objeto segue a pista ou reproduz a
+            // trilha de keyframes do arquivo (compartilhadas entre objetos)
+            std::string_view rest = configRest(reader);
+            if (rest.empty()) {
+                configError(reader, reader.lineEnd, "arquivo esperado");
+                continue;
+            }
+            std::string path(rest);
+            ObjectAnimation animation;
+            if (command == "TRACK") {
+                animation.type = ANIM_BEZIER_TRACK;
+                animation.bezierTrack = loadTrack(path);
+            } else {
+                animation.type = ANIM_LINEAR;
+                animation.keyframes = loadKeyframeTrack(path);
+            }
+            if (animation.bezierTrack || animation.keyframes) {
+                pendingAnimation = animation;
+                hasAnimation = true;
+            }
+        }
+        else if (command == "PARENT") {
+            // PARENT indice - o proximo objeto fica preso ao objeto indice (0 = primeiro OBJECT);
+            // posicao, rotacao e escala dele passam a ser relativas ao pai
+            std::string_view token = configToken(reader);
+            float index;
+            if (!parseFloatToken(token, index) || index != floorf(index) || index < 0.0f ||
+                index >= (float)config.objects.size()) {
+                configError(reader, token.empty() ? reader.cursor : token.data(),
+                            "PARENT precisa do indice de um OBJECT anterior");
+                continue;
+            }
+            pendingParent = (int)index;
+            configExpectEnd(reader);
+        }
+        else if (command == "PHASE") {
+            // PHASE segundos - a animacao do proximo objeto comeca adiantada (ex.: varios
+            // objetos na mesma pista espalhados ao longo dela)
+            float phase;
+            if (!configFloats(reader, &phase, 1)) continue;
+            configExpectEnd(reader);
+            pendingPhase = phase;
+        }
+        else if (command == "PART") {
+            // PART material eixoX eixoY eixoZ grausPorSegundo [pivoX pivoY pivoZ] - a parte do
+            // proximo objeto vira um no filho do modelo e gira em torno do pivo (padrao: centro)
+            PartNodeConfig partNode;
+            std::string_view part = configToken(reader);
+            float v[4];
+            if (part.empty()) {
+                configError(reader, reader.cursor, "material da parte esperado");
+                continue;
+            }
+            if (!configFloats(reader, v, 4)) continue;
+            partNode.part.assign(part.data(), part.size());
+            partNode.axis = glm::vec3(v[0], v[1], v[2]);
+            partNode.speed = v[3];
+            if (length(partNode.axis) <= 0.0f) {
+                configError(reader, part.data(), "eixo nulo");
+                continue;
+            }
+            partNode.axis = normalize(partNode.axis);
+            int hasPivot = configOptionalFloats(reader, v, 3);
+            if (hasPivot < 0) continue;
+            partNode.autoPivot = hasPivot == 0;
+            if (hasPivot > 0) partNode.pivot = glm::vec3(v[0], v[1], v[2]);
+            configExpectEnd(reader);
+            pendingPartNodes.push_back(partNode);
+        }
+        else {
+            configError(reader, command.data(), "diretiva desconhecida");
+        }
+    }
+
+    unmapFile(file);
+    if (reader.errors > 0) {
+        LOG_WARN(workingPath << ": " << reader.errors << " erro(s), linhas ignoradas");
+    }
+    return true;
+}
+
+// Loaders antigos e os microbenchmarks que comparam com eles: so no GrauB2Bench
+#ifdef GRAUB2_BENCH
+// Parser antigo (istringstream + regex por OBJECT). Nao e mais usado para carregar a
+// cena: fica como referencia de resultado e de tempo no microbenchmark "config".
+bool loadSceneConfigLegacy(const std::string& filename, SceneConfig& config) {
+    // Try different paths
+    std::vector<std::string> pathsToTry = {
+        filename,                           // Original path
+        "./" + filename,                    // Explicit current dir
+        ".\\" + filename,                   // Windows style
+        filename.substr(4),                 // Remove "src/" prefix
+        "GrauB2Config"                      // Just filename
+    };
+    
+    std::ifstream file;
+    bool fileOpened = false;
+    std::string workingPath;
+    
+    for (const auto& path : pathsToTry) {
+        file.open(path, std::ios::in);
+        if (file.is_open()) {
+            workingPath = path;
+            fileOpened = true;
+            break;
+        }
+        file.clear(); // Clear error flags
+    }
+    
+    if (!fileOpened) {
+        return false;
+    }
+    
+    std::string line;
+    
+    ObjectAnimation pendingAnimation; // Animacao para o próximo objeto
+    bool hasAnimation = false;
+    int pendingParent = -1;           // PARENT para o próximo objeto
+    std::vector<PartNodeConfig> pendingPartNodes;
+    
+    while (std::getline(file, line)) {
+        // Ignorar comentarios e linhas vazias
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        std::istringstream iss(line);
+        std::string command;
+        iss >> command;
+        
+        if (command == "CAMERA") {
+            iss >> config.camera.position.x >> config.camera.position.y >> config.camera.position.z
+                >> config.camera.target.x >> config.camera.target.y >> config.camera.target.z
+                >> config.camera.fov;
+            LOG_INFO("Câmera configurada: pos(" << config.camera.position.x << "," << config.camera.position.y << "," << config.camera.position.z << ")");
+        }
+        else if (command == "LIGHT1" || command == "LIGHT2" || command == "LIGHT3") {
+            SceneConfig::LightConfig light;
+            iss >> light.position.x >> light.position.y >> light.position.z >> light.intensity;
+            // Pesos fixos de cada papel: principal, preenchimento e fundo
+            light.weight = (command == "LIGHT1") ? 1.0f : (command == "LIGHT2") ? 0.4f : 0.65f;
+            config.lights.push_back(light);
+            LOG_INFO("Luz " << config.lights.size() << " configurada: pos(" << light.position.x << "," << light.position.y << "," << light.position.z << ") intensidade=" << light.intensity);
+        }
+        else if (command == "LIGHT") {
+            // LIGHT x y z intensidade [raio] [r g b] - quantidade arbitraria de luzes
+            SceneConfig::LightConfig light;
+            iss >> light.position.x >> light.position.y >> light.position.z >> light.intensity;
+            if (!(iss >> light.radius)) {
+                light.radius = 0.0f;
+            } else if (!(iss >> light.color.r >> light.color.g >> light.color.b)) {
+                light.color = glm::vec3(1.0f);
+            }
+            light.weight = light.intensity;
+            config.lights.push_back(light);
+            LOG_INFO("Luz " << config.lights.size() << " configurada: pos(" << light.position.x << "," << light.position.y << "," << light.position.z << ") intensidade=" << light.intensity);
+        }
+        else if (command == "CAMERA_PATH") {
+            // CAMERA_PATH p0 p1 p2 p3 duracao - cada linha adiciona uma curva ao caminho do benchmark
+            BezierCurve curve;
+            iss >> curve.p0.x >> curve.p0.y >> curve.p0.z >> curve.p1.x >> curve.p1.y >> curve.p1.z
+                >> curve.p2.x >> curve.p2.y >> curve.p2.z >> curve.p3.x >> curve.p3.y >> curve.p3.z
+                >> curve.duration;
+            curve.loop = false;
+            config.cameraPath.curves.push_back(curve);
+            config.cameraPath.totalDuration += curve.duration;
+            config.cameraPath.loop = true;
+        }
+        else if (command == "ANIMATION") {
+            // Parsear animacao para aplicar ao proximo objeto
+            if (parseAnimationConfig(line, pendingAnimation)) {
+                hasAnimation = true;
+            }
+        }
+        else if (command == "TRACK") {
+            // TRACK arquivo - o proximo objeto segue a pista do arquivo (compartilhada)
+            std::string trackPath;
+            std::getline(iss >> std::ws, trackPath);
+            std::shared_ptr<const BezierTrack> track = loadTrack(trackPath);
+            if (track) {
+                pendingAnimation = ObjectAnimation();
+                pendingAnimation.type = ANIM_BEZIER_TRACK;
+                pendingAnimation.bezierTrack = track;
+                hasAnimation = true;
+            }
+        }
+        else if (command == "KEYFRAMES") {
+            // KEYFRAMES arquivo - o proximo objeto reproduz a trilha de keyframes (compartilhada)
+            std::string keyframePath;
+            std::getline(iss >> std::ws, keyframePath);
+            std::shared_ptr<const KeyframeTrack> keyframes = loadKeyframeTrack(keyframePath);
+            if (keyframes) {
+                pendingAnimation = ObjectAnimation();
+                pendingAnimation.type = ANIM_LINEAR;
+                pendingAnimation.keyframes = keyframes;
+                hasAnimation = true;
+            }
+        }
+        else if (command == "PARENT") {
+            // PARENT indice - o proximo objeto fica preso ao objeto indice (0 = primeiro OBJECT);
+            // posicao, rotacao e escala dele passam a ser relativas ao pai
+            if (!(iss >> pendingParent) || pendingParent < 0 || pendingParent >= (int)config.objects.size()) {
+                LOG_WARN("PARENT invalido (precisa ser um OBJECT anterior): " << line);
+                pendingParent = -1;
+            }
+        }
+        else if (command == "PART") {
+            // PART material eixoX eixoY eixoZ grausPorSegundo [pivoX pivoY pivoZ] - a parte do
+            // proximo objeto vira um no filho do modelo e gira em torno do pivo (padrao: centro)
+            PartNodeConfig partNode;
+            if (iss >> partNode.part >> partNode.axis.x >> partNode.axis.y >> partNode.axis.z >> partNode.speed &&
+                length(partNode.axis) > 0.0f) {
+                partNode.axis = normalize(partNode.axis);
+                partNode.autoPivot = !(iss >> partNode.pivot.x >> partNode.pivot.y >> partNode.pivot.z);
+                pendingPartNodes.push_back(partNode);
+            } else {
+                LOG_WARN("PART invalido: " << line);
+            }
+        }
+        else if (command == "OBJECT") {
+            SceneConfig::ObjectConfig obj;
+            
+            // Parse manual para lidar com nomes de arquivo com espaços
+            std::string remainingLine;
+            std::getline(iss, remainingLine);
+            
+            // Encontrar onde começam os parâmetros numéricos (posição x y z)
+            // Procurar por padrão: espaço + número + espaço + número + espaço + número
+            std::regex paramPattern(R"(\s+(-?\d+(?:\.\d+)?)\s+(-?\d+(?:\.\d+)?)\s+(-?\d+(?:\.\d+)?))");
+            std::smatch match;
+            
+            if (std::regex_search(remainingLine, match, paramPattern)) {
+                // Extrair filename (tudo antes dos parâmetros)
+                size_t paramStart = match.position();
+                obj.filename = remainingLine.substr(0, paramStart);
+                
+                // Remover espaços do final do filename
+                obj.filename.erase(obj.filename.find_last_not_of(" \t") + 1);
+                // Remover espaço do início se houver
+                if (!obj.filename.empty() && obj.filename[0] == ' ') {
+                    obj.filename = obj.filename.substr(1);
+                }
+                
+                // Parse do resto da linha (números)
+                std::string numbers = remainingLine.substr(paramStart);
+                std::istringstream numberStream(numbers);
+                numberStream >> obj.position.x >> obj.position.y >> obj.position.z
+                            >> obj.rotation.x >> obj.rotation.y >> obj.rotation.z
+                            >> obj.scale.x >> obj.scale.y >> obj.scale.z >> obj.materialType;
+            } else {
+                // Fallback: tentar split por último espaço antes de números
+                std::vector<std::string> tokens;
+                std::istringstream tokenStream(remainingLine);
+                std::string token;
+                while (tokenStream >> token) {
+                    tokens.push_back(token);
+                }
+                
+                // Assumir que os últimos 10 tokens são os parâmetros numéricos + material
+                if (tokens.size() >= 10) {
+                    // Reconstruir filename dos primeiros tokens
+                    obj.filename = "";
+                    for (size_t i = 0; i < tokens.size() - 10; i++) {
+                        if (i > 0) obj.filename += " ";
+                        obj.filename += tokens[i];
+                    }
+                    
+                    // Parse dos últimos 10 tokens
+                    size_t paramStart = tokens.size() - 10;
+                    obj.position.x = std::stof(tokens[paramStart]);
+                    obj.position.y = std::stof(tokens[paramStart + 1]);
+                    obj.position.z = std::stof(tokens[paramStart + 2]);
+                    obj.rotation.x = std::stof(tokens[paramStart + 3]);
+                    obj.rotation.y = std::stof(tokens[paramStart + 4]);
+                    obj.rotation.z = std::stof(tokens[paramStart + 5]);
+                    obj.scale.x = std::stof(tokens[paramStart + 6]);
                     obj.scale.y = std::stof(tokens[paramStart + 7]);
                     obj.scale.z = std::stof(tokens[paramStart + 8]);
                     obj.materialType = tokens[paramStart + 9];
@@ -1479,24 +4762,1675 @@ bool loadSceneConfig(const std::string& filename, SceneConfig& config) {
                                   >> obj.scale.x >> obj.scale.y >> obj.scale.z >> obj.materialType;
                 }
             }
-            
-            // Aplicar animacao pendente se houver
-            if (hasAnimation) {
-                obj.animation = pendingAnimation;
-                obj.animation.originalPosition = obj.position;
-                hasAnimation = false;
-            } else {
-                obj.animation.type = ANIM_NONE;
+            
+            // Aplicar animacao pendente se houver
+            if (hasAnimation) {
+                obj.animation = pendingAnimation;
+                obj.animation.originalPosition = obj.position;
+                hasAnimation = false;
+            } else {
+                obj.animation.type = ANIM_NONE;
+            }
+            obj.parent = pendingParent;
+            obj.partNodes.swap(pendingPartNodes);
+            pendingParent = -1;
+            pendingPartNodes.clear();
+            
+            config.objects.push_back(obj);
+        }
+    }
+    
+    file.close();
+    return true;
+}
+
+// Microbenchmark do parser de configuracao: gera uma cena de 100k objetos (nomes com e
+// sem aspas, com espacos, animacoes e luzes), carrega com o parser novo e com o antigo,
+// compara os resultados e mostra o tempo de cada um
+void runConfigMicrobenchmark() {
+    const int OBJECT_COUNT = 100000;
+    const char* path = "graub2_config_bench.tmp";
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        LOG_ERROR("Nao foi possivel criar " << path);
+        return;
+    }
+    fprintf(out, "# Cena sintetica do microbenchmark\nCAMERA 0.0 25.0 45.0 0.0 0.0 0.0 75.0\n");
+    for (int i = 0; i < 64; i++) {
+        fprintf(out, "LIGHT %.2f 4.0 %.2f 2.0 10.0 1.0 0.85 0.6\n", coordinate(rng), coordinate(rng));
+    }
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        if (i % 10 == 0) {
+            fprintf(out, "ANIMATION orbit %.3f 0.0 %.3f 5.0 45.0\n", coordinate(rng), coordinate(rng));
+        }
+        const char* name = (i % 3 == 0) ? "../assets/2022-yamaha-r1/source/2022 Yamaha R1/2022 Yamaha R1.obj"
+                                         : "../assets/props/cone.obj";
+        fprintf(out, "OBJECT %s %.3f %.3f %.3f 0.0 %.1f 0.0 1.0 1.0 1.0 %s\n", name,
+                coordinate(rng), 0.0f, coordinate(rng), (float)(i % 360), (i % 2) ? "Metal" : "Front_End");
+    }
+    fclose(out);
+    struct stat info;
+    double megabytes = stat(path, &info) == 0 ? info.st_size / (1024.0 * 1024.0) : 0.0;
+
+    SceneConfig fast, legacy;
+    auto t0 = std::chrono::steady_clock::now();
+    bool fastOk = loadSceneConfig(path, fast);
+    auto t1 = std::chrono::steady_clock::now();
+    bool legacyOk = loadSceneConfigLegacy(path, legacy);
+    auto t2 = std::chrono::steady_clock::now();
+    std::remove(path);
+
+    // Mesma cena em binario
+    const char* binaryPath = "graub2_config_bench.gb2scene";
+    SceneConfig binary;
+    bool binaryOk = writeBinaryScene(binaryPath, fast);
+    double binaryMegabytes = stat(binaryPath, &info) == 0 ? info.st_size / (1024.0 * 1024.0) : 0.0;
+    auto t3 = std::chrono::steady_clock::now();
+    binaryOk = binaryOk && loadSceneConfig(binaryPath, binary);
+    auto t4 = std::chrono::steady_clock::now();
+    std::remove(binaryPath);
+
+    auto differs = [](const SceneConfig::ObjectConfig& a, const SceneConfig::ObjectConfig& b) {
+        return a.filename != b.filename || a.materialType != b.materialType || a.animation.type != b.animation.type ||
+               length(a.position - b.position) > 1e-4f || length(a.rotation - b.rotation) > 1e-4f;
+    };
+    size_t mismatches = 0, binaryMismatches = 0;
+    for (size_t i = 0; i < fast.objects.size() && i < legacy.objects.size(); i++) {
+        mismatches += differs(fast.objects[i], legacy.objects[i]);
+    }
+    for (size_t i = 0; i < fast.objects.size() && i < binary.objects.size(); i++) {
+        binaryMismatches += differs(fast.objects[i], binary.objects[i]);
+    }
+    double fastMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    double legacyMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+    LOG_INFO("Microbenchmark de configuracao: " << OBJECT_COUNT << " objetos, " << megabytes << " MB");
+    LOG_INFO("  parser novo:   " << fastMs << " ms (" << fast.objects.size() << " objetos, " << (fastOk ? "ok" : "falhou") << ")");
+    LOG_INFO("  parser antigo: " << legacyMs << " ms (" << legacy.objects.size() << " objetos, " << (legacyOk ? "ok" : "falhou") << ")");
+    LOG_INFO("  speedup: " << legacyMs / fastMs << "x, objetos diferentes: " << mismatches);
+    double binaryMs = std::chrono::duration<double, std::milli>(t4 - t3).count();
+    LOG_INFO("  cena binaria:  " << binaryMs << " ms ("
+             << binaryMegabytes << " MB, " << binary.objects.size() << " objetos, " << (binaryOk ? "ok" : "falhou")
+             << ", diferentes do texto: " << binaryMismatches << ")");
+}
+
+// Loader OBJ anterior a arena (mapas de indices por nome de material), mantido so para
+// comparacao no microbenchmark objload
+static bool loadOBJWithMaterialsLegacy(const char * path, Model& model, std::vector<Material> materials) {
+	PROFILE_SCOPE("loadOBJWithMaterialsLegacy");
+	
+	std::vector<glm::vec3> temp_vertices;
+	std::vector<glm::vec2> temp_uvs;
+	std::vector<glm::vec3> temp_normals;
+	
+	// Map para agrupar faces por material
+	std::map<std::string, std::vector<unsigned int>> materialVertexIndices;
+	std::map<std::string, std::vector<unsigned int>> materialUvIndices;
+	std::map<std::string, std::vector<unsigned int>> materialNormalIndices;
+	
+	std::string currentMaterial = "default";
+	
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		return false;
+	}
+	
+	while (true) {
+		char lineHeader[128];
+		int res = fscanf(file, "%s", lineHeader);
+		if (res == EOF) break;
+		
+		if (strcmp(lineHeader, "v") == 0) {
+			glm::vec3 vertex;
+			fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
+			temp_vertices.push_back(vertex);
+		}
+		else if (strcmp(lineHeader, "vt") == 0) {
+			glm::vec2 uv;
+			fscanf(file, "%f %f\n", &uv.x, &uv.y);
+			uv.y = -uv.y; // Inverter coordenada V
+			temp_uvs.push_back(uv);
+		}
+		else if (strcmp(lineHeader, "vn") == 0) {
+			glm::vec3 normal;
+			fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
+			temp_normals.push_back(normal);
+		}
+		else if (strcmp(lineHeader, "usemtl") == 0) {
+			fscanf(file, "%s", lineHeader);
+			currentMaterial = std::string(lineHeader);
+		}
+		else if (strcmp(lineHeader, "f") == 0) {
+			// Tentar ler como triângulo primeiro
+			unsigned int v1, v2, v3, v4 = 0;
+			unsigned int vt1, vt2, vt3, vt4 = 0;
+			unsigned int vn1, vn2, vn3, vn4 = 0;
+			
+			// Ler a linha restante
+			char faceLine[1000];
+			fgets(faceLine, 1000, file);
+			
+			// Tentar parse como quad primeiro
+			int matches = sscanf(faceLine, "%u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u", 
+				&v1, &vt1, &vn1, &v2, &vt2, &vn2, &v3, &vt3, &vn3, &v4, &vt4, &vn4);
+			
+			if (matches == 12) {
+				// É um quad - converter para 2 triângulos
+				// Primeiro triângulo: v1, v2, v3
+				materialVertexIndices[currentMaterial].push_back(v1);
+				materialVertexIndices[currentMaterial].push_back(v2);
+				materialVertexIndices[currentMaterial].push_back(v3);
+				materialUvIndices[currentMaterial].push_back(vt1);
+				materialUvIndices[currentMaterial].push_back(vt2);
+				materialUvIndices[currentMaterial].push_back(vt3);
+				materialNormalIndices[currentMaterial].push_back(vn1);
+				materialNormalIndices[currentMaterial].push_back(vn2);
+				materialNormalIndices[currentMaterial].push_back(vn3);
+				
+				// Segundo triângulo: v1, v3, v4
+				materialVertexIndices[currentMaterial].push_back(v1);
+				materialVertexIndices[currentMaterial].push_back(v3);
+				materialVertexIndices[currentMaterial].push_back(v4);
+				materialUvIndices[currentMaterial].push_back(vt1);
+				materialUvIndices[currentMaterial].push_back(vt3);
+				materialUvIndices[currentMaterial].push_back(vt4);
+				materialNormalIndices[currentMaterial].push_back(vn1);
+				materialNormalIndices[currentMaterial].push_back(vn3);
+				materialNormalIndices[currentMaterial].push_back(vn4);
+			} else {
+				// Tentar como triângulo
+				matches = sscanf(faceLine, "%u/%u/%u %u/%u/%u %u/%u/%u", 
+					&v1, &vt1, &vn1, &v2, &vt2, &vn2, &v3, &vt3, &vn3);
+				
+				if (matches == 9) {
+					// É um triângulo
+					materialVertexIndices[currentMaterial].push_back(v1);
+					materialVertexIndices[currentMaterial].push_back(v2);
+					materialVertexIndices[currentMaterial].push_back(v3);
+					materialUvIndices[currentMaterial].push_back(vt1);
+					materialUvIndices[currentMaterial].push_back(vt2);
+					materialUvIndices[currentMaterial].push_back(vt3);
+					materialNormalIndices[currentMaterial].push_back(vn1);
+					materialNormalIndices[currentMaterial].push_back(vn2);
+					materialNormalIndices[currentMaterial].push_back(vn3);
+				}
+			}
+		}
+		else {
+			// Pular linha
+			char stupidBuffer[1000];
+			fgets(stupidBuffer, 1000, file);
+		}
+	}
+	
+	fclose(file);
+	
+	// Criar uma parte do modelo para cada material; as partes guardam o indice do material
+	model.materials = std::move(materials);
+	model.parts.reserve(model.parts.size() + materialVertexIndices.size());
+	for (auto& pair : materialVertexIndices) {
+		const std::string& matName = pair.first;
+		std::vector<unsigned int>& vertexIndices = pair.second;
+		std::vector<unsigned int>& uvIndices = materialUvIndices[matName];
+		std::vector<unsigned int>& normalIndices = materialNormalIndices[matName];
+		
+		// Verificar se ha faces suficientes para este material
+		if (vertexIndices.size() % 3 != 0) {
+			continue;
+		}
+		
+		model.parts.emplace_back();
+		ModelPart& part = model.parts.back();
+		part.materialName = matName;
+		part.vertices.reserve(vertexIndices.size());
+		part.uvs.reserve(vertexIndices.size());
+		part.normals.reserve(vertexIndices.size());
+		
+		// Converter indices para vertices
+		for (size_t i = 0; i < vertexIndices.size(); i++) {
+			if (vertexIndices[i] > temp_vertices.size() || 
+			    uvIndices[i] > temp_uvs.size() || 
+			    normalIndices[i] > temp_normals.size()) {
+				continue;
+			}
+			
+			part.vertices.push_back(temp_vertices[vertexIndices[i] - 1]);
+			part.uvs.push_back(temp_uvs[uvIndices[i] - 1]);
+			
+			// Garantir que todas as normais estao normalizadas
+			glm::vec3 normal = temp_normals[normalIndices[i] - 1];
+			if (length(normal) > 0.0001f) {
+				normal = normalize(normal);
+			} else {
+				normal = glm::vec3(0.0f, 1.0f, 0.0f);
+			}
+			part.normals.push_back(normal);
+		}
+		
+		finishObjPart(model, part);
+	}
+	
+	return model.parts.size() > 0;
+}
+
+// Microbenchmark da carga de OBJ: gera uma malha sintetica (grade de quads com v/vt/vn e
+// um usemtl por linha, alternando 8 materiais), carrega com o loader da arena e com o
+// anterior, sem GL como na carga em fundo, e compara tempo, alocacoes e o resultado
+void runObjLoadMicrobenchmark() {
+    const int GRID = 400;                     // 400x400 quads = 320k triangulos
+    const int MATERIALS = 8;
+    const int ITERATIONS = 5;
+    const char* path = "graub2_objload_bench.tmp.obj";
+
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        LOG_ERROR("Nao foi possivel criar " << path);
+        return;
+    }
+    std::vector<char> buffer(1 << 20);
+    setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+    for (int y = 0; y <= GRID; y++) {
+        for (int x = 0; x <= GRID; x++) {
+            fprintf(out, "v %.3f %.3f %.3f\nvt %.4f %.4f\nvn 0.0 1.0 0.0\n", x * 0.1f, 0.05f * ((x + y) % 7), y * 0.1f,
+                    (float)x / GRID, (float)y / GRID);
+        }
+    }
+    for (int y = 0; y < GRID; y++) {
+        fprintf(out, "usemtl Material_%d\n", y % MATERIALS);
+        for (int x = 0; x < GRID; x++) {
+            int a = y * (GRID + 1) + x + 1, b = a + 1, c = a + GRID + 2, d = a + GRID + 1;
+            fprintf(out, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+        }
+    }
+    fclose(out);
+    buffer = std::vector<char>();
+    struct stat info;
+    double megabytes = stat(path, &info) == 0 ? info.st_size / (1024.0 * 1024.0) : 0.0;
+
+    // Sem GL: os loaders so fazem a parte de CPU
+    AssetStaging staging;
+    AssetStaging* previousStaging = assetStaging;
+    assetStaging = &staging;
+
+    // A primeira carga de cada loader aquece o cache de arquivos e a arena e nao entra na media
+    auto measure = [&](bool arena, Model& result, double& ms, size_t& allocations) {
+        ms = 0.0;
+        allocations = 0;
+        for (int i = 0; i <= ITERATIONS; i++) {
+            Model model;
+            size_t allocationsBefore = allocationCounter();
+            auto t0 = std::chrono::steady_clock::now();
+            if (arena) {
+                loadOBJWithMaterials(path, model, std::vector<Material>());
+            } else {
+                loadOBJWithMaterialsLegacy(path, model, std::vector<Material>());
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            if (i > 0) {
+                ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+                allocations += allocationCounter() - allocationsBefore;
+            }
+            if (i == ITERATIONS) {
+                result = std::move(model);
+            }
+        }
+        ms /= ITERATIONS;
+        allocations /= ITERATIONS;
+    };
+    Model legacy, fast;
+    double legacyMs, fastMs;
+    size_t legacyAllocations, fastAllocations;
+    measure(false, legacy, legacyMs, legacyAllocations);
+    measure(true, fast, fastMs, fastAllocations);
+    assetStaging = previousStaging;
+    std::remove(path);
+
+    size_t mismatches = legacy.parts.size() != fast.parts.size();
+    for (size_t i = 0; i < legacy.parts.size() && i < fast.parts.size(); i++) {
+        const ModelPart& a = legacy.parts[i];
+        const ModelPart& b = fast.parts[i];
+        mismatches += a.materialName != b.materialName || a.vertices != b.vertices || a.uvs != b.uvs || a.normals != b.normals;
+    }
+    size_t arenaBytes = 0;
+    for (const ScratchArena::Block& block : loadScratch.blocks) {
+        arenaBytes += block.size;
+    }
+
+    LOG_INFO("Microbenchmark de carga de OBJ: " << GRID * GRID * 2 << " triangulos, " << MATERIALS << " materiais, "
+             << megabytes << " MB");
+    if (allocationCounter() == 0) {
+        LOG_INFO("  (contagem de alocacoes so no GrauB2Bench, compilado com GRAUB2_COUNT_ALLOCATIONS)");
+    }
+    LOG_INFO("  loader anterior:  " << legacyMs << " ms/carga, " << legacyAllocations << " alocacoes/carga");
+    LOG_INFO("  loader com arena: " << fastMs << " ms/carga, " << fastAllocations << " alocacoes/carga, arena de "
+             << arenaBytes / (1024.0 * 1024.0) << " MB reaproveitada");
+    LOG_INFO("  speedup: " << legacyMs / fastMs << "x, partes diferentes: " << mismatches);
+    loadScratch.release();
+}
+#endif
+
+// Presets do --gen-assets: nome curto -> OBJ, material e escala da cena de exemplo
+struct SceneAssetPreset {
+    const char* name;
+    const char* path;
+    const char* material;
+    float scale;
+};
+static const SceneAssetPreset SCENE_ASSET_PRESETS[] = {
+    { "r1", "../assets/2022-yamaha-r1/source/2022 Yamaha R1/2022 Yamaha R1.obj", "Front_End", 1.2f },
+    { "suzanne", "../assets/Modelos3D/Suzanne.obj", "SHINY", 1.0f },
+    { "suzanne-hd", "../assets/Modelos3D/SuzanneSubdiv1.obj", "SHINY", 1.0f },
+    { "track", "../assets/drift-race-track-free/source/DriftTrack3.obj", "Asphalt", 1.0f },
+};
+
+struct GeneratorChoice {
+    std::string name;
+    float weight;
+};
+
+// Lista "nome:peso,nome:peso,..." do gerador. Sem peso (ou se o que vem depois do ultimo
+// ':' nao e numero, como em C:/cena.obj) o item vale 1.
+static bool parseGeneratorChoices(const std::string& spec, std::vector<GeneratorChoice>& choices) {
+    choices.clear();
+    float total = 0.0f;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) end = spec.size();
+        GeneratorChoice choice{ spec.substr(start, end - start), 1.0f };
+        start = end + 1;
+        if (choice.name.empty()) continue;
+
+        size_t colon = choice.name.rfind(':');
+        if (colon != std::string::npos && colon + 1 < choice.name.size()) {
+            const char* weightText = choice.name.c_str() + colon + 1;
+            char* parsedEnd = nullptr;
+            float weight = strtof(weightText, &parsedEnd);
+            if (parsedEnd != weightText && *parsedEnd == '\0') {
+                if (!(weight >= 0.0f)) {
+                    LOG_ERROR("Peso invalido em " << choice.name);
+                    return false;
+                }
+                choice.weight = weight;
+                choice.name.resize(colon);
+            }
+        }
+        total += choice.weight;
+        choices.push_back(choice);
+    }
+    if (!(total > 0.0f)) {
+        LOG_ERROR("Lista sem nenhum peso positivo: " << spec);
+        return false;
+    }
+    return true;
+}
+
+// Aleatorio do gerador: so o mt19937 (sequencia fixada pelo padrao) com a conversao para
+// float feita aqui, pois as distribuicoes da biblioteca padrao variam entre implementacoes.
+// Cada sorteio fica em uma variavel propria: a ordem de avaliacao de argumentos nao e definida.
+struct SceneRandom {
+    std::mt19937 engine;
+    explicit SceneRandom(uint32_t seed) : engine(seed) {}
+    float uniform() { return (engine() >> 8) * (1.0f / 16777216.0f); }   // [0, 1)
+    float range(float low, float high) { return low + (high - low) * uniform(); }
+    float gaussian() {
+        float u1 = 1.0f - uniform();
+        float u2 = uniform();
+        return std::sqrt(-2.0f * std::log(u1)) * std::cos(2.0f * (float)M_PI * u2);
+    }
+    size_t pick(const std::vector<GeneratorChoice>& choices) {
+        float total = 0.0f;
+        for (const GeneratorChoice& choice : choices) total += choice.weight;
+        float target = uniform() * total;
+        for (size_t i = 0; i < choices.size(); i++) {
+            target -= choices[i].weight;
+            if (target < 0.0f) return i;
+        }
+        return choices.size() - 1;
+    }
+};
+
+// Grava uma cena sintetica no formato texto do GrauB2Config: camera enquadrando tudo, uma
+// luz global mais sceneGenerator.lights postes e sceneGenerator.count objetos distribuidos
+// em grade, em aglomerados ou ao longo da pista. Mesma semente e parametros = mesmo arquivo.
+bool generateScene(const std::string& path) {
+    PROFILE_SCOPE("Generate scene");
+    const SceneGeneratorOptions& options = sceneGenerator;
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<GeneratorChoice> assetChoices, animationChoices;
+    if (!parseGeneratorChoices(options.assets, assetChoices) ||
+        !parseGeneratorChoices(options.animations, animationChoices)) {
+        return false;
+    }
+
+    // Preset ou caminho de um OBJ qualquer
+    std::vector<SceneAssetPreset> assets;
+    for (const GeneratorChoice& choice : assetChoices) {
+        SceneAssetPreset asset = { choice.name.c_str(), choice.name.c_str(), "SHINY", 1.0f };
+        for (const SceneAssetPreset& preset : SCENE_ASSET_PRESETS) {
+            if (choice.name == preset.name) {
+                asset = preset;
+                break;
+            }
+        }
+        assets.push_back(asset);
+    }
+
+    std::vector<AnimationType> animationTypes;
+    bool usesTrack = options.layout == "track";
+    for (const GeneratorChoice& choice : animationChoices) {
+        if (choice.name == "none") {
+            animationTypes.push_back(ANIM_NONE);
+        } else if (choice.name == "orbit") {
+            animationTypes.push_back(ANIM_ORBIT);
+        } else if (choice.name == "bezier") {
+            animationTypes.push_back(ANIM_BEZIER);
+        } else if (choice.name == "track") {
+            animationTypes.push_back(ANIM_BEZIER_TRACK);
+            usesTrack = usesTrack || choice.weight > 0.0f;
+        } else {
+            LOG_ERROR("Animacao desconhecida no --gen-anim: " << choice.name << " (use none|orbit|bezier|track)");
+            return false;
+        }
+    }
+    if (options.layout != "grid" && options.layout != "clustered" && options.layout != "track") {
+        LOG_ERROR("Layout desconhecido: " << options.layout << " (use grid|clustered|track)");
+        return false;
+    }
+
+    std::shared_ptr<const BezierTrack> track;
+    if (usesTrack) {
+        track = loadTrack(options.trackPath);
+        if (!track) {
+            LOG_WARN("Usando a pista embutida para o layout; TRACK " << options.trackPath << " nao carregara");
+            track = builtinDriftTrack();
+        }
+    }
+
+    // Posicoes primeiro: a camera e os postes dependem da extensao da cena
+    struct GeneratedObject {
+        glm::vec3 position;
+        float yaw;
+        float trackTime;                      // Layout track: tempo da pista onde o objeto esta (-1 = outro layout)
+        uint32_t asset;
+        AnimationType animation;
+    };
+    const float SPACING = 6.0f;               // Distancia entre objetos na grade
+    const float TRACK_HALF_WIDTH = 4.0f;      // Faixa em volta da linha central da pista
+    SceneRandom rng(options.seed);
+    size_t side = std::max<size_t>(1, (size_t)std::ceil(std::sqrt((double)options.count)));
+    float half = side * SPACING * 0.5f;
+
+    std::vector<glm::vec3> clusterCenters;
+    if (options.layout == "clustered") {
+        size_t clusterCount = std::max<size_t>(1, options.count / 256);
+        for (size_t i = 0; i < clusterCount; i++) {
+            float x = rng.range(-half, half);
+            float z = rng.range(-half, half);
+            clusterCenters.push_back(glm::vec3(x, 0.0f, z));
+        }
+    }
+
+    std::vector<GeneratedObject> objects(options.count);
+    glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+    for (size_t i = 0; i < objects.size(); i++) {
+        GeneratedObject& object = objects[i];
+        object.trackTime = -1.0f;
+        if (options.layout == "grid") {
+            object.position = glm::vec3((i % side) * SPACING - half + SPACING * 0.5f, 0.0f,
+                                        (i / side) * SPACING - half + SPACING * 0.5f);
+            object.yaw = rng.range(0.0f, 360.0f);
+        } else if (options.layout == "clustered") {
+            size_t cluster = std::min(clusterCenters.size() - 1, (size_t)(rng.uniform() * clusterCenters.size()));
+            const glm::vec3& center = clusterCenters[cluster];
+            float x = rng.gaussian();
+            float z = rng.gaussian();
+            object.position = center + glm::vec3(x, 0.0f, z) * (SPACING * 4.0f);
+            object.yaw = rng.range(0.0f, 360.0f);
+        } else {
+            float t = track->totalDuration * ((float)i + rng.uniform()) / (float)objects.size();
+            glm::vec3 direction;
+            glm::vec3 point = calculateBezierTrackPosition(*track, t, direction);
+            glm::vec3 side2d(-direction.z, 0.0f, direction.x);
+            float sideLength = length(side2d);
+            float offset = rng.range(-TRACK_HALF_WIDTH, TRACK_HALF_WIDTH);
+            object.position = sideLength > 1e-6f ? point + side2d * (offset / sideLength) : point;
+            object.yaw = degrees(atan2f(direction.x, direction.z));
+            object.trackTime = t;
+        }
+        object.asset = (uint32_t)rng.pick(assetChoices);
+        object.animation = animationTypes[rng.pick(animationChoices)];
+        boundsMin = glm::min(boundsMin, object.position);
+        boundsMax = glm::max(boundsMax, object.position);
+    }
+    if (objects.empty()) {
+        boundsMin = boundsMax = glm::vec3(0.0f);
+    }
+
+    FILE* out = fopen(path.c_str(), "w");
+    if (out == NULL) {
+        LOG_ERROR("Nao foi possivel criar " << path);
+        return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+
+    fprintf(out, "# Cena sintetica: --gen-count %zu --gen-assets %s --gen-layout %s --gen-anim %s --gen-lights %d --gen-seed %u\n",
+            options.count, options.assets.c_str(), options.layout.c_str(), options.animations.c_str(),
+            options.lights, (unsigned)options.seed);
+
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    float extent = std::max(boundsMax.x - boundsMin.x, boundsMax.z - boundsMin.z) + SPACING;
+    fprintf(out, "CAMERA %.3f %.3f %.3f %.3f %.3f %.3f 60.0\n\n", center.x, center.y + extent * 0.5f + 10.0f,
+            center.z + extent * 0.7f + 10.0f, center.x, center.y, center.z);
+
+    // Luz global (raio 0) e postes com alcance proporcional a area de cada um
+    fprintf(out, "LIGHT %.3f %.3f %.3f 1.0\n", center.x, center.y + extent + 20.0f, center.z);
+    float lampRadius = options.lights > 0 ? std::max(12.0f, 1.5f * extent / std::sqrt((float)options.lights)) : 0.0f;
+    for (int i = 0; i < options.lights; i++) {
+        glm::vec3 lamp;
+        if (options.layout == "track") {
+            glm::vec3 direction;
+            lamp = calculateBezierTrackPosition(*track, track->totalDuration * i / options.lights, direction);
+            glm::vec3 side2d(-direction.z, 0.0f, direction.x);
+            float sideLength = length(side2d);
+            if (sideLength > 1e-6f) {
+                lamp += side2d * ((i % 2 ? -1.0f : 1.0f) * (TRACK_HALF_WIDTH + 2.0f) / sideLength);
+            }
+        } else {
+            float x = rng.range(boundsMin.x, boundsMax.x);
+            float z = rng.range(boundsMin.z, boundsMax.z);
+            lamp = glm::vec3(x, 0.0f, z);
+        }
+        glm::vec3 color = (i % 2) ? glm::vec3(0.7f, 0.8f, 1.0f) : glm::vec3(1.0f, 0.85f, 0.6f);
+        fprintf(out, "LIGHT %.3f %.3f %.3f 2.0 %.2f %.2f %.2f %.2f\n", lamp.x, lamp.y + 6.0f, lamp.z,
+                lampRadius, color.r, color.g, color.b);
+    }
+    fprintf(out, "\n");
+
+    for (const GeneratedObject& object : objects) {
+        const glm::vec3& p = object.position;
+        if (object.animation == ANIM_ORBIT) {
+            float radius = rng.range(1.0f, 4.0f);
+            float speed = rng.range(20.0f, 90.0f);
+            float sign = rng.uniform() < 0.5f ? -1.0f : 1.0f;
+            fprintf(out, "ANIMATION orbit %.3f %.3f %.3f %.3f %.3f\n", p.x, p.y, p.z, radius, speed * sign);
+        } else if (object.animation == ANIM_BEZIER) {
+            // Laco fechado (p3 = p0) para o loop nao saltar
+            glm::vec3 controls[2];
+            for (glm::vec3& control : controls) {
+                float x = rng.range(-8.0f, 8.0f);
+                float y = rng.range(0.0f, 3.0f);
+                float z = rng.range(-8.0f, 8.0f);
+                control = p + glm::vec3(x, y, z);
+            }
+            float duration = rng.range(4.0f, 12.0f);
+            fprintf(out, "ANIMATION bezier %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f %.3f\n",
+                    p.x, p.y, p.z, controls[0].x, controls[0].y, controls[0].z,
+                    controls[1].x, controls[1].y, controls[1].z, p.x, p.y, p.z, duration);
+        } else if (object.animation == ANIM_BEZIER_TRACK) {
+            // Cada objeto parte de um ponto da pista (o seu, no layout track): sem a fase
+            // todos ficariam empilhados no inicio
+            float phase = object.trackTime >= 0.0f ? object.trackTime : rng.range(0.0f, track->totalDuration);
+            fprintf(out, "PHASE %.3f\nTRACK %s\n", phase, options.trackPath.c_str());
+        }
+        const SceneAssetPreset& asset = assets[object.asset];
+        fprintf(out, "OBJECT \"%s\" %.3f %.3f %.3f 0.0 %.2f 0.0 %.2f %.2f %.2f %s\n", asset.path, p.x, p.y, p.z,
+                object.yaw, asset.scale, asset.scale, asset.scale, asset.material);
+    }
+
+    bool ok = ferror(out) == 0;
+    ok = fclose(out) == 0 && ok;
+    if (!ok) {
+        LOG_ERROR("Falha ao gravar " << path);
+        return false;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    LOG_INFO("Cena sintetica gravada em " << path << ": " << objects.size() << " objetos, "
+             << options.lights << " postes, layout " << options.layout << ", semente " << options.seed
+             << " (" << ms << " ms)");
+    return true;
+}
+
+// Luzes usadas quando a configuracao nao define nenhuma
+void addDefaultLights(SceneConfig& config) {
+    SceneConfig::LightConfig defaultLight;
+    defaultLight.intensity = 1.0f;
+    defaultLight.position = vec3(2.0, 3.0, 4.0);
+    defaultLight.weight = 1.0f;
+    config.lights.push_back(defaultLight);
+    defaultLight.position = vec3(-2.0, 1.0, 2.0);
+    defaultLight.weight = 0.4f;
+    config.lights.push_back(defaultLight);
+    defaultLight.position = vec3(0.0, 1.0, -3.0);
+    defaultLight.weight = 0.65f;
+    config.lights.push_back(defaultLight);
+}
+
+// Carrega as partes de um objeto da configuracao: OBJ com o MTL ao lado ou, sem MTL, o
+// loader antigo com o material do tipo pedido. Com assetStaging so faz a parte de CPU.
+bool loadSceneObject(const SceneConfig::ObjectConfig& objConfig, Model& model) {
+    // Tentar carregar material do arquivo .mtl primeiro
+    std::string mtlFile = getMTLFilename(objConfig.filename);
+    std::vector<Material> materials;
+
+    if (loadMTL(mtlFile, materials)) {
+        return loadOBJWithMaterials(objConfig.filename.c_str(), model, std::move(materials));
+    }
+
+    // Fallback: usar loader antigo e criar material unico (le direto nos vetores da parte)
+    ModelPart part;
+    if (!loadOBJ(objConfig.filename.c_str(), part.vertices, part.uvs, part.normals)) {
+        return false;
+    }
+    part.nVertices = part.vertices.size();
+    part.materialName = objConfig.materialType;
+    part.materialId = (uint32_t)model.materials.size();
+    model.materials.push_back(createMaterial(objConfig.materialType));
+    if (assetStaging == nullptr) {
+        part.VAO = createModelPartVAO(part, model.materials.back());
+        part.depthVAO = createModelPartDepthVAO(part);
+    }
+
+    model.parts.push_back(std::move(part));
+    return true;
+}
+
+// Apaga um VAO e o buffer de vertices ligado a ele, descontando a memoria das estatisticas
+static void deleteVertexArray(GLuint VAO) {
+    GLint buffer = 0, size = 0;
+    glBindVertexArray(VAO);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+    glBindVertexArray(0);
+    if (buffer != 0) {
+        GLuint bufferID = (GLuint)buffer;
+        glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+        glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        renderStats.bufferBytes -= std::min((size_t)size, renderStats.bufferBytes);
+        glDeleteBuffers(1, &bufferID);
+    }
+    glDeleteVertexArrays(1, &VAO);
+}
+
+// Memoria da textura com mipmaps, na mesma conta de createTexture
+static size_t textureMemoryBytes(GLuint texture) {
+    GLint width = 0, height = 0, format = 0;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return (size_t)width * height * (format == GL_RGB ? 3 : 4) * 4 / 3;
+}
+
+static void deleteTexture(GLuint texture) {
+    size_t bytes = textureMemoryBytes(texture);
+    renderStats.textureBytes -= std::min(bytes, renderStats.textureBytes);
+    glDeleteTextures(1, &texture);
+}
+
+// Solta uma referencia; objetos que nunca foram retidos (carga interrompida) sao apagados
+static void releaseGpuObject(std::unordered_map<GLuint, int>& counts, GLuint id, void (*destroy)(GLuint)) {
+    if (id == 0) {
+        return;
+    }
+    auto it = counts.find(id);
+    if (it != counts.end() && --it->second > 0) {
+        return;
+    }
+    if (it != counts.end()) {
+        counts.erase(it);
+    }
+    destroy(id);
+}
+
+// Cada parte que usa um VAO e cada material com textura contam uma referencia
+void retainModelGpu(const Model& model) {
+    for (const ModelPart& part : model.parts) {
+        if (part.VAO != 0) gpuRefs.vertexArrays[part.VAO]++;
+        if (part.depthVAO != 0) gpuRefs.vertexArrays[part.depthVAO]++;
+    }
+    for (const Material& material : model.materials) {
+        if (material.textureID != 0) gpuRefs.textures[material.textureID]++;
+    }
+}
+
+// Solta as referencias do modelo; o ultimo usuario de cada objeto GL o apaga
+void releaseModelGpu(Model& model) {
+    for (ModelPart& part : model.parts) {
+        releaseGpuObject(gpuRefs.vertexArrays, part.VAO, deleteVertexArray);
+        releaseGpuObject(gpuRefs.vertexArrays, part.depthVAO, deleteVertexArray);
+        part.VAO = part.depthVAO = 0;
+    }
+    for (Material& material : model.materials) {
+        releaseGpuObject(gpuRefs.textures, material.textureID, deleteTexture);
+        material.textureID = 0;
+    }
+}
+
+// Copias das malhas na CPU (capacidade reservada, nao so o tamanho)
+static size_t meshCpuBytes(const Model& model) {
+    size_t bytes = 0;
+    for (const ModelPart& part : model.parts) {
+        bytes += part.vertices.capacity() * sizeof(glm::vec3) + part.normals.capacity() * sizeof(glm::vec3) +
+                 part.uvs.capacity() * sizeof(glm::vec2);
+    }
+    return bytes;
+}
+
+// Buffer intercalado (11 floats) e de profundidade (3 floats) por vertice, mais as texturas
+// que ainda nao estao em countedTextures (texturas compartilhadas contam uma vez)
+static size_t meshGpuBytes(const Model& model, std::set<GLuint>& countedTextures) {
+    size_t bytes = 0;
+    for (const ModelPart& part : model.parts) {
+        if (part.VAO != 0) bytes += (size_t)part.nVertices * 11 * sizeof(GLfloat);
+        if (part.depthVAO != 0) bytes += (size_t)part.nVertices * sizeof(glm::vec3);
+    }
+    for (const Material& material : model.materials) {
+        if (material.textureID != 0 && countedTextures.insert(material.textureID).second) {
+            bytes += textureMemoryBytes(material.textureID);
+        }
+    }
+    return bytes;
+}
+
+// Aplica meshResidency a um modelo ja enviado para a GPU (partes sem VAO ficam intactas).
+// Partes marcadas com keepPositions (pista de alguma "ANIMATION track", ver
+// keepTrackPositions) guardam as posicoes para a linha poder ser extraida de novo.
+void releaseMeshCopies(Model& model) {
+    if (meshResidency == RESIDENCY_CPU_GPU) {
+        return;
+    }
+    for (ModelPart& part : model.parts) {
+        if (part.VAO == 0) continue;
+        std::vector<glm::vec2>().swap(part.uvs);
+        std::vector<glm::vec3>().swap(part.normals);
+        if (meshResidency == RESIDENCY_GPU_ONLY && !part.keepPositions) {
+            std::vector<glm::vec3>().swap(part.vertices);
+        } else {
+            part.vertices.shrink_to_fit();
+        }
+    }
+}
+
+// Devolve ao sistema a memoria livre do heap, para o RSS cair. Percorre o heap inteiro:
+// no hot reload roda na thread de fundo, nunca no frame da troca.
+void trimHeap() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+}
+
+// Depois de soltar as malhas da carga inicial
+void applyMeshResidency() {
+    if (meshResidency == RESIDENCY_CPU_GPU) {
+        return;
+    }
+    for (Model& model : models) {
+        releaseMeshCopies(model);
+    }
+    trimHeap();
+}
+
+// Campo de /proc/self/status em KB (VmRSS = residente, VmHWM = pico); 0 fora do Linux
+size_t processMemoryKb(const char* field) {
+#ifdef __linux__
+    FILE* status = fopen("/proc/self/status", "r");
+    if (status == NULL) {
+        return 0;
+    }
+    char line[256];
+    size_t kb = 0, length = strlen(field);
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, field, length) == 0) {
+            kb = strtoull(line + length, NULL, 10);
+            break;
+        }
+    }
+    fclose(status);
+    return kb;
+#else
+    (void)field;
+    return 0;
+#endif
+}
+
+// Zera o pico de RSS (VmHWM) para medir uma carga isolada; precisa de Linux 4.0+
+bool resetPeakMemory() {
+#ifdef __linux__
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write(fd, "5", 1) == 1;
+    close(fd);
+    return ok;
+#else
+    return false;
+#endif
+}
+
+// Soma a carga de um objeto no relatorio do asset (sceneAssetKey): rssBeforeKb e o RSS antes
+// da leitura e peakTracked diz se o pico foi zerado antes dela (so no primeiro objeto do asset)
+void recordModelLoad(const std::string& asset, const Model& model, size_t rssBeforeKb, bool peakTracked, double loadMs) {
+    LoadMemoryEntry& entry = loadMemory.assets[asset];
+    entry.objects++;
+    entry.loadMs += loadMs;
+    for (const ModelPart& part : model.parts) {
+        entry.vertices += part.nVertices;
+    }
+    entry.cpuLoaded += meshCpuBytes(model);
+    entry.gpuBytes += meshGpuBytes(model, entry.textures);
+    if (peakTracked) {
+        size_t peakKb = processMemoryKb("VmHWM:");
+        entry.peakKb = std::max(entry.peakKb, peakKb > rssBeforeKb ? peakKb - rssBeforeKb : 0);
+        loadMemory.peakTracked = true;
+    }
+}
+
+// Uma linha por asset e o RSS antes/depois de aplicar a politica de residencia
+void logLoadMemoryReport(size_t rssLoadedKb) {
+    static const char* RESIDENCY_NAMES[] = { "gpu", "cpu", "compact" };
+    std::map<std::string, size_t> resident;
+    for (size_t i = 0; i < sceneConfig.objects.size() && i < hotReload.objectModel.size(); i++) {
+        if (hotReload.objectModel[i] >= 0) {
+            resident[sceneAssetKey(sceneConfig.objects[i])] += meshCpuBytes(models[hotReload.objectModel[i]]);
+        }
+    }
+    const double MB = 1024.0 * 1024.0;
+    size_t cpuLoaded = 0, cpuResident = 0, gpuBytes = 0;
+    LOG_INFO("Memoria das malhas (residencia " << RESIDENCY_NAMES[meshResidency] << "):");
+    for (const auto& item : loadMemory.assets) {
+        const LoadMemoryEntry& entry = item.second;
+        size_t residentBytes = resident[item.first];
+        cpuLoaded += entry.cpuLoaded;
+        cpuResident += residentBytes;
+        gpuBytes += entry.gpuBytes;
+        // Chave "arquivo\nmaterial" aparece como "arquivo (material)"
+        std::string name = item.first;
+        size_t separator = name.find('\n');
+        if (separator != std::string::npos) {
+            name = separator + 1 < name.size() ? name.substr(0, separator) + " (" + name.substr(separator + 1) + ")"
+                                               : name.substr(0, separator);
+        }
+        LOG_INFO("  " << name << " x" << entry.objects << ": " << entry.vertices << " vertices, CPU "
+                 << entry.cpuLoaded / MB << " -> " << residentBytes / MB << " MB, GPU " << entry.gpuBytes / MB
+                 << " MB, pico na carga " << (loadMemory.peakTracked ? std::to_string(entry.peakKb / 1024) + " MB" : "n/d")
+                 << ", " << entry.loadMs << " ms");
+    }
+    size_t rssNowKb = processMemoryKb("VmRSS:");
+    LOG_INFO("  total: CPU " << cpuLoaded / MB << " -> " << cpuResident / MB << " MB, GPU " << gpuBytes / MB
+             << " MB, RSS " << rssLoadedKb / 1024 << " -> " << rssNowKb / 1024 << " MB (inicio "
+             << loadMemory.rssStartKb / 1024 << " MB, pico " << processMemoryKb("VmHWM:") / 1024 << " MB)");
+}
+
+// Cria texturas e VAOs que a carga em fundo deixou pendentes, parando no prazo.
+// Retorna true quando o modelo esta completo; nextPart guarda o progresso entre frames.
+static bool uploadStagedModel(Model& model, AssetStaging& staging, size_t& nextPart,
+                              std::chrono::steady_clock::time_point deadline) {
+    while (!staging.textures.empty()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        StagedTexture& texture = staging.textures.back();
+        for (Material& material : model.materials) {
+            if (material.name == texture.material && material.textureID == 0) {
+                material.textureID = createTexture(texture.pixels, texture.width, texture.height, texture.channels);
+            }
+        }
+        stbi_image_free(texture.pixels);
+        staging.textures.pop_back();
+    }
+    for (; nextPart < model.parts.size(); nextPart++) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        ModelPart& part = model.parts[nextPart];
+        if (part.VAO == 0) {
+            part.VAO = createModelPartVAO(part, model.materials[part.materialId]);
+            part.depthVAO = createModelPartDepthVAO(part);
+        }
+    }
+    return true;
+}
+
+// Copia as partes de um modelo do mesmo asset; VAOs e texturas sao compartilhados
+static void cloneModelParts(const Model& source, Model& model) {
+    model.parts = source.parts;
+    model.materials = source.materials;
+    for (ModelPart& part : model.parts) {
+        part.node = -1;
+        part.visible = true;
+    }
+}
+
+// Um asset e o OBJ com o tipo de material: o mesmo arquivo com outro material e outra malha
+std::string sceneAssetKey(const SceneConfig::ObjectConfig& object) {
+    return object.filename + '\n' + object.materialType;
+}
+
+// Chave de um arquivo observado: diretorio + "/" + nome, montada do mesmo jeito que o
+// caminho que chega nos eventos do inotify (diretorio do watch + nome do evento)
+static std::string watchKey(const std::string& path, std::string* directory = nullptr) {
+    size_t slash = path.find_last_of("/\\");
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    if (directory) {
+        *directory = dir;
+    }
+    return dir + "/" + path.substr(slash == std::string::npos ? 0 : slash + 1);
+}
+
+// Passa a observar um arquivo (e o diretorio dele, uma vez por diretorio)
+static void hotReloadWatch(const std::string& path) {
+    std::string directory;
+    std::string key = watchKey(path, &directory);
+    if (hotReload.watchedFiles.count(key)) {
+        return;
+    }
+    struct stat info;
+    hotReload.watchedFiles[key] = stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+#ifdef __linux__
+    if (hotReload.inotifyFd >= 0 && !hotReload.watchDirectories.count(directory)) {
+        int watch = inotify_add_watch(hotReload.inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        hotReload.watchDirectories[directory] = watch;
+        if (watch >= 0) {
+            hotReload.watchNames[watch] = directory;
+        }
+    }
+#endif
+}
+
+// Arquivo de configuracao mais os OBJ, MTL e texturas de todos os objetos da cena
+static void hotReloadWatchAssets() {
+    hotReload.watchedFiles.clear();
+    hotReloadWatch(hotReload.path);
+    for (size_t i = 0; i < sceneConfig.objects.size() && i < hotReload.objectModel.size(); i++) {
+        int index = hotReload.objectModel[i];
+        if (index < 0) continue;
+        hotReloadWatch(sceneConfig.objects[i].filename);
+        hotReloadWatch(getMTLFilename(sceneConfig.objects[i].filename));
+        for (const Material& material : models[index].materials) {
+            if (!material.texturePath.empty()) hotReloadWatch(material.texturePath);
+        }
+    }
+}
+
+// Animacao igual a do arquivo anterior: o objeto mantem o estado (cursor, pista resolvida)
+static bool sameAnimation(const ObjectAnimation& a, const ObjectAnimation& b) {
+    if (a.type != b.type || a.timeOffset != b.timeOffset) {
+        return false;
+    }
+    switch (a.type) {
+    case ANIM_BEZIER:
+        return a.bezier.p0 == b.bezier.p0 && a.bezier.p1 == b.bezier.p1 && a.bezier.p2 == b.bezier.p2 &&
+               a.bezier.p3 == b.bezier.p3 && a.bezier.duration == b.bezier.duration && a.bezier.loop == b.bezier.loop;
+    case ANIM_BEZIER_TRACK:
+        return a.bezierTrack == b.bezierTrack && a.trackFromMesh == b.trackFromMesh;
+    case ANIM_ORBIT:
+        return a.orbit.center == b.orbit.center && a.orbit.radius == b.orbit.radius &&
+               a.orbit.speed == b.orbit.speed && a.orbit.axis == b.orbit.axis;
+    case ANIM_LINEAR:
+        return a.keyframes == b.keyframes;
+    default:
+        return true;
+    }
+}
+
+// Inicia a carga em fundo; ready marca o fim (uma recarga por vez). A thread anterior pode
+// ainda estar na limpeza da ultima troca (hotReloadApply): espera por ela.
+static void hotReloadLaunch(std::function<void()> task) {
+    if (hotReload.worker.joinable()) {
+        hotReload.worker.join();
+    }
+    hotReload.ready = false;
+    hotReload.worker = std::thread([task]() {
+        task();
+        hotReload.ready.store(true, std::memory_order_release);
+    });
+}
+
+// Matriz de modelo da posicao dada no arquivo de configuracao
+static mat4 objectConfigMatrix(const SceneConfig::ObjectConfig& object) {
+    Model placement;
+    placement.position = object.position;
+    placement.rotation = object.rotation;
+    placement.scale = object.scale;
+    return computeModelMatrix(placement);
+}
+
+// Thread de fundo: le a configuracao e casa cada objeto novo com um atual do mesmo asset
+// (o n-esimo objeto novo de um asset fica com o n-esimo atual, entao inserir ou remover
+// no meio nao mexe nos outros). So le do disco assets que nao estao na cena. Tambem monta
+// a hierarquia da cena nova e ajusta a linha da pista, para a troca so mover ponteiros.
+// Enquanto roda, o thread principal nao altera sceneConfig.objects, hotReload.objectModel
+// nem as partes dos modelos (lidas pelo grafo e pela linha da pista).
+static void hotReloadLoad(SceneReload& reload) {
+    PROFILE_SCOPE("Hot reload load");
+    evictChangedAnimationFiles();
+    if (!loadSceneConfig(hotReload.path, reload.config)) {
+        return;
+    }
+    const std::vector<SceneConfig::ObjectConfig>& before = sceneConfig.objects;
+    const std::vector<SceneConfig::ObjectConfig>& after = reload.config.objects;
+
+    std::unordered_map<std::string, std::vector<int>> current;
+    for (size_t i = 0; i < before.size() && i < hotReload.objectModel.size(); i++) {
+        if (hotReload.objectModel[i] >= 0) {
+            current[sceneAssetKey(before[i])].push_back((int)i);
+        }
+    }
+    std::unordered_map<std::string, size_t> taken;
+    std::unordered_map<std::string, int> readHere;
+
+    size_t count = after.size();
+    reload.reuse.assign(count, -1);
+    reload.cloneModel.assign(count, -1);
+    reload.cloneLoaded.assign(count, -1);
+    reload.loaded.resize(count);
+    reload.loadedOk.assign(count, 0);
+    reload.staging.resize(count);
+
+    for (size_t j = 0; j < count; j++) {
+        std::string key = sceneAssetKey(after[j]);
+        auto existing = current.find(key);
+        if (existing != current.end()) {
+            size_t& next = taken[key];
+            if (next < existing->second.size()) {
+                reload.reuse[j] = existing->second[next++];
+            } else {
+                reload.cloneModel[j] = hotReload.objectModel[existing->second.front()];
+                reload.loadedOk[j] = 1;
+            }
+            continue;
+        }
+        auto read = readHere.find(key);
+        if (read != readHere.end()) {
+            reload.cloneLoaded[j] = read->second;
+            reload.loadedOk[j] = reload.loadedOk[read->second];
+            continue;
+        }
+        assetStaging = &reload.staging[j];
+        bool loaded = loadSceneObject(after[j], reload.loaded[j]);
+        assetStaging = nullptr;
+        if (loaded) {
+            computeModelBounds(reload.loaded[j]);
+        }
+        reload.loadedOk[j] = loaded;
+        readHere[key] = (int)j;
+        reload.readCount++;
+    }
+
+    // Indices na cena nova na mesma ordem de hotReloadApply: so entra quem tem malha
+    std::vector<SceneGraphSource> sources;
+    std::vector<int> nextIndex(count, -1);
+    int trackObject = -1, trackLoaded = -1;
+    const Model* trackMesh = nullptr;
+    bool trackNeeded = false, trackConsumer = false;
+    for (size_t j = 0; j < count; j++) {
+        int oldObject = reload.reuse[j];
+        if (oldObject < 0 && !reload.loadedOk[j]) continue;
+        int loadedIndex = reload.cloneLoaded[j] >= 0 ? reload.cloneLoaded[j] : (int)j;
+        const Model* mesh = &reload.loaded[loadedIndex];
+        if (oldObject >= 0) {
+            mesh = &models[hotReload.objectModel[oldObject]];
+            loadedIndex = -1;
+        } else if (reload.cloneModel[j] >= 0) {
+            mesh = &models[reload.cloneModel[j]];
+            loadedIndex = -1;
+        }
+        SceneGraphSource source;
+        source.parent = after[j].parent >= 0 ? nextIndex[after[j].parent] : -1;
+        source.mesh = mesh;
+        source.partNodes = &after[j].partNodes;
+        source.name = &after[j].filename;
+        nextIndex[j] = (int)sources.size();
+        sources.push_back(source);
+
+        // Animacao mantida fica com a linha que ja tem
+        trackConsumer = trackConsumer || after[j].animation.trackFromMesh;
+        trackNeeded = trackNeeded || (after[j].animation.trackFromMesh &&
+                                      !(oldObject >= 0 && sameAnimation(before[oldObject].animation, after[j].animation)));
+        if (!trackMesh && hasAsphaltPart(*mesh)) {
+            trackMesh = mesh;
+            trackObject = (int)j;
+            trackLoaded = loadedIndex;
+        }
+    }
+    // Malha lida agora: marcada antes do upload, que solta as copias (releaseMeshCopies)
+    if (trackConsumer && trackLoaded >= 0) {
+        keepTrackPositions(reload.loaded[trackLoaded]);
+    }
+    buildSceneGraphNodes(sources, reload.graph);
+    reload.parents.resize(sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        reload.parents[i] = sources[i].parent;
+    }
+    if (trackNeeded) {
+        reload.racingLine = trackMesh ? meshRacingLine(*trackMesh, after[trackObject].filename, objectConfigMatrix(after[trackObject]))
+                                      : builtinDriftTrack();
+    }
+    reload.ok = true;
+}
+
+// O que a troca deixou para tras: destruido na thread de fundo, junto com o malloc_trim
+struct RetiredScene {
+    std::vector<Model> models;
+    std::vector<ObjectAnimation> animations;
+    SceneConfig config;
+    SceneGraph graph;
+};
+
+// Troca a cena em um frame: modelos mantidos so recebem o que mudou no arquivo (o que o
+// usuario moveu pelo teclado continua onde esta), novos entram e removidos liberam a GPU.
+// Grafo e linha da pista chegam prontos de hotReloadLoad; a limpeza fica para o fundo.
+static void hotReloadApply(SceneReload& reload) {
+    PROFILE_SCOPE("Hot reload apply");
+    const std::vector<SceneConfig::ObjectConfig>& before = sceneConfig.objects;
+    const std::vector<SceneConfig::ObjectConfig>& after = reload.config.objects;
+
+    // Os nos de parte da cena atual deixam de valer; os novos vem de reload.graph
+    for (const SceneNode& node : sceneGraph.nodes) {
+        if (node.part >= 0) {
+            models[node.model].parts[node.part].node = -1;
+        }
+    }
+
+    std::vector<Model> nextModels;
+    std::vector<ObjectAnimation> nextAnimations;
+    std::vector<int> objectModel(after.size(), -1);
+    std::vector<char> kept(models.size(), 0);
+    nextModels.reserve(after.size());
+    nextAnimations.reserve(after.size());
+    int selected = 0;
+    size_t moved = 0, added = 0;
+
+    for (size_t j = 0; j < after.size(); j++) {
+        const SceneConfig::ObjectConfig& objConfig = after[j];
+        int oldObject = reload.reuse[j];
+        if (oldObject >= 0) {
+            const SceneConfig::ObjectConfig& previous = before[oldObject];
+            int index = hotReload.objectModel[oldObject];
+            Model& model = models[index];
+            bool changed = false;
+            if (previous.position != objConfig.position) { model.position = objConfig.position; changed = true; }
+            if (previous.rotation != objConfig.rotation) { model.rotation = objConfig.rotation; changed = true; }
+            if (previous.scale != objConfig.scale) { model.scale = objConfig.scale; changed = true; }
+            moved += changed;
+            nextAnimations.push_back(sameAnimation(previous.animation, objConfig.animation) ? objectAnimations[index]
+                                                                                            : objConfig.animation);
+            kept[index] = 1;
+            if (index == selectedModelIndex) {
+                selected = (int)nextModels.size();
+            }
+            nextModels.push_back(std::move(model));
+        } else if (reload.loadedOk[j]) {
+            Model& model = reload.loaded[j];
+            model.name = objConfig.filename;
+            model.position = objConfig.position;
+            model.rotation = objConfig.rotation;
+            model.scale = objConfig.scale;
+            retainModelGpu(model);
+            nextAnimations.push_back(objConfig.animation);
+            nextModels.push_back(std::move(model));
+            added++;
+        } else {
+            continue;
+        }
+        Model& model = nextModels.back();
+        objectModel[j] = (int)nextModels.size() - 1;
+        model.parent = reload.parents[objectModel[j]];
+        model.partNodes = objConfig.partNodes;
+    }
+
+    size_t dropped = 0;
+    for (size_t i = 0; i < models.size(); i++) {
+        if (!kept[i]) {
+            releaseModelGpu(models[i]);
+            dropped++;
+        }
+    }
+
+    std::shared_ptr<RetiredScene> retired = std::make_shared<RetiredScene>();
+    models.swap(nextModels);
+    retired->models.swap(nextModels);
+    objectAnimations.swap(nextAnimations);
+    retired->animations.swap(nextAnimations);
+    hotReload.objectModel.swap(objectModel);
+    retired->graph.nodes.swap(sceneGraph.nodes);
+    retired->graph.modelNode.swap(sceneGraph.modelNode);
+    sceneGraph.nodes.swap(reload.graph.nodes);
+    sceneGraph.modelNode.swap(reload.graph.modelNode);
+    assignPartNodes(sceneGraph, models);
+    selectedModelIndex = selected;
+
+    // Câmera so se mudou no arquivo (senao continua onde o usuario deixou)
+    if (reload.config.camera.position != sceneConfig.camera.position ||
+        reload.config.camera.target != sceneConfig.camera.target) {
+        camera.position = reload.config.camera.position;
+        camera.target = reload.config.camera.target;
+    }
+    if (reload.config.lights.empty()) {
+        addDefaultLights(reload.config);
+    }
+    retired->config = std::move(sceneConfig);
+    sceneConfig = std::move(reload.config);
+
+    if (reload.racingLine) {
+        for (ObjectAnimation& animation : objectAnimations) {
+            if (animation.trackFromMesh && !animation.bezierTrack) {
+                animation.bezierTrack = reload.racingLine;
+            }
+        }
+    }
+    animationBatches.valid = false;
+    simulation.primed = false;
+    hotReloadWatchAssets();
+    hotReloadLaunch([retired]() {
+        PROFILE_SCOPE("Hot reload cleanup");
+        *retired = RetiredScene();
+        trimHeap();
+    });
+
+    double elapsedMs = (glfwGetTime() - reload.startTime) * 1000.0;
+    LOG_INFO("Hot reload: " << models.size() << " objetos (" << models.size() - added << " mantidos, " << moved
+             << " movidos, " << added << " novos com " << reload.readCount << " assets lidos, " << dropped
+             << " removidos), " << sceneConfig.lights.size() << " luzes em " << elapsedMs << " ms");
+}
+
+// Thread de fundo: reconstroi as malhas alteradas pelos loaders de sempre e decodifica as
+// texturas alteradas. Com as malhas novas monta a hierarquia e, se a pista mudou, ajusta a
+// linha dela. Nada da cena e tocado ate a troca no thread principal.
+static void assetReloadLoad(AssetReload& reload) {
+    PROFILE_SCOPE("Asset reload load");
+    reload.rebuilt.resize(reload.meshes.size());
+    reload.meshOk.assign(reload.meshes.size(), 0);
+    reload.staging.resize(reload.meshes.size());
+    std::unordered_map<std::string, size_t> rebuiltIndex;
+    for (size_t i = 0; i < reload.meshes.size(); i++) {
+        assetStaging = &reload.staging[i];
+        bool loaded = loadSceneObject(reload.meshes[i], reload.rebuilt[i]);
+        assetStaging = nullptr;
+        if (loaded) {
+            computeModelBounds(reload.rebuilt[i]);
+            rebuiltIndex[sceneAssetKey(reload.meshes[i])] = i;
+        }
+        reload.meshOk[i] = loaded;
+    }
+
+    if (!rebuiltIndex.empty()) {
+        // Malha de cada modelo depois da troca; a pista e a primeira com Asphalt, como na carga
+        std::vector<SceneGraphSource> sources(models.size());
+        for (size_t i = 0; i < models.size(); i++) {
+            sources[i].parent = models[i].parent;
+            sources[i].mesh = &models[i];
+            sources[i].partNodes = &models[i].partNodes;
+            sources[i].name = &models[i].name;
+        }
+        const SceneConfig::ObjectConfig* trackObject = nullptr;
+        const Model* trackMesh = nullptr;
+        int trackRebuilt = -1;
+        bool trackTouched = false;
+        for (size_t j = 0; j < sceneConfig.objects.size() && j < hotReload.objectModel.size(); j++) {
+            int index = hotReload.objectModel[j];
+            if (index < 0) continue;
+            auto found = rebuiltIndex.find(sceneAssetKey(sceneConfig.objects[j]));
+            if (found != rebuiltIndex.end()) {
+                const Model& rebuilt = reload.rebuilt[found->second];
+                trackTouched = trackTouched || hasAsphaltPart(models[index]) || hasAsphaltPart(rebuilt);
+                sources[index].mesh = &rebuilt;
+            }
+            if (!trackMesh && hasAsphaltPart(*sources[index].mesh)) {
+                trackMesh = sources[index].mesh;
+                trackObject = &sceneConfig.objects[j];
+                trackRebuilt = found != rebuiltIndex.end() ? (int)found->second : -1;
+            }
+        }
+        if (reload.racingLineNeeded && trackRebuilt >= 0) {
+            keepTrackPositions(reload.rebuilt[trackRebuilt]);
+        }
+        buildSceneGraphNodes(sources, reload.graph);
+        reload.parents.resize(sources.size());
+        for (size_t i = 0; i < sources.size(); i++) {
+            reload.parents[i] = sources[i].parent;
+        }
+        if (reload.racingLineNeeded && trackTouched) {
+            reload.racingLine = trackMesh ? meshRacingLine(*trackMesh, trackObject->filename, objectConfigMatrix(*trackObject))
+                                          : builtinDriftTrack();
+        }
+    }
+    reload.images.resize(reload.textures.size());
+    for (size_t i = 0; i < reload.textures.size(); i++) {
+        StagedTexture& image = reload.images[i];
+        PROFILE_SCOPE("Texture decode");
+        image.pixels = stbi_load(reload.textures[i].c_str(), &image.width, &image.height, &image.channels, 0);
+    }
+}
+
+// Troca atomica (um frame): todo modelo do asset passa a usar as partes novas e cada parte
+// com a textura alterada passa a usar a nova; as referencias antigas sao soltas
+static void assetReloadApply(AssetReload& reload) {
+    PROFILE_SCOPE("Asset reload apply");
+    size_t affected = 0, failed = 0;
+    bool meshesChanged = false;
+
+    if (!reload.graph.modelNode.empty()) {
+        for (const SceneNode& node : sceneGraph.nodes) {
+            if (node.part >= 0) {
+                models[node.model].parts[node.part].node = -1;
+            }
+        }
+    }
+    for (size_t i = 0; i < reload.meshes.size(); i++) {
+        if (!reload.meshOk[i]) {
+            LOG_WARN("Hot reload: falha ao reconstruir " << reload.meshes[i].filename << ", versao anterior mantida");
+            failed++;
+            continue;
+        }
+        Model& rebuilt = reload.rebuilt[i];
+        retainModelGpu(rebuilt);
+        std::string key = sceneAssetKey(reload.meshes[i]);
+        for (size_t j = 0; j < sceneConfig.objects.size() && j < hotReload.objectModel.size(); j++) {
+            int index = hotReload.objectModel[j];
+            if (index < 0 || sceneAssetKey(sceneConfig.objects[j]) != key) continue;
+            releaseModelGpu(models[index]);
+            models[index].parts = rebuilt.parts;
+            models[index].materials = rebuilt.materials;
+            retainModelGpu(models[index]);
+            affected++;
+        }
+        releaseModelGpu(rebuilt);
+        meshesChanged = true;
+    }
+
+    for (size_t i = 0; i < reload.textures.size(); i++) {
+        GLuint textureID = reload.uploadedTextures[i];
+        if (textureID == 0) {
+            LOG_WARN("Hot reload: falha ao decodificar " << reload.textures[i] << ", versao anterior mantida");
+            failed++;
+            continue;
+        }
+        std::string key = watchKey(reload.textures[i]);
+        gpuRefs.textures[textureID]++;
+        for (Model& model : models) {
+            bool uses = false;
+            for (Material& material : model.materials) {
+                if (material.texturePath.empty() || watchKey(material.texturePath) != key) continue;
+                releaseGpuObject(gpuRefs.textures, material.textureID, deleteTexture);
+                material.textureID = textureID;
+                gpuRefs.textures[textureID]++;
+                uses = true;
+            }
+            affected += uses;
+        }
+        releaseGpuObject(gpuRefs.textures, textureID, deleteTexture);
+    }
+
+    // Partes novas: os nos de parte (PART) apontam para indices de parte. Grafo e linha da
+    // pista vem prontos de assetReloadLoad.
+    if (meshesChanged) {
+        sceneGraph.nodes.swap(reload.graph.nodes);
+        sceneGraph.modelNode.swap(reload.graph.modelNode);
+        for (size_t i = 0; i < models.size(); i++) {
+            models[i].parent = reload.parents[i];
+        }
+        assignPartNodes(sceneGraph, models);
+        hotReloadWatchAssets();
+    }
+    if (reload.racingLine) {
+        for (ObjectAnimation& animation : objectAnimations) {
+            if (animation.trackFromMesh) {
+                animation.bezierTrack = reload.racingLine;
+            }
+        }
+        animationBatches.valid = false;
+        simulation.primed = false;
+    }
+    double elapsedMs = (glfwGetTime() - reload.startTime) * 1000.0;
+    LOG_INFO("Hot reload de assets: " << reload.meshes.size() << " malhas, " << reload.textures.size()
+             << " texturas (" << failed << " falhas), " << affected << " objetos afetados em " << elapsedMs << " ms");
+}
+
+// Monta a recarga dos arquivos alterados: malhas cujo OBJ ou MTL mudou (uma vez por asset,
+// mesmo com varios objetos) e texturas usadas por alguma parte
+static AssetReload* createAssetReload(const std::set<std::string>& changed) {
+    AssetReload* reload = new AssetReload();
+    std::set<std::string> meshKeys, textureKeys;
+    for (size_t i = 0; i < sceneConfig.objects.size() && i < hotReload.objectModel.size(); i++) {
+        int index = hotReload.objectModel[i];
+        if (index < 0) continue;
+        const SceneConfig::ObjectConfig& object = sceneConfig.objects[i];
+        if ((changed.count(watchKey(object.filename)) || changed.count(watchKey(getMTLFilename(object.filename)))) &&
+            meshKeys.insert(sceneAssetKey(object)).second) {
+            reload->meshes.push_back(object);
+        }
+        for (const Material& material : models[index].materials) {
+            const std::string& path = material.texturePath;
+            if (!path.empty() && changed.count(watchKey(path)) && textureKeys.insert(watchKey(path)).second) {
+                reload->textures.push_back(path);
+            }
+        }
+    }
+    if (reload->meshes.empty() && reload->textures.empty()) {
+        delete reload;
+        return nullptr;
+    }
+    for (const ObjectAnimation& animation : objectAnimations) {
+        reload->racingLineNeeded = reload->racingLineNeeded || animation.trackFromMesh;
+    }
+    return reload;
+}
+
+// Observa o arquivo de configuracao e os assets da cena (diretorios no inotify: editores
+// costumam gravar um temporario e renomear por cima)
+void hotReloadStart(const std::string& path) {
+    if (path.empty()) {
+        return;
+    }
+    hotReload.path = path;
+    hotReload.configKey = watchKey(path);
+#ifdef __linux__
+    hotReload.inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    hotReloadWatchAssets();
+    LOG_INFO("Hot reload: observando " << path << " e " << hotReload.watchedFiles.size() - 1 << " assets"
+             << (hotReload.inotifyFd >= 0 ? " (inotify)" : " (mtime)"));
+}
+
+// Junta em changedFiles os arquivos observados gravados desde a ultima chamada
+static bool hotReloadCollectChanges(double now) {
+    size_t before = hotReload.changedFiles.size();
+#ifdef __linux__
+    if (hotReload.inotifyFd >= 0) {
+        alignas(struct inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(hotReload.inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < length;) {
+                const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+                offset += sizeof(struct inotify_event) + event->len;
+                auto directory = hotReload.watchNames.find(event->wd);
+                if (event->len == 0 || directory == hotReload.watchNames.end()) continue;
+                std::string key = directory->second + "/" + event->name;
+                if (hotReload.watchedFiles.count(key)) {
+                    hotReload.changedFiles.insert(key);
+                }
+            }
+        }
+        return hotReload.changedFiles.size() > before;
+    }
+#endif
+    if (now - hotReload.lastPoll < HOT_RELOAD_POLL_SECONDS) {
+        return false;
+    }
+    hotReload.lastPoll = now;
+    for (auto& file : hotReload.watchedFiles) {
+        struct stat info;
+        if (stat(file.first.c_str(), &info) == 0 && info.st_mtime != file.second) {
+            file.second = info.st_mtime;
+            hotReload.changedFiles.insert(file.first);
+        }
+    }
+    return hotReload.changedFiles.size() > before;
+}
+
+// Upload dos modelos novos da recarga da configuracao; false = continua no proximo frame
+static bool uploadSceneReload(SceneReload& reload, std::chrono::steady_clock::time_point deadline) {
+    for (; reload.uploadObject < reload.loaded.size(); reload.uploadObject++, reload.uploadPart = 0) {
+        size_t j = reload.uploadObject;
+        if (!reload.loadedOk[j]) continue;
+        Model& model = reload.loaded[j];
+        if (model.parts.empty()) {
+            if (reload.cloneModel[j] >= 0) {
+                cloneModelParts(models[reload.cloneModel[j]], model);
+            } else if (reload.cloneLoaded[j] >= 0) {
+                cloneModelParts(reload.loaded[reload.cloneLoaded[j]], model);
             }
-            
-            config.objects.push_back(obj);
         }
+        if (!uploadStagedModel(model, reload.staging[j], reload.uploadPart, deadline)) {
+            return false;
+        }
+        releaseMeshCopies(model);
     }
-    
-    file.close();
     return true;
 }
 
+// Upload das malhas e texturas reconstruidas; false = continua no proximo frame
+static bool uploadAssetReload(AssetReload& reload, std::chrono::steady_clock::time_point deadline) {
+    for (; reload.uploadMesh < reload.rebuilt.size(); reload.uploadMesh++, reload.uploadPart = 0) {
+        if (!reload.meshOk[reload.uploadMesh]) continue;
+        Model& rebuilt = reload.rebuilt[reload.uploadMesh];
+        if (!uploadStagedModel(rebuilt, reload.staging[reload.uploadMesh], reload.uploadPart, deadline)) {
+            return false;
+        }
+        releaseMeshCopies(rebuilt);
+    }
+    while (reload.uploadedTextures.size() < reload.images.size()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        StagedTexture& image = reload.images[reload.uploadedTextures.size()];
+        reload.uploadedTextures.push_back(image.pixels ? createTexture(image.pixels, image.width, image.height, image.channels) : 0);
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+    }
+    return true;
+}
+
+// Chamado uma vez por frame. Retorna true no frame em que uma configuracao nova foi aplicada.
+bool hotReloadPoll() {
+    if (hotReload.path.empty()) {
+        return false;
+    }
+    double now = glfwGetTime();
+    if (hotReloadCollectChanges(now)) {
+        hotReload.changedAt = now;
+    }
+
+    SceneReload* sceneReload = hotReload.pending.get();
+    AssetReload* assetReload = hotReload.pendingAssets.get();
+    if (sceneReload == nullptr && assetReload == nullptr) {
+        if (hotReload.changedFiles.empty() || now - hotReload.changedAt < HOT_RELOAD_SETTLE_SECONDS) {
+            return false;
+        }
+        // A configuracao tem prioridade; assets alterados ficam para a rodada seguinte
+        if (hotReload.changedFiles.erase(hotReload.configKey)) {
+            hotReload.pending.reset(new SceneReload());
+            hotReload.pending->startTime = now;
+            SceneReload* target = hotReload.pending.get();
+            hotReloadLaunch([target]() { hotReloadLoad(*target); });
+        } else {
+            hotReload.pendingAssets.reset(createAssetReload(hotReload.changedFiles));
+            hotReload.changedFiles.clear();
+            if (hotReload.pendingAssets) {
+                hotReload.pendingAssets->startTime = now;
+                AssetReload* target = hotReload.pendingAssets.get();
+                hotReloadLaunch([target]() { assetReloadLoad(*target); });
+            }
+        }
+        return false;
+    }
+    if (!hotReload.ready.load(std::memory_order_acquire)) {
+        return false;
+    }
+    if (hotReload.worker.joinable()) {
+        hotReload.worker.join();
+    }
+
+    // Upload em fatias de tempo; a troca so acontece quando tudo ja esta na GPU
+    PROFILE_SCOPE("Hot reload upload");
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds((long long)(HOT_RELOAD_UPLOAD_BUDGET_MS * 1000.0));
+    if (assetReload) {
+        if (!uploadAssetReload(*assetReload, deadline)) {
+            return false;
+        }
+        assetReloadApply(*assetReload);
+        hotReload.pendingAssets.reset();
+        return false;
+    }
+    if (!sceneReload->ok) {
+        LOG_WARN("Hot reload: nao foi possivel ler " << hotReload.path << ", cena mantida");
+        hotReload.pending.reset();
+        return false;
+    }
+    if (!uploadSceneReload(*sceneReload, deadline)) {
+        return false;
+    }
+    hotReloadApply(*sceneReload);
+    hotReload.pending.reset();
+    return true;
+}
+
+// Solta modelos de uma recarga interrompida que nunca foram retidos: retem todos antes de
+// soltar, para que o compartilhado entre eles ou com a cena so seja apagado uma vez
+static void releaseUnretainedModels(std::vector<Model>& pendingModels) {
+    for (const Model& model : pendingModels) {
+        retainModelGpu(model);
+    }
+    for (Model& model : pendingModels) {
+        releaseModelGpu(model);
+    }
+}
+
+// Encerra o watcher; uma recarga pela metade libera o que ja tinha ido para a GPU
+void hotReloadStop() {
+    if (hotReload.worker.joinable()) {
+        hotReload.worker.join();
+    }
+    if (hotReload.pending) {
+        releaseUnretainedModels(hotReload.pending->loaded);
+        for (AssetStaging& staging : hotReload.pending->staging) {
+            for (StagedTexture& texture : staging.textures) stbi_image_free(texture.pixels);
+        }
+        hotReload.pending.reset();
+    }
+    if (hotReload.pendingAssets) {
+        AssetReload& reload = *hotReload.pendingAssets;
+        releaseUnretainedModels(reload.rebuilt);
+        for (AssetStaging& staging : reload.staging) {
+            for (StagedTexture& texture : staging.textures) stbi_image_free(texture.pixels);
+        }
+        for (size_t i = reload.uploadedTextures.size(); i < reload.images.size(); i++) {
+            stbi_image_free(reload.images[i].pixels);
+        }
+        for (GLuint texture : reload.uploadedTextures) {
+            if (texture != 0) deleteTexture(texture);
+        }
+        hotReload.pendingAssets.reset();
+    }
+#ifdef __linux__
+    if (hotReload.inotifyFd >= 0) {
+        close(hotReload.inotifyFd);
+        hotReload.inotifyFd = -1;
+    }
+#endif
+    hotReload.path.clear();
+}
+
 Material createMaterial(const std::string& materialType) {
     Material material;
     material.name = materialType; // Definir o nome do material
@@ -1531,72 +6465,684 @@ void updateAnimations(float deltaTime) {
     animationTime += deltaTime;
 }
 
-void applyAnimationsToModels() {
-    // Aplicar animacões a todos os modelos
+static void captureSnapshots(std::vector<TransformSnapshot>& snapshots) {
+    snapshots.resize(models.size());
+    for (size_t i = 0; i < models.size(); i++) {
+        snapshots[i] = { models[i].position, models[i].rotation, models[i].scale };
+    }
+}
+
+// Interpola angulos em graus pelo menor caminho (ex.: 350 -> 10 passa por 0)
+static glm::vec3 mixAngles(const glm::vec3& a, const glm::vec3& b, float t) {
+    glm::vec3 delta = b - a;
+    for (int axis = 0; axis < 3; axis++) {
+        delta[axis] = fmod(fmod(delta[axis], 360.0f) + 540.0f, 360.0f) - 180.0f;
+    }
+    return a + delta * t;
+}
+
+// Avanca a simulacao em passos fixos com o tempo acumulado do frame e escreve nos
+// modelos animados a transformacao interpolada para o render
+void updateSimulation(float frameDelta) {
+    PROFILE_SCOPE("Simulation");
+    FixedStepSimulation& sim = simulation;
+    float step = 1.0f / sim.hz;
+
+    AnimationBatches& batches = animationBatches;
+    if (!sim.primed || sim.current.size() != models.size() || !batches.valid) {
+        simulateAnimations();
+        captureSnapshots(sim.current);
+        sim.previous = sim.current;
+        batches.bezierPrevious = batches.bezierCurrent;
+        batches.orbitPrevious = batches.orbitCurrent;
+        sim.accumulator = 0.0f;
+        sim.primed = true;
+    }
+
+    // Os lotes Bézier/orbital guardam o proprio estado em SoA; os snapshots cobrem o resto
+    sim.accumulator += frameDelta;
+    int steps = 0;
+    while (sim.accumulator >= step && steps < sim.maxStepsPerFrame) {
+        sim.previous.swap(sim.current);
+        std::swap(batches.bezierPrevious, batches.bezierCurrent);
+        std::swap(batches.orbitPrevious, batches.orbitCurrent);
+        updateAnimations(step);
+        simulateAnimations();
+        captureSnapshots(sim.current);
+        sim.accumulator -= step;
+        steps++;
+    }
+    if (steps == sim.maxStepsPerFrame) {
+        sim.accumulator = std::min(sim.accumulator, step);  // Descarta o atraso restante
+    }
+    sim.alpha = std::min(sim.accumulator / step, 1.0f);
+
+    // So os modelos animados: os estaticos podem estar sendo movidos pelo usuario
+    writeBatchedTransforms(sim.alpha);
     for (size_t i = 0; i < models.size() && i < objectAnimations.size(); i++) {
-        ObjectAnimation& anim = objectAnimations[i];
+        AnimationType type = objectAnimations[i].type;
+        if (type == ANIM_NONE || type == ANIM_BEZIER || type == ANIM_ORBIT) {
+            continue;
+        }
+        const TransformSnapshot& a = sim.previous[i];
+        const TransformSnapshot& b = sim.current[i];
+        models[i].position = glm::mix(a.position, b.position, sim.alpha);
+        models[i].rotation = mixAngles(a.rotation, b.rotation, sim.alpha);
+        models[i].scale = glm::mix(a.scale, b.scale, sim.alpha);
+    }
+}
+
+// Monta os lotes SoA a partir das animacoes dos primeiros count objetos
+void buildAnimationBatches(const std::vector<ObjectAnimation>& animations, size_t count, AnimationBatches& batches) {
+    const int W = SimdFloat::WIDTH;
+    batches = AnimationBatches();
+    BezierBatch& bezier = batches.bezier;
+    OrbitBatch& orbit = batches.orbit;
+
+    for (size_t i = 0; i < count && i < animations.size(); i++) {
+        const ObjectAnimation& anim = animations[i];
+        float spinRate = 30.0f + i * 15.0f;   // Mesma rotacao automatica de antes por objeto
+        float wobblePhase = (float)i;
+        if (anim.type == ANIM_BEZIER) {
+            const glm::vec3 points[4] = { anim.bezier.p0, anim.bezier.p1, anim.bezier.p2, anim.bezier.p3 };
+            for (int k = 0; k < 12; k++) bezier.control[k].push_back(points[k / 3][k % 3]);
+            bezier.invDuration.push_back(anim.bezier.duration > 0.0f ? 1.0f / anim.bezier.duration : 0.0f);
+            bezier.timeOffset.push_back(anim.timeOffset);
+            bezier.loop.push_back(anim.bezier.loop ? 1.0f : 0.0f);
+            bezier.spinRate.push_back(spinRate);
+            bezier.wobblePhase.push_back(wobblePhase);
+            bezier.modelIndex.push_back((int)i);
+        } else if (anim.type == ANIM_ORBIT) {
+            // Base do plano: XZ (eixo Y, padrao), XY (eixo Z) ou YZ (eixo X)
+            glm::vec3 u(1.0f, 0.0f, 0.0f), v(0.0f, 0.0f, 1.0f);
+            if (anim.orbit.axis.y <= 0.9f) {
+                if (anim.orbit.axis.z > 0.9f) { v = glm::vec3(0.0f, 1.0f, 0.0f); }
+                else { u = glm::vec3(0.0f, 1.0f, 0.0f); }
+            }
+            for (int k = 0; k < 3; k++) {
+                orbit.center[k].push_back(anim.orbit.center[k]);
+                orbit.axisU[k].push_back(u[k]);
+                orbit.axisV[k].push_back(v[k]);
+            }
+            orbit.radius.push_back(anim.orbit.radius);
+            orbit.angularSpeed.push_back(anim.orbit.speed * (float)(M_PI / 180.0));
+            orbit.timeOffset.push_back(anim.timeOffset);
+            orbit.spinRate.push_back(spinRate);
+            orbit.wobblePhase.push_back(wobblePhase);
+            orbit.modelIndex.push_back((int)i);
+        } else if (anim.type == ANIM_BEZIER_TRACK) {
+            batches.tracks.push_back((int)i);
+        } else if (anim.type == ANIM_LINEAR && anim.keyframes) {
+            batches.keyframed.push_back((int)i);
+        }
+    }
+
+    // Completa ate multiplo da largura SIMD (o kernel nao precisa de laco de sobra)
+    size_t bezierSize = (bezier.modelIndex.size() + W - 1) / W * W;
+    for (auto& array : bezier.control) array.resize(bezierSize, 0.0f);
+    bezier.invDuration.resize(bezierSize, 0.0f);
+    bezier.timeOffset.resize(bezierSize, 0.0f);
+    bezier.loop.resize(bezierSize, 0.0f);
+    bezier.spinRate.resize(bezierSize, 0.0f);
+    bezier.wobblePhase.resize(bezierSize, 0.0f);
+    bezier.modelIndex.resize(bezierSize, -1);
+
+    size_t orbitSize = (orbit.modelIndex.size() + W - 1) / W * W;
+    for (int k = 0; k < 3; k++) {
+        orbit.center[k].resize(orbitSize, 0.0f);
+        orbit.axisU[k].resize(orbitSize, 0.0f);
+        orbit.axisV[k].resize(orbitSize, 0.0f);
+    }
+    orbit.radius.resize(orbitSize, 0.0f);
+    orbit.angularSpeed.resize(orbitSize, 0.0f);
+    orbit.timeOffset.resize(orbitSize, 0.0f);
+    orbit.spinRate.resize(orbitSize, 0.0f);
+    orbit.wobblePhase.resize(orbitSize, 0.0f);
+    orbit.modelIndex.resize(orbitSize, -1);
+
+    batches.bezierCurrent.resize(bezierSize);
+    batches.bezierPrevious.resize(bezierSize);
+    batches.orbitCurrent.resize(orbitSize);
+    batches.orbitPrevious.resize(orbitSize);
+
+    batches.sourceCount = count;
+    batches.valid = true;
+}
+
+// Rotacao automatica comum as animacoes Bézier e orbital: Y gira sem parar (mod 360) e
+// X oscila 15 graus
+static inline void animationSpin(SimdFloat time, SimdFloat spinRate, SimdFloat wobblePhase,
+                                 SimdFloat& rotationX, SimdFloat& rotationY) {
+    rotationY = time * spinRate;
+    rotationY = rotationY - simdFloor(rotationY * (1.0f / 360.0f)) * 360.0f;
+    rotationX = simdSin(time * 2.0f + wobblePhase) * 15.0f;
+}
+
+// Avalia WIDTH curvas por iteracao e grava direto no buffer SoA de transformacoes
+// begin deve ser multiplo de SimdFloat::WIDTH (pedacos do parallelFor)
+void updateBezierBatch(const BezierBatch& batch, float time, AnimationStream& out, size_t begin, size_t end) {
+    const int W = SimdFloat::WIDTH;
+    SimdFloat timeV(time);
+    end = std::min(end, batch.modelIndex.size());
+    for (size_t i = begin; i < end; i += W) {
+        SimdFloat x = (timeV + SimdFloat::load(&batch.timeOffset[i])) * SimdFloat::load(&batch.invDuration[i]);
+        SimdFloat t = x - simdFloor(x) * SimdFloat::load(&batch.loop[i]);
+        t = simdMin(simdMax(t, 0.0f), 1.0f);
+
+        SimdFloat u = SimdFloat(1.0f) - t;
+        SimdFloat b0 = u * u * u;
+        SimdFloat b1 = SimdFloat(3.0f) * u * u * t;
+        SimdFloat b2 = SimdFloat(3.0f) * u * t * t;
+        SimdFloat b3 = t * t * t;
+
+        for (int axis = 0; axis < 3; axis++) {
+            SimdFloat position = b0 * SimdFloat::load(&batch.control[axis][i]) +
+                                 b1 * SimdFloat::load(&batch.control[3 + axis][i]) +
+                                 b2 * SimdFloat::load(&batch.control[6 + axis][i]) +
+                                 b3 * SimdFloat::load(&batch.control[9 + axis][i]);
+            position.store(&out.position[axis][i]);
+        }
+        SimdFloat rotationX, rotationY;
+        animationSpin(timeV, SimdFloat::load(&batch.spinRate[i]), SimdFloat::load(&batch.wobblePhase[i]), rotationX, rotationY);
+        rotationX.store(&out.rotationX[i]);
+        rotationY.store(&out.rotationY[i]);
+    }
+}
+
+void updateOrbitBatch(const OrbitBatch& batch, float time, AnimationStream& out, size_t begin, size_t end) {
+    const int W = SimdFloat::WIDTH;
+    SimdFloat timeV(time);
+    end = std::min(end, batch.modelIndex.size());
+    for (size_t i = begin; i < end; i += W) {
+        SimdFloat angle = (timeV + SimdFloat::load(&batch.timeOffset[i])) * SimdFloat::load(&batch.angularSpeed[i]);
+        SimdFloat radius = SimdFloat::load(&batch.radius[i]);
+        SimdFloat cosine = simdSin(angle + (float)(M_PI / 2.0)) * radius;
+        SimdFloat sine = simdSin(angle) * radius;
+
+        for (int axis = 0; axis < 3; axis++) {
+            SimdFloat position = SimdFloat::load(&batch.center[axis][i]) +
+                                 cosine * SimdFloat::load(&batch.axisU[axis][i]) +
+                                 sine * SimdFloat::load(&batch.axisV[axis][i]);
+            position.store(&out.position[axis][i]);
+        }
+        SimdFloat rotationX, rotationY;
+        animationSpin(timeV, SimdFloat::load(&batch.spinRate[i]), SimdFloat::load(&batch.wobblePhase[i]), rotationX, rotationY);
+        rotationX.store(&out.rotationX[i]);
+        rotationY.store(&out.rotationY[i]);
+    }
+}
+
+// Interpola dois estados do lote (posicao linear, Y pelo menor caminho como mixAngles) e
+// escreve nos modelos: roda uma vez por frame renderizado, nao a cada passo da simulacao
+void interpolateBatch(const std::vector<int>& modelIndex, const AnimationStream& previous, const AnimationStream& current,
+                      float alpha, Model* out, size_t begin, size_t end) {
+    const int W = SimdFloat::WIDTH;
+    SimdFloat alphaV(alpha);
+    end = std::min(end, modelIndex.size());
+    for (size_t i = begin; i < end; i += W) {
+        float lanes[5][SimdFloat::WIDTH];
+        for (int axis = 0; axis < 3; axis++) {
+            SimdFloat a = SimdFloat::load(&previous.position[axis][i]);
+            SimdFloat b = SimdFloat::load(&current.position[axis][i]);
+            (a + (b - a) * alphaV).store(lanes[axis]);
+        }
+        SimdFloat a = SimdFloat::load(&previous.rotationX[i]);
+        (a + (SimdFloat::load(&current.rotationX[i]) - a) * alphaV).store(lanes[3]);
+        a = SimdFloat::load(&previous.rotationY[i]);
+        SimdFloat delta = SimdFloat::load(&current.rotationY[i]) - a;
+        delta = delta - simdFloor((delta + 180.0f) * (1.0f / 360.0f)) * 360.0f;
+        (a + delta * alphaV).store(lanes[4]);
+
+        for (int lane = 0; lane < W; lane++) {
+            int index = modelIndex[i + lane];
+            if (index < 0) continue;
+            Model& model = out[index];
+            model.position = glm::vec3(lanes[0][lane], lanes[1][lane], lanes[2][lane]);
+            model.rotation.x = lanes[3][lane];
+            model.rotation.y = lanes[4][lane];
+        }
+    }
+}
+
+// Avalia as animacoes e escreve o estado atual nos modelos (sem passo fixo)
+void applyAnimationsToModels() {
+    PROFILE_SCOPE("applyAnimationsToModels");
+    simulateAnimations();
+    writeBatchedTransforms(1.0f);
+}
+
+const size_t ANIMATION_GRAIN = 4096;  // Multiplo de SimdFloat::WIDTH
+
+// Um passo da simulacao em animationTime: Bézier e orbitais em lote (SIMD, pedacos em
+// paralelo) vao para os buffers SoA atuais; keyframes e pistas vao direto nos modelos.
+// Objetos estaticos (ANIM_NONE) nao sao tocados.
+void simulateAnimations() {
+    size_t count = std::min(models.size(), objectAnimations.size());
+    if (!animationBatches.valid || animationBatches.sourceCount != count) {
+        buildAnimationBatches(objectAnimations, count, animationBatches);
+    }
+
+    Model* out = models.data();
+    float time = animationTime;
+    parallelFor(animationBatches.bezier.modelIndex.size(), ANIMATION_GRAIN, [&](size_t begin, size_t end) {
+        updateBezierBatch(animationBatches.bezier, time, animationBatches.bezierCurrent, begin, end);
+    });
+    parallelFor(animationBatches.orbit.modelIndex.size(), ANIMATION_GRAIN, [&](size_t begin, size_t end) {
+        updateOrbitBatch(animationBatches.orbit, time, animationBatches.orbitCurrent, begin, end);
+    });
+
+    // Keyframes: cada objeto tem seu cursor, entao os pedacos sao independentes
+    const std::vector<int>& keyframed = animationBatches.keyframed;
+    parallelFor(keyframed.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            ObjectAnimation& anim = objectAnimations[keyframed[k]];
+            sampleKeyframeTrack(*anim.keyframes, time + anim.timeOffset, anim.cursor, out[keyframed[k]]);
+        }
+    });
+
+    // Pistas: poucos objetos, cada um com busca binaria na tabela de arco
+    for (int i : animationBatches.tracks) {
+        const ObjectAnimation& anim = objectAnimations[i];
+        if (!anim.bezierTrack) continue;
+        glm::vec3 direction;
+        glm::vec3 newPos = calculateBezierTrackPosition(*anim.bezierTrack, animationTime + anim.timeOffset, direction);
         
-        // Aplicar curvas paramétricas se configuradas
-        switch (anim.type) {
-            case ANIM_BEZIER:
-            {
-                glm::vec3 newPos = calculateBezierPosition(anim.bezier, animationTime);
-                models[i].position = newPos;
-                
-                // Aplicar rotação automática apenas para animação Bézier simples
-                models[i].rotation.y = animationTime * (30.0f + i * 15.0f); // Graus
-                models[i].rotation.x = sin(animationTime * 2.0f + i) * 15.0f;
-                models[i].rotation.y = fmod(models[i].rotation.y, 360.0f);
-                break;
+        // Manter altura constante da moto
+        newPos.y = 0.8f;
+        models[i].position = newPos;
+        
+        // Orientar a moto apenas no eixo Y (direção horizontal)
+        if (length(direction) > 0.001f) {
+            // Calcular apenas ângulo Y para direção horizontal
+            float angleY = atan2(direction.x, direction.z) * 180.0f / M_PI;
+            // Manter a moto deitada com rodas no chão
+            models[i].rotation.x = -90.0f;   // Moto deitada (rodas tocam o chão)
+            models[i].rotation.y = angleY;   // Direção do movimento
+            models[i].rotation.z = 0.0f;     // Sem rotação lateral
+        }
+    }
+}
+
+// Escreve nos modelos os lotes interpolados entre o passo anterior e o atual
+void writeBatchedTransforms(float alpha) {
+    AnimationBatches& batches = animationBatches;
+    Model* out = models.data();
+    const AnimationStream& bezierFrom = alpha < 1.0f ? batches.bezierPrevious : batches.bezierCurrent;
+    const AnimationStream& orbitFrom = alpha < 1.0f ? batches.orbitPrevious : batches.orbitCurrent;
+    parallelFor(batches.bezier.modelIndex.size(), ANIMATION_GRAIN, [&](size_t begin, size_t end) {
+        interpolateBatch(batches.bezier.modelIndex, bezierFrom, batches.bezierCurrent, alpha, out, begin, end);
+    });
+    parallelFor(batches.orbit.modelIndex.size(), ANIMATION_GRAIN, [&](size_t begin, size_t end) {
+        interpolateBatch(batches.orbit.modelIndex, orbitFrom, batches.orbitCurrent, alpha, out, begin, end);
+    });
+}
+
+// Microbenchmark do sistema de animacao em lote: 100k Bézier + 100k orbitais sintéticos,
+// tempo medio por passo (kernels gravando no buffer SoA) e da interpolacao nos modelos,
+// em uma thread
+void runAnimationMicrobenchmark() {
+    const int OBJECTS_PER_TYPE = 100000;
+    const int ITERATIONS = 200;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f);
+
+    std::vector<ObjectAnimation> animations(2 * OBJECTS_PER_TYPE);
+    for (int i = 0; i < 2 * OBJECTS_PER_TYPE; i++) {
+        ObjectAnimation& anim = animations[i];
+        if (i % 2 == 0) {
+            anim.type = ANIM_BEZIER;
+            anim.bezier.p0 = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+            anim.bezier.p1 = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+            anim.bezier.p2 = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+            anim.bezier.p3 = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+            anim.bezier.duration = 2.0f + (coordinate(rng) + 50.0f) * 0.1f;
+            anim.bezier.loop = true;
+        } else {
+            anim.type = ANIM_ORBIT;
+            anim.orbit.center = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+            anim.orbit.radius = 1.0f + (coordinate(rng) + 50.0f) * 0.2f;
+            anim.orbit.speed = coordinate(rng) * 2.0f;
+            anim.orbit.axis = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    AnimationBatches batches;
+    auto start = std::chrono::steady_clock::now();
+    buildAnimationBatches(animations, animations.size(), batches);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<Model> out(animations.size());
+    double bezierMs = 0.0, orbitMs = 0.0, interpolateMs = 0.0;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        float time = iteration / 60.0f;
+        std::swap(batches.bezierPrevious, batches.bezierCurrent);
+        std::swap(batches.orbitPrevious, batches.orbitCurrent);
+        auto t0 = std::chrono::steady_clock::now();
+        updateBezierBatch(batches.bezier, time, batches.bezierCurrent);
+        auto t1 = std::chrono::steady_clock::now();
+        updateOrbitBatch(batches.orbit, time, batches.orbitCurrent);
+        auto t2 = std::chrono::steady_clock::now();
+        interpolateBatch(batches.bezier.modelIndex, batches.bezierPrevious, batches.bezierCurrent, 0.5f, out.data());
+        interpolateBatch(batches.orbit.modelIndex, batches.orbitPrevious, batches.orbitCurrent, 0.5f, out.data());
+        auto t3 = std::chrono::steady_clock::now();
+        bezierMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        orbitMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        interpolateMs += std::chrono::duration<double, std::milli>(t3 - t2).count();
+    }
+    bezierMs /= ITERATIONS;
+    orbitMs /= ITERATIONS;
+    interpolateMs /= ITERATIONS;
+
+    // Confere uma amostra do buffer atual contra a avaliacao escalar de referencia
+    float maxError = 0.0f;
+    float time = (ITERATIONS - 1) / 60.0f;
+    for (const auto& entry : { std::make_pair(&batches.bezier.modelIndex, &batches.bezierCurrent),
+                               std::make_pair(&batches.orbit.modelIndex, &batches.orbitCurrent) }) {
+        const std::vector<int>& modelIndex = *entry.first;
+        const AnimationStream& stream = *entry.second;
+        for (size_t k = 0; k < modelIndex.size(); k += 997) {
+            int i = modelIndex[k];
+            if (i < 0) continue;
+            glm::vec3 expected = animations[i].type == ANIM_BEZIER ? calculateBezierPosition(animations[i].bezier, time)
+                                                                   : calculateOrbitPosition(animations[i].orbit, time);
+            glm::vec3 actual(stream.position[0][k], stream.position[1][k], stream.position[2][k]);
+            maxError = std::max(maxError, length(expected - actual));
+        }
+    }
+
+    LOG_INFO("Microbenchmark de animacao (" << SIMD_NAME << ", " << SimdFloat::WIDTH << " por instrucao, 1 thread)");
+    LOG_INFO("  montagem dos lotes: " << buildMs << " ms");
+    LOG_INFO("  " << OBJECTS_PER_TYPE << " Bezier: " << bezierMs << " ms/passo");
+    LOG_INFO("  " << OBJECTS_PER_TYPE << " orbitais: " << orbitMs << " ms/passo");
+    LOG_INFO("  interpolacao nos modelos (" << 2 * OBJECTS_PER_TYPE << " objetos): " << interpolateMs << " ms/frame");
+    LOG_INFO("  erro maximo contra o caminho escalar: " << maxError);
+}
+
+// Caixas locais de cada parte, calculadas uma vez a partir dos vertices carregados
+void computeSceneBounds() {
+    for (Model& model : models) {
+        computeModelBounds(model);
+    }
+}
+
+void computeModelBounds(Model& model) {
+    for (ModelPart& part : model.parts) {
+        if (part.vertices.empty()) continue;
+        part.boundsMin = glm::vec3(FLT_MAX);
+        part.boundsMax = glm::vec3(-FLT_MAX);
+        for (const glm::vec3& vertex : part.vertices) {
+            part.boundsMin = glm::min(part.boundsMin, vertex);
+            part.boundsMax = glm::max(part.boundsMax, vertex);
+        }
+    }
+}
+
+// Monta a hierarquia a partir de Model::parent e Model::partNodes
+void buildSceneGraph() {
+    std::vector<SceneGraphSource> sources(models.size());
+    for (size_t i = 0; i < models.size(); i++) {
+        sources[i].parent = models[i].parent;
+        sources[i].mesh = &models[i];
+        sources[i].partNodes = &models[i].partNodes;
+        sources[i].name = &models[i].name;
+    }
+    buildSceneGraphNodes(sources, sceneGraph);
+    for (size_t i = 0; i < models.size(); i++) {
+        models[i].parent = sources[i].parent;
+        for (ModelPart& part : models[i].parts) part.node = -1;
+    }
+    assignPartNodes(sceneGraph, models);
+}
+
+// Modelos sao ordenados pela profundidade (pai antes do filho); as partes promovidas vem
+// logo depois do modelo. Ciclos ou pais invalidos viram raiz (corrigido em sources).
+// So le as malhas: roda tambem na thread de recarga.
+void buildSceneGraphNodes(std::vector<SceneGraphSource>& sources, SceneGraph& graph) {
+    graph.nodes.clear();
+    graph.modelNode.assign(sources.size(), -1);
+
+    int modelCount = (int)sources.size();
+    std::vector<int> depth(modelCount, 0);
+    for (int pass = 0; pass < 2; pass++) {   // 1a: corta ciclos; 2a: profundidade final
+        for (int i = 0; i < modelCount; i++) {
+            depth[i] = 0;
+            int parent = sources[i].parent;
+            while (parent >= 0 && parent < modelCount && parent != i && depth[i] <= modelCount) {
+                depth[i]++;
+                parent = sources[parent].parent;
             }
-            
-            case ANIM_BEZIER_TRACK:
-            {
-                glm::vec3 direction;
-                glm::vec3 newPos = calculateBezierTrackPosition(anim.bezierTrack, animationTime, direction);
-                
-                // Manter altura constante da moto
-                newPos.y = 0.8f;
-                models[i].position = newPos;
-                
-                // Orientar a moto apenas no eixo Y (direção horizontal)
-                if (length(direction) > 0.001f) {
-                    // Calcular apenas ângulo Y para direção horizontal
-                    float angleY = atan2(direction.x, direction.z) * 180.0f / M_PI;
-                    // Manter a moto deitada com rodas no chão
-                    models[i].rotation.x = -90.0f;   // Moto deitada (rodas tocam o chão)
-                    models[i].rotation.y = angleY;   // Direção do movimento
-                    models[i].rotation.z = 0.0f;     // Sem rotação lateral
+            if (parent >= modelCount || parent == i || depth[i] > modelCount) {
+                LOG_WARN("Hierarquia invalida no modelo " << i << " (" << *sources[i].name << "), usando como raiz");
+                sources[i].parent = -1;
+                depth[i] = 0;
+            }
+        }
+    }
+    std::vector<int> order(sources.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return depth[a] < depth[b]; });
+
+    for (int modelIndex : order) {
+        const SceneGraphSource& source = sources[modelIndex];
+        const std::vector<ModelPart>& parts = source.mesh->parts;
+        SceneNode node;
+        node.model = modelIndex;
+        node.parent = source.parent >= 0 ? graph.modelNode[source.parent] : -1;
+        graph.modelNode[modelIndex] = (int)graph.nodes.size();
+        graph.nodes.push_back(node);
+        int rootNode = graph.modelNode[modelIndex];
+
+        for (const PartNodeConfig& config : *source.partNodes) {
+            bool found = false;
+            for (size_t p = 0; p < parts.size(); p++) {
+                const ModelPart& part = parts[p];
+                if (part.materialName != config.part) continue;
+                SceneNode partNode;
+                partNode.model = modelIndex;
+                partNode.part = (int)p;
+                partNode.parent = rootNode;
+                partNode.axis = config.axis;
+                partNode.speed = config.speed;
+                partNode.pivot = config.autoPivot ? 0.5f * (part.boundsMin + part.boundsMax) : config.pivot;
+                graph.nodes.push_back(partNode);
+                found = true;
+            }
+            if (!found) {
+                LOG_WARN("PART " << config.part << " nao encontrada em " << *source.name);
+            }
+        }
+    }
+    LOG_INFO("Hierarquia: " << graph.nodes.size() << " nos (" << sources.size() << " modelos)");
+}
+
+// Liga cada parte promovida ao seu no (as demais ficam como estao, -1)
+void assignPartNodes(const SceneGraph& graph, std::vector<Model>& target) {
+    for (size_t i = 0; i < graph.nodes.size(); i++) {
+        const SceneNode& node = graph.nodes[i];
+        if (node.part >= 0) {
+            target[node.model].parts[node.part].node = (int)i;
+        }
+    }
+}
+
+// Matrizes locais em paralelo (so detecta e recalcula o que mudou), depois uma passada
+// linear propaga para o mundo: um no e recalculado se a local mudou ou se o pai mudou
+void updateSceneGraph() {
+    SceneGraph& graph = sceneGraph;
+    if (graph.modelNode.size() != models.size()) {
+        buildSceneGraph();
+    }
+    std::vector<SceneNode>& nodes = graph.nodes;
+
+    parallelFor(nodes.size(), 1024, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            SceneNode& node = nodes[i];
+            if (node.part < 0) {
+                const Model& model = models[node.model];
+                if (node.localDirty || model.position != node.position || model.rotation != node.rotation ||
+                    model.scale != node.scale) {
+                    node.position = model.position;
+                    node.rotation = model.rotation;
+                    node.scale = model.scale;
+                    node.local = computeModelMatrix(model);
+                    node.localDirty = true;
+                }
+            } else {
+                float angle = fmod(node.speed * animationTime, 360.0f);
+                if (node.localDirty || angle != node.angle) {
+                    node.angle = angle;
+                    node.local = translate(mat4(1.0f), node.pivot) * rotate(mat4(1.0f), radians(angle), node.axis) *
+                                 translate(mat4(1.0f), -node.pivot);
+                    node.localDirty = true;
                 }
-                break;
             }
-            
-            case ANIM_ORBIT:
-            {
-                glm::vec3 newPos = calculateOrbitPosition(anim.orbit, animationTime);
-                models[i].position = newPos;
-                
-                // Aplicar rotação automática para animação orbital
-                models[i].rotation.y = animationTime * (30.0f + i * 15.0f); // Graus
-                models[i].rotation.x = sin(animationTime * 2.0f + i) * 15.0f;
-                models[i].rotation.y = fmod(models[i].rotation.y, 360.0f);
-                break;
+        }
+    });
+
+    size_t updated = 0;
+    for (SceneNode& node : nodes) {
+        bool parentChanged = node.parent >= 0 && nodes[node.parent].worldChanged;
+        node.worldChanged = node.localDirty || parentChanged;
+        if (node.worldChanged) {
+            node.world = node.parent >= 0 ? nodes[node.parent].world * node.local : node.local;
+            if (node.part < 0) {
+                models[node.model].worldMatrix = node.world;
             }
-            
-            case ANIM_LINEAR:
-            {
-                // Implementar movimento linear simples se necessario
-                // Por enquanto, nao implementado
-                break;
+            updated++;
+        }
+        node.localDirty = false;
+    }
+    graph.updatedNodes = updated;
+}
+
+// Planos do frustum (Gribb/Hartmann) a partir de projecao * view; normal aponta para dentro
+static void extractFrustumPlanes(const mat4& m, glm::vec4 planes[6]) {
+    for (int i = 0; i < 3; i++) {
+        planes[2 * i]     = glm::vec4(m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]);
+        planes[2 * i + 1] = glm::vec4(m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]);
+    }
+}
+
+// Caixa no mundo (Arvo: centro transformado + extensao pelos valores absolutos da matriz)
+// contra os seis planos; fora de qualquer plano = invisivel
+static bool partInFrustum(const ModelPart& part, const mat4& world, const glm::vec4 planes[6]) {
+    glm::vec3 center = glm::vec3(world * glm::vec4(0.5f * (part.boundsMin + part.boundsMax), 1.0f));
+    glm::vec3 halfExtent = 0.5f * (part.boundsMax - part.boundsMin);
+    glm::vec3 extent(0.0f);
+    for (int column = 0; column < 3; column++) {
+        extent += glm::abs(glm::vec3(world[column])) * halfExtent[column];
+    }
+    for (int i = 0; i < 6; i++) {
+        glm::vec3 normal(planes[i]);
+        float distance = dot(normal, center) + planes[i].w;
+        float radius = dot(glm::abs(normal), extent);
+        if (distance + radius < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Atualiza matrizes de mundo (hierarquia) e visibilidade das partes de todos os modelos.
+// Depende das animacoes do frame (ja aplicadas); o culling roda em jobs independentes.
+void updateSceneTransforms(const mat4& viewProjection) {
+    PROFILE_SCOPE("Scene update");
+    glm::vec4 planes[6];
+    extractFrustumPlanes(viewProjection, planes);
+
+    updateSceneGraph();
+
+    std::atomic<unsigned> culled{0};
+    parallelFor(models.size(), 256, [&](size_t begin, size_t end) {
+        unsigned localCulled = 0;
+        for (size_t i = begin; i < end; i++) {
+            Model& model = models[i];
+            for (ModelPart& part : model.parts) {
+                part.visible = partInFrustum(part, partWorldMatrix(model, part), planes);
+                localCulled += part.visible ? 0 : 1;
             }
-            
-            case ANIM_NONE:
-            default:
-                // Objetos estáticos - NÃO aplicar nenhuma rotação ou movimento
-                // Manter posição e rotação original (pista deve ficar parada)
-                break;
         }
+        culled.fetch_add(localCulled, std::memory_order_relaxed);
+    });
+    renderStats.culledParts = culled.load();
+}
+
+// Escalabilidade do sistema de jobs: cena sintetica de 100k modelos animados com 4
+// partes cada; mede animacao + matrizes + culling com 1, 2, 4 e 8 threads
+void runJobsMicrobenchmark() {
+    const int MODEL_COUNT = 100000;
+    const int PARTS_PER_MODEL = 4;
+    const int ITERATIONS = 50;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coordinate(-200.0f, 200.0f);
+
+    std::vector<Model> syntheticModels(MODEL_COUNT);
+    std::vector<ObjectAnimation> syntheticAnimations(MODEL_COUNT);
+    for (int i = 0; i < MODEL_COUNT; i++) {
+        Model& model = syntheticModels[i];
+        model.parts.resize(PARTS_PER_MODEL);
+        for (int k = 0; k < PARTS_PER_MODEL; k++) {
+            model.parts[k].boundsMin = glm::vec3(-1.0f + k, -1.0f, -1.0f);
+            model.parts[k].boundsMax = glm::vec3(k + 0.5f, 1.0f, 1.0f);
+        }
+        ObjectAnimation& anim = syntheticAnimations[i];
+        if (i % 2 == 0) {
+            anim.type = ANIM_BEZIER;
+            anim.bezier = { glm::vec3(coordinate(rng), 0.0f, coordinate(rng)), glm::vec3(coordinate(rng), 5.0f, coordinate(rng)),
+                            glm::vec3(coordinate(rng), 5.0f, coordinate(rng)), glm::vec3(coordinate(rng), 0.0f, coordinate(rng)),
+                            5.0f, true };
+        } else {
+            anim.type = ANIM_ORBIT;
+            anim.orbit.center = glm::vec3(coordinate(rng), 0.0f, coordinate(rng));
+            anim.orbit.radius = 5.0f;
+            anim.orbit.speed = 45.0f;
+            anim.orbit.axis = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    // Usa as globais da cena (o microbenchmark roda antes de qualquer carregamento)
+    models.swap(syntheticModels);
+    objectAnimations.swap(syntheticAnimations);
+    mat4 viewProjection = perspective(radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f) *
+                          lookAt(glm::vec3(0.0f, 50.0f, 250.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    int restoreWorkers = (int)jobSystem.workers.size();
+    int cores = (int)std::thread::hardware_concurrency();
+    LOG_INFO("Microbenchmark de jobs: " << MODEL_COUNT << " modelos, " << PARTS_PER_MODEL
+             << " partes cada (" << cores << " nucleos)");
+    LOG_INFO("  threads | animacao (ms) | matrizes+culling (ms) | total (ms) | speedup");
+    double baseline = 0.0;
+    for (int threads : { 1, 2, 4, 8 }) {
+        jobSystemStart(threads - 1);
+        double animationMs = 0.0, sceneMs = 0.0;
+        for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+            animationTime = iteration / 60.0f;
+            auto t0 = std::chrono::steady_clock::now();
+            applyAnimationsToModels();
+            auto t1 = std::chrono::steady_clock::now();
+            updateSceneTransforms(viewProjection);
+            auto t2 = std::chrono::steady_clock::now();
+            animationMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            sceneMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        }
+        animationMs /= ITERATIONS;
+        sceneMs /= ITERATIONS;
+        double total = animationMs + sceneMs;
+        if (threads == 1) baseline = total;
+
+        char line[128];
+        // Mais threads que nucleos so mede o custo de dividir o trabalho, nao escalabilidade
+        snprintf(line, sizeof(line), "  %7d | %13.3f | %21.3f | %10.3f | %6.2fx%s",
+                 threads, animationMs, sceneMs, total, baseline / total,
+                 cores > 0 && threads > cores ? "  (mais threads que nucleos)" : "");
+        LOG_INFO(line);
     }
+    LOG_INFO("  partes fora do frustum: " << renderStats.culledParts << " de " << MODEL_COUNT * PARTS_PER_MODEL);
+
+    jobSystemStart(restoreWorkers);
+    models.swap(syntheticModels);
+    objectAnimations.swap(syntheticAnimations);
+    animationBatches.valid = false;
 }
 
 vec3 calculateLightIntensity(int lightIndex, float time) {
@@ -1617,10 +7163,254 @@ vec3 calculateLightIntensity(int lightIndex, float time) {
     return vec3(finalIntensity, finalIntensity, finalIntensity);
 }
 
+// Cria os texture buffers e calcula as AABBs dos clusters no espaco de view
+void initClusteredLighting(int screenWidth, int screenHeight, const mat4& projection) {
+    ClusteredLighting& cl = clusteredLighting;
+    cl.screenWidth = std::max(screenWidth, 1);
+    cl.screenHeight = std::max(screenHeight, 1);
+    setClusterProjection(projection);
+
+    glGenBuffers(1, &cl.lightBuffer);
+    glGenBuffers(1, &cl.gridBuffer);
+    glGenBuffers(1, &cl.indexBuffer);
+    glGenTextures(1, &cl.lightTexture);
+    glGenTextures(1, &cl.gridTexture);
+    glGenTextures(1, &cl.indexTexture);
+
+    // Buffers vazios iniciais para que os texture buffers sejam validos
+    glBindBuffer(GL_TEXTURE_BUFFER, cl.lightBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(GpuLight), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, cl.gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, cl.clusterBounds.size() * 2 * sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, cl.indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, cl.lightTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, cl.lightBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, cl.gridTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, cl.gridBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, cl.indexTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, cl.indexBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    cl.clusterCounts.resize(cl.clusterBounds.size());
+    cl.clusterGrid.resize(cl.clusterBounds.size() * 2);
+}
+
+// Caixas dos clusters no espaco de view para a projecao atual (muda com o fov)
+void setClusterProjection(const mat4& projection) {
+    ClusteredLighting& cl = clusteredLighting;
+    cl.projection = projection;
+
+    // Fatias de profundidade exponenciais: z = near * (far/near)^(k/Z)
+    cl.clusterBounds.resize(CLUSTER_X * CLUSTER_Y * CLUSTER_Z);
+    for (int z = 0; z < CLUSTER_Z; z++) {
+        float zNear = CLUSTER_NEAR * pow(CLUSTER_FAR / CLUSTER_NEAR, (float)z / CLUSTER_Z);
+        float zFar = CLUSTER_NEAR * pow(CLUSTER_FAR / CLUSTER_NEAR, (float)(z + 1) / CLUSTER_Z);
+        for (int y = 0; y < CLUSTER_Y; y++) {
+            float ndcY0 = -1.0f + 2.0f * y / CLUSTER_Y;
+            float ndcY1 = -1.0f + 2.0f * (y + 1) / CLUSTER_Y;
+            for (int x = 0; x < CLUSTER_X; x++) {
+                float ndcX0 = -1.0f + 2.0f * x / CLUSTER_X;
+                float ndcX1 = -1.0f + 2.0f * (x + 1) / CLUSTER_X;
+
+                // Cantos do tile nos planos zNear e zFar (projecao simetrica)
+                ClusterAABB& box = cl.clusterBounds[x + CLUSTER_X * (y + CLUSTER_Y * z)];
+                box.minPoint = vec3(std::min(ndcX0 * zNear, ndcX0 * zFar) / projection[0][0],
+                                    std::min(ndcY0 * zNear, ndcY0 * zFar) / projection[1][1],
+                                    -zFar);
+                box.maxPoint = vec3(std::max(ndcX1 * zNear, ndcX1 * zFar) / projection[0][0],
+                                    std::max(ndcY1 * zNear, ndcY1 * zFar) / projection[1][1],
+                                    -zNear);
+            }
+        }
+    }
+}
+
+// Indice da fatia de profundidade para uma distancia (positiva) no espaco de view
+static int clusterSliceForDepth(float depth) {
+    float slice = log(depth / CLUSTER_NEAR) * CLUSTER_Z / log(CLUSTER_FAR / CLUSTER_NEAR);
+    return glm::clamp((int)floor(slice), 0, CLUSTER_Z - 1);
+}
+
+// Monta a lista de luzes ativas, atribui cada luz com raio aos clusters que sua esfera
+// toca e envia tudo para a GPU. O custo no shader depende das luzes por cluster, nao do total.
+void updateLightClusters(GLuint shaderID, const mat4& view) {
+    PROFILE_SCOPE("Light clusters + uniform upload");
+    ClusteredLighting& cl = clusteredLighting;
+
+    // Luzes globais primeiro (atingem todos os clusters), depois as com raio
+    cl.lights.clear();
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < sceneConfig.lights.size(); i++) {
+            const SceneConfig::LightConfig& light = sceneConfig.lights[i];
+            bool isGlobal = light.radius <= 0.0f;
+            if (!light.enabled || isGlobal != (pass == 0)) continue;
+
+            // Intensidade com animacao (luzes piscando) se ativada
+            float intensity = animationEnabled ? calculateLightIntensity((int)i, animationTime).x : 1.0f;
+            GpuLight gpuLight;
+            gpuLight.positionRadius = vec4(light.position, std::max(light.radius, 0.0f));
+            gpuLight.colorIntensity = vec4(light.color * intensity * light.weight, 0.0f);
+            cl.lights.push_back(gpuLight);
+        }
+        if (pass == 0) cl.globalLightCount = (int)cl.lights.size();
+    }
+
+    // Primeira passada: intervalo de clusters de cada luz e contagem por cluster
+    std::fill(cl.clusterCounts.begin(), cl.clusterCounts.end(), 0);
+    size_t localCount = cl.lights.size() - cl.globalLightCount;
+    cl.lightRangeMin.resize(localCount);
+    cl.lightRangeMax.resize(localCount);
+
+    for (size_t l = 0; l < localCount; l++) {
+        const GpuLight& light = cl.lights[cl.globalLightCount + l];
+        vec3 center = vec3(view * vec4(vec3(light.positionRadius), 1.0f));
+        float radius = light.positionRadius.w;
+        float depth = -center.z;
+
+        // Fora do intervalo de profundidade: intervalo vazio
+        cl.lightRangeMin[l] = ivec3(1, 1, 1);
+        cl.lightRangeMax[l] = ivec3(0, 0, 0);
+        if (depth + radius < CLUSTER_NEAR || depth - radius > CLUSTER_FAR) continue;
+
+        float zMin = std::max(depth - radius, CLUSTER_NEAR);
+        float zMax = std::min(depth + radius, CLUSTER_FAR);
+
+        // Extensao conservadora em NDC: x/z e y/z sao monotonicos, extremos nos cantos
+        float ndcMinX = 1e30f, ndcMaxX = -1e30f, ndcMinY = 1e30f, ndcMaxY = -1e30f;
+        for (float z : { zMin, zMax }) {
+            for (float sign : { -1.0f, 1.0f }) {
+                float ndcX = cl.projection[0][0] * (center.x + sign * radius) / z;
+                float ndcY = cl.projection[1][1] * (center.y + sign * radius) / z;
+                ndcMinX = std::min(ndcMinX, ndcX); ndcMaxX = std::max(ndcMaxX, ndcX);
+                ndcMinY = std::min(ndcMinY, ndcY); ndcMaxY = std::max(ndcMaxY, ndcY);
+            }
+        }
+        if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f) continue;
+
+        ivec3 rangeMin((int)floor((ndcMinX + 1.0f) * 0.5f * CLUSTER_X),
+                       (int)floor((ndcMinY + 1.0f) * 0.5f * CLUSTER_Y),
+                       clusterSliceForDepth(zMin));
+        ivec3 rangeMax((int)floor((ndcMaxX + 1.0f) * 0.5f * CLUSTER_X),
+                       (int)floor((ndcMaxY + 1.0f) * 0.5f * CLUSTER_Y),
+                       clusterSliceForDepth(zMax));
+        rangeMin.x = glm::clamp(rangeMin.x, 0, CLUSTER_X - 1);
+        rangeMin.y = glm::clamp(rangeMin.y, 0, CLUSTER_Y - 1);
+        rangeMax.x = glm::clamp(rangeMax.x, 0, CLUSTER_X - 1);
+        rangeMax.y = glm::clamp(rangeMax.y, 0, CLUSTER_Y - 1);
+        cl.lightRangeMin[l] = rangeMin;
+        cl.lightRangeMax[l] = rangeMax;
+
+        for (int z = rangeMin.z; z <= rangeMax.z; z++)
+            for (int y = rangeMin.y; y <= rangeMax.y; y++)
+                for (int x = rangeMin.x; x <= rangeMax.x; x++) {
+                    int index = x + CLUSTER_X * (y + CLUSTER_Y * z);
+                    const ClusterAABB& box = cl.clusterBounds[index];
+                    vec3 closest = glm::clamp(center, box.minPoint, box.maxPoint);
+                    vec3 delta = closest - center;
+                    if (dot(delta, delta) <= radius * radius) {
+                        cl.clusterCounts[index]++;
+                    }
+                }
+    }
+
+    // Prefix sum: offset de cada cluster na lista de indices
+    GLuint total = 0;
+    for (size_t c = 0; c < cl.clusterCounts.size(); c++) {
+        cl.clusterGrid[c * 2] = total;
+        cl.clusterGrid[c * 2 + 1] = 0;
+        total += cl.clusterCounts[c];
+    }
+    cl.lightIndices.resize(std::max<GLuint>(total, 1));
+
+    // Segunda passada: preencher os indices (mesmo teste da primeira passada)
+    for (size_t l = 0; l < localCount; l++) {
+        const GpuLight& light = cl.lights[cl.globalLightCount + l];
+        vec3 center = vec3(view * vec4(vec3(light.positionRadius), 1.0f));
+        float radius = light.positionRadius.w;
+        const ivec3& rangeMin = cl.lightRangeMin[l];
+        const ivec3& rangeMax = cl.lightRangeMax[l];
+
+        for (int z = rangeMin.z; z <= rangeMax.z; z++)
+            for (int y = rangeMin.y; y <= rangeMax.y; y++)
+                for (int x = rangeMin.x; x <= rangeMax.x; x++) {
+                    int index = x + CLUSTER_X * (y + CLUSTER_Y * z);
+                    const ClusterAABB& box = cl.clusterBounds[index];
+                    vec3 closest = glm::clamp(center, box.minPoint, box.maxPoint);
+                    vec3 delta = closest - center;
+                    if (dot(delta, delta) <= radius * radius) {
+                        GLuint slot = cl.clusterGrid[index * 2] + cl.clusterGrid[index * 2 + 1]++;
+                        cl.lightIndices[slot] = (GLuint)(cl.globalLightCount + l);
+                    }
+                }
+    }
+
+    // Enviar para a GPU (orphaning para nao esperar o frame anterior)
+    size_t lightBytes = std::max<size_t>(cl.lights.size(), 1) * sizeof(GpuLight);
+    glBindBuffer(GL_TEXTURE_BUFFER, cl.lightBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, lightBytes, nullptr, GL_STREAM_DRAW);
+    if (!cl.lights.empty()) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, cl.lights.size() * sizeof(GpuLight), cl.lights.data());
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, cl.gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, cl.clusterGrid.size() * sizeof(GLuint), cl.clusterGrid.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, cl.indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, cl.lightIndices.size() * sizeof(GLuint), cl.lightIndices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    // Texture buffers nas unidades 1-3 (unidade 0 e a textura difusa)
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, cl.lightTexture);
+    renderStats.textureBinds++;
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, cl.gridTexture);
+    renderStats.textureBinds++;
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_BUFFER, cl.indexTexture);
+    renderStats.textureBinds++;
+    glActiveTexture(GL_TEXTURE0);
+
+    float logRatio = log(CLUSTER_FAR / CLUSTER_NEAR);
+    glUniform1i(glGetUniformLocation(shaderID, "lightData"), 1);
+    renderStats.uniformUpdates++;
+    glUniform1i(glGetUniformLocation(shaderID, "clusterGrid"), 2);
+    renderStats.uniformUpdates++;
+    glUniform1i(glGetUniformLocation(shaderID, "lightIndices"), 3);
+    renderStats.uniformUpdates++;
+    glUniform3i(glGetUniformLocation(shaderID, "clusterDims"), CLUSTER_X, CLUSTER_Y, CLUSTER_Z);
+    renderStats.uniformUpdates++;
+    glUniform2f(glGetUniformLocation(shaderID, "clusterTileSize"),
+                (float)cl.screenWidth / CLUSTER_X, (float)cl.screenHeight / CLUSTER_Y);
+    renderStats.uniformUpdates++;
+    glUniform1f(glGetUniformLocation(shaderID, "clusterSliceScale"), CLUSTER_Z / logRatio);
+    renderStats.uniformUpdates++;
+    glUniform1f(glGetUniformLocation(shaderID, "clusterSliceBias"), CLUSTER_Z * log(CLUSTER_NEAR) / logRatio);
+    renderStats.uniformUpdates++;
+    glUniform1i(glGetUniformLocation(shaderID, "globalLightCount"), cl.globalLightCount);
+    renderStats.uniformUpdates++;
+
+    size_t residentBytes = lightBytes + cl.clusterGrid.size() * sizeof(GLuint) + cl.lightIndices.size() * sizeof(GLuint);
+    renderStats.bufferBytes += residentBytes - cl.residentBytes;
+    cl.residentBytes = residentBytes;
+}
+
+void destroyClusteredLighting() {
+    ClusteredLighting& cl = clusteredLighting;
+    glDeleteTextures(1, &cl.lightTexture);
+    glDeleteTextures(1, &cl.gridTexture);
+    glDeleteTextures(1, &cl.indexTexture);
+    glDeleteBuffers(1, &cl.lightBuffer);
+    glDeleteBuffers(1, &cl.gridBuffer);
+    glDeleteBuffers(1, &cl.indexBuffer);
+}
+
 bool loadMTL(const std::string& filename, std::vector<Material>& materials) {
+    PROFILE_SCOPE("loadMTL");
     std::ifstream file(filename);
     if (!file.is_open()) {
-        std::cout << "Arquivo MTL nao encontrado: " << filename << std::endl;
+        LOG_ERROR("Arquivo MTL nao encontrado: " << filename);
         return false;
     }
     
@@ -1629,7 +7419,7 @@ bool loadMTL(const std::string& filename, std::vector<Material>& materials) {
     bool hasMaterial = false;
     bool hasKd = false; // Track if Kd was explicitly set
     
-    std::cout << "Carregando materiais de: " << filename << std::endl;
+    LOG_INFO("Carregando materiais de: " << filename);
     
     while (std::getline(file, line)) {
         // Ignorar comentarios e linhas vazias
@@ -1671,7 +7461,7 @@ bool loadMTL(const std::string& filename, std::vector<Material>& materials) {
                     currentMaterial.ks = glm::vec3(0.1f, 0.1f, 0.1f); // Baixo especular 
                     currentMaterial.shininess = 1.0f;                  // Sem brilho
                 }
-                materials.push_back(currentMaterial);
+                materials.push_back(std::move(currentMaterial));
             }
             
             // Comecar novo material
@@ -1679,7 +7469,7 @@ bool loadMTL(const std::string& filename, std::vector<Material>& materials) {
             iss >> currentMaterial.name;
             hasMaterial = true;
             hasKd = false; // Reset Kd flag
-            std::cout << "Material encontrado: " << currentMaterial.name << std::endl;
+            LOG_DEBUG("Material encontrado: " << currentMaterial.name);
         }
         else if (command == "Ka") {
             iss >> currentMaterial.ka.x >> currentMaterial.ka.y >> currentMaterial.ka.z;
@@ -1729,11 +7519,11 @@ bool loadMTL(const std::string& filename, std::vector<Material>& materials) {
             currentMaterial.ks = glm::vec3(0.1f, 0.1f, 0.1f); // Baixo especular 
             currentMaterial.shininess = 1.0f;                  // Sem brilho
         }
-        materials.push_back(currentMaterial);
+        materials.push_back(std::move(currentMaterial));
     }
     
     file.close();
-    std::cout << "Carregados " << materials.size() << " materiais de " << filename << std::endl;
+    LOG_INFO("Carregados " << materials.size() << " materiais de " << filename);
     
     // Carregar texturas dos materiais
     if (materials.size() > 0) {
@@ -1743,37 +7533,6 @@ bool loadMTL(const std::string& filename, std::vector<Material>& materials) {
     return materials.size() > 0;
 }
 
-Material findMaterialByName(const std::vector<Material>& materials, const std::string& name) {
-    for (const auto& material : materials) {
-        if (material.name == name) {
-            return material;
-        }
-    }
-    
-    // Criar material especifico baseado no nome se nao encontrado
-    
-    Material defaultMaterial;
-    defaultMaterial.name = name;
-    
-    // Cores específicas baseadas no nome do material solicitado
-    if (name == "Front_End") {
-        defaultMaterial.kd = glm::vec3(0.1f, 0.3f, 0.8f); // Azul para moto
-        defaultMaterial.ks = glm::vec3(0.8f, 0.8f, 0.8f); // Especular brilhante
-        defaultMaterial.shininess = 64.0f;
-    } else if (name == "Asphalt") {
-        defaultMaterial.kd = glm::vec3(0.3f, 0.3f, 0.3f); // Cinza escuro para asfalto
-        defaultMaterial.ks = glm::vec3(0.2f, 0.2f, 0.2f); // Pouco especular
-        defaultMaterial.shininess = 8.0f;
-    } else {
-        // Material padrão genérico
-        defaultMaterial.kd = glm::vec3(0.7f, 0.7f, 0.7f);
-        defaultMaterial.ks = glm::vec3(0.5f, 0.5f, 0.5f);
-        defaultMaterial.shininess = 32.0f;
-    }
-    
-    return defaultMaterial;
-}
-
 std::string getMTLFilename(const std::string& objFilename) {
     // Trocar extensao .obj por .mtl
     std::string mtlFile = objFilename;
@@ -1809,6 +7568,84 @@ glm::vec3 calculateBezierPosition(const BezierCurve& curve, float t) {
     return point;
 }
 
+// Ponto e derivada da curva cúbica para t local em [0, 1]
+static inline glm::vec3 bezierPoint(const BezierCurve& curve, float t) {
+    float u = 1.0f - t;
+    return (u * u * u) * curve.p0 + (3.0f * u * u * t) * curve.p1 + (3.0f * u * t * t) * curve.p2 + (t * t * t) * curve.p3;
+}
+
+static inline glm::vec3 bezierDerivative(const BezierCurve& curve, float t) {
+    float u = 1.0f - t;
+    return (3.0f * u * u) * (curve.p1 - curve.p0) + (6.0f * u * t) * (curve.p2 - curve.p1) + (3.0f * t * t) * (curve.p3 - curve.p2);
+}
+
+// Subdivide [t0, t1] ate o trecho ser quase reto (meias cordas ~ corda inteira) e o ponto
+// medio do parametro cair perto da metade do arco (velocidade quase uniforme no trecho,
+// o que permite interpolar o parametro linearmente). Cada trecho aceito vira uma amostra.
+static void subdivideArcLength(BezierTrack& track, const BezierCurve& curve, int curveIndex,
+                               float t0, const glm::vec3& p0, float t1, const glm::vec3& p1,
+                               float tolerance, int depth) {
+    const int MIN_DEPTH = 2;   // Evita aceitar curvas em S cujo ponto medio cai na corda
+    const int MAX_DEPTH = 12;
+    float tm = 0.5f * (t0 + t1);
+    glm::vec3 pm = bezierPoint(curve, tm);
+    float chord = length(p1 - p0);
+    float halves = length(pm - p0) + length(p1 - pm);
+
+    float imbalance = fabs(length(pm - p0) - length(p1 - pm));
+    bool flat = halves - chord <= tolerance * halves;
+    bool uniform = imbalance <= 0.02f * halves;
+    if (depth >= MAX_DEPTH || (depth >= MIN_DEPTH && flat && uniform)) {
+        track.totalLength += halves;
+        track.arcDistance.push_back(track.totalLength);
+        track.arcCurve.push_back((uint32_t)curveIndex);
+        track.arcT.push_back(t1);
+        return;
+    }
+    subdivideArcLength(track, curve, curveIndex, t0, p0, tm, pm, tolerance, depth + 1);
+    subdivideArcLength(track, curve, curveIndex, tm, pm, t1, p1, tolerance, depth + 1);
+}
+
+// Pre-calcula a tabela de comprimento de arco de toda a pista (somas prefixadas entre as
+// curvas). Com ela o tempo vira distancia percorrida e a velocidade fica constante.
+void buildArcLengthTable(BezierTrack& track, float tolerance) {
+    track.arcDistance.clear();
+    track.arcCurve.clear();
+    track.arcT.clear();
+    track.totalLength = 0.0;
+    if (track.curves.empty()) {
+        return;
+    }
+
+    track.arcDistance.push_back(0.0);
+    track.arcCurve.push_back(0);
+    track.arcT.push_back(0.0f);
+    for (size_t i = 0; i < track.curves.size(); i++) {
+        const BezierCurve& curve = track.curves[i];
+        subdivideArcLength(track, curve, (int)i, 0.0f, curve.p0, 1.0f, curve.p3, tolerance, 0);
+    }
+}
+
+// Busca binaria na tabela: curva e t local correspondentes a distancia percorrida
+static void arcLengthToCurve(const BezierTrack& track, double distance, size_t& curveIndex, float& localT) {
+    const std::vector<double>& d = track.arcDistance;
+    size_t k = std::upper_bound(d.begin(), d.end(), distance) - d.begin();
+    if (k == 0 || k >= d.size()) {
+        size_t edge = k == 0 ? 0 : d.size() - 1;
+        curveIndex = track.arcCurve[edge];
+        localT = track.arcT[edge];
+        return;
+    }
+
+    double span = d[k] - d[k - 1];
+    float f = span > 0.0 ? (float)((distance - d[k - 1]) / span) : 0.0f;
+    // O fim da curva i (t = 1) coincide com o inicio da curva i + 1: a amostra anterior
+    // de outra curva conta como t = 0 da curva atual
+    curveIndex = track.arcCurve[k];
+    float previousT = track.arcCurve[k - 1] == track.arcCurve[k] ? track.arcT[k - 1] : 0.0f;
+    localT = previousT + (track.arcT[k] - previousT) * f;
+}
+
 glm::vec3 calculateBezierTrackPosition(const BezierTrack& track, float t, glm::vec3& direction) {
     if (track.curves.empty()) {
         direction = glm::vec3(0.0f, 0.0f, 1.0f);
@@ -1822,7 +7659,20 @@ glm::vec3 calculateBezierTrackPosition(const BezierTrack& track, float t, glm::v
         t = glm::clamp(t, 0.0f, track.totalDuration);
     }
     
-    // Encontrar qual curva usar baseado no tempo
+    // Com tabela de arco: distancia proporcional ao tempo, O(log n) por amostra
+    if (!track.arcDistance.empty() && track.totalLength > 0.0 && track.totalDuration > 0.0f) {
+        size_t curveIndex;
+        float localT;
+        arcLengthToCurve(track, (double)t / track.totalDuration * track.totalLength, curveIndex, localT);
+        curveIndex = std::min(curveIndex, track.curves.size() - 1);
+        localT = glm::clamp(localT, 0.0f, 1.0f);
+        const BezierCurve& curve = track.curves[curveIndex];
+        glm::vec3 tangent = bezierDerivative(curve, localT);
+        direction = length(tangent) > 0.0f ? normalize(tangent) : glm::vec3(0.0f, 0.0f, 1.0f);
+        return bezierPoint(curve, localT);
+    }
+    
+    // Sem tabela: encontrar qual curva usar baseado no tempo (busca linear)
     float accumulatedTime = 0.0f;
     for (size_t i = 0; i < track.curves.size(); i++) {
         const BezierCurve& curve = track.curves[i];
@@ -1884,6 +7734,82 @@ glm::vec3 calculateOrbitPosition(const OrbitAnimation& orbit, float time) {
     return position;
 }
 
+// Oval ajustado a mao para a pista de drift: usado quando a malha nao tem a parte
+// Asphalt para extrair a linha (criado uma vez e compartilhado)
+std::shared_ptr<const BezierTrack> builtinDriftTrack() {
+    {
+        std::lock_guard<std::mutex> lock(animationCacheMutex);
+        auto found = trackCache.find("<embutida>");
+        if (found != trackCache.end()) {
+            return found->second;
+        }
+    }
+    BezierTrack track;
+    
+    // Criar pista de drift com pontos de controle realistas
+    // Baseado no formato típico de uma pista de drift oval
+    track.curves.clear();
+    track.totalDuration = 0.0f;
+    track.loop = true;
+    
+    // Trajeto seguindo a geometria real da pista de drift
+    // Baseado em observação da pista: formato mais oval/retangular que circular
+    
+    // Segmento 1: Reta longa lateral direita
+    BezierCurve curve1;
+    curve1.p0 = glm::vec3(12.0f, 0.8f, -8.0f);     // Início - parte baixa direita
+    curve1.p1 = glm::vec3(12.0f, 0.8f, -2.0f);     // Controle - subindo reta
+    curve1.p2 = glm::vec3(12.0f, 0.8f, 2.0f);      // Controle - meio da reta
+    curve1.p3 = glm::vec3(12.0f, 0.8f, 8.0f);      // Fim - parte alta direita
+    curve1.duration = 4.0f;
+    curve1.loop = false;
+    track.curves.push_back(curve1);
+    
+    // Segmento 2: Curva superior conectando direita-esquerda
+    BezierCurve curve2;
+    curve2.p0 = glm::vec3(12.0f, 0.8f, 8.0f);      // Início - alta direita
+    curve2.p1 = glm::vec3(8.0f, 0.8f, 12.0f);      // Controle - curvando para fora
+    curve2.p2 = glm::vec3(-8.0f, 0.8f, 12.0f);     // Controle - meio da curva superior
+    curve2.p3 = glm::vec3(-12.0f, 0.8f, 8.0f);     // Fim - alta esquerda
+    curve2.duration = 4.0f;
+    curve2.loop = false;
+    track.curves.push_back(curve2);
+    
+    // Segmento 3: Reta longa lateral esquerda
+    BezierCurve curve3;
+    curve3.p0 = glm::vec3(-12.0f, 0.8f, 8.0f);     // Início - parte alta esquerda
+    curve3.p1 = glm::vec3(-12.0f, 0.8f, 2.0f);     // Controle - descendo reta
+    curve3.p2 = glm::vec3(-12.0f, 0.8f, -2.0f);    // Controle - meio da reta
+    curve3.p3 = glm::vec3(-12.0f, 0.8f, -8.0f);    // Fim - parte baixa esquerda
+    curve3.duration = 4.0f;
+    curve3.loop = false;
+    track.curves.push_back(curve3);
+    
+    // Segmento 4: Curva inferior conectando esquerda-direita
+    BezierCurve curve4;
+    curve4.p0 = glm::vec3(-12.0f, 0.8f, -8.0f);    // Início - baixa esquerda
+    curve4.p1 = glm::vec3(-8.0f, 0.8f, -12.0f);    // Controle - curvando para fora
+    curve4.p2 = glm::vec3(8.0f, 0.8f, -12.0f);     // Controle - meio da curva inferior
+    curve4.p3 = glm::vec3(12.0f, 0.8f, -8.0f);     // Fim - baixa direita (volta ao início)
+    curve4.duration = 4.0f;
+    curve4.loop = false;
+    track.curves.push_back(curve4);
+    
+    // Calcular duração total
+    for (const auto& curve : track.curves) {
+        track.totalDuration += curve.duration;
+    }
+    
+    buildArcLengthTable(track);
+    
+    LOG_INFO("Pista embutida: " << track.curves.size() 
+             << " curvas, duracao total=" << track.totalDuration << "s, comprimento="
+             << track.totalLength << " (" << track.arcDistance.size() << " amostras)");
+    std::shared_ptr<const BezierTrack> shared = std::make_shared<const BezierTrack>(std::move(track));
+    std::lock_guard<std::mutex> lock(animationCacheMutex);
+    return trackCache.emplace("<embutida>", shared).first->second;   // Outra thread pode ter criado antes
+}
+
 bool parseAnimationConfig(const std::string& line, ObjectAnimation& animation) {
     std::istringstream iss(line);
     std::string command, type;
@@ -1900,68 +7826,14 @@ bool parseAnimationConfig(const std::string& line, ObjectAnimation& animation) {
             >> animation.bezier.duration;
         animation.bezier.loop = true; // Padrao: loop ativo
         
-        std::cout << "Animacao Bézier configurada: duracao=" << animation.bezier.duration << "s" << std::endl;
+        LOG_INFO("Animacao Bézier configurada: duracao=" << animation.bezier.duration << "s");
         return true;
     }
     else if (type == "track") {
         animation.type = ANIM_BEZIER_TRACK;
-        
-        // Criar pista de drift com pontos de controle realistas
-        // Baseado no formato típico de uma pista de drift oval
-        animation.bezierTrack.curves.clear();
-        animation.bezierTrack.totalDuration = 0.0f;
-        animation.bezierTrack.loop = true;
-        
-        // Trajeto seguindo a geometria real da pista de drift
-        // Baseado em observação da pista: formato mais oval/retangular que circular
-        
-        // Segmento 1: Reta longa lateral direita
-        BezierCurve curve1;
-        curve1.p0 = glm::vec3(12.0f, 0.8f, -8.0f);     // Início - parte baixa direita
-        curve1.p1 = glm::vec3(12.0f, 0.8f, -2.0f);     // Controle - subindo reta
-        curve1.p2 = glm::vec3(12.0f, 0.8f, 2.0f);      // Controle - meio da reta
-        curve1.p3 = glm::vec3(12.0f, 0.8f, 8.0f);      // Fim - parte alta direita
-        curve1.duration = 4.0f;
-        curve1.loop = false;
-        animation.bezierTrack.curves.push_back(curve1);
-        
-        // Segmento 2: Curva superior conectando direita-esquerda
-        BezierCurve curve2;
-        curve2.p0 = glm::vec3(12.0f, 0.8f, 8.0f);      // Início - alta direita
-        curve2.p1 = glm::vec3(8.0f, 0.8f, 12.0f);      // Controle - curvando para fora
-        curve2.p2 = glm::vec3(-8.0f, 0.8f, 12.0f);     // Controle - meio da curva superior
-        curve2.p3 = glm::vec3(-12.0f, 0.8f, 8.0f);     // Fim - alta esquerda
-        curve2.duration = 4.0f;
-        curve2.loop = false;
-        animation.bezierTrack.curves.push_back(curve2);
-        
-        // Segmento 3: Reta longa lateral esquerda
-        BezierCurve curve3;
-        curve3.p0 = glm::vec3(-12.0f, 0.8f, 8.0f);     // Início - parte alta esquerda
-        curve3.p1 = glm::vec3(-12.0f, 0.8f, 2.0f);     // Controle - descendo reta
-        curve3.p2 = glm::vec3(-12.0f, 0.8f, -2.0f);    // Controle - meio da reta
-        curve3.p3 = glm::vec3(-12.0f, 0.8f, -8.0f);    // Fim - parte baixa esquerda
-        curve3.duration = 4.0f;
-        curve3.loop = false;
-        animation.bezierTrack.curves.push_back(curve3);
-        
-        // Segmento 4: Curva inferior conectando esquerda-direita
-        BezierCurve curve4;
-        curve4.p0 = glm::vec3(-12.0f, 0.8f, -8.0f);    // Início - baixa esquerda
-        curve4.p1 = glm::vec3(-8.0f, 0.8f, -12.0f);    // Controle - curvando para fora
-        curve4.p2 = glm::vec3(8.0f, 0.8f, -12.0f);     // Controle - meio da curva inferior
-        curve4.p3 = glm::vec3(12.0f, 0.8f, -8.0f);     // Fim - baixa direita (volta ao início)
-        curve4.duration = 4.0f;
-        curve4.loop = false;
-        animation.bezierTrack.curves.push_back(curve4);
-        
-        // Calcular duração total
-        for (const auto& curve : animation.bezierTrack.curves) {
-            animation.bezierTrack.totalDuration += curve.duration;
-        }
-        
-        std::cout << "Animacao de pista configurada: " << animation.bezierTrack.curves.size() 
-                  << " curvas, duracao total=" << animation.bezierTrack.totalDuration << "s" << std::endl;
+        animation.trackFromMesh = true;   // Resolvida depois de carregar os modelos (resolveMeshTracks)
+        animation.bezierTrack = nullptr;
+        LOG_INFO("Animacao de pista configurada: linha extraida da malha Asphalt");
         return true;
     }
     else if (type == "orbit") {
@@ -1970,15 +7842,957 @@ bool parseAnimationConfig(const std::string& line, ObjectAnimation& animation) {
             >> animation.orbit.radius >> animation.orbit.speed;
         animation.orbit.axis = glm::vec3(0.0f, 1.0f, 0.0f); // Eixo Y padrao
         
-        std::cout << "Animacao orbital configurada: centro=(" << animation.orbit.center.x 
-                  << "," << animation.orbit.center.y << "," << animation.orbit.center.z 
-                  << ") raio=" << animation.orbit.radius << " velocidade=" << animation.orbit.speed << "°/s" << std::endl;
+        LOG_INFO("Animacao orbital configurada: centro=(" << animation.orbit.center.x 
+                 << "," << animation.orbit.center.y << "," << animation.orbit.center.z 
+                 << ") raio=" << animation.orbit.radius << " velocidade=" << animation.orbit.speed << "°/s");
         return true;
     }
     
     return false;
 }
 
+// Carrega uma pista de arquivo texto. Formato (uma diretiva por linha, # comenta):
+//   LOOP 0|1          - repete o percurso (padrao 1)
+//   DURATION s        - tempo de uma volta em segundos
+//   SPEED v           - alternativa a DURATION: unidades por segundo
+//   P x y z           - pontos de controle; a curva i usa os pontos 3i..3i+3 (extremos
+//                       compartilhados), entao o arquivo tem 3n+1 pontos para n curvas
+// A pista e validada e pre-processada uma vez (continuidade, tangentes, tabela de arco)
+// e fica no trackCache para os demais objetos que usarem o mesmo arquivo.
+std::shared_ptr<const BezierTrack> loadTrack(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(animationCacheMutex);
+        auto found = trackCache.find(path);
+        if (found != trackCache.end()) {
+            return found->second;
+        }
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("Arquivo de pista nao encontrado: " << path);
+        return nullptr;
+    }
+    struct stat info;
+    time_t mtime = stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+
+    std::vector<glm::vec3> points;
+    float duration = 0.0f, speed = 0.0f;
+    int loop = 1;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream iss(line);
+        std::string command;
+        if (!(iss >> command) || command[0] == '#') continue;
+
+        bool ok = true;
+        if (command == "P") {
+            glm::vec3 point;
+            ok = (bool)(iss >> point.x >> point.y >> point.z) &&
+                 std::isfinite(point.x) && std::isfinite(point.y) && std::isfinite(point.z);
+            points.push_back(point);
+        } else if (command == "LOOP") {
+            ok = (bool)(iss >> loop);
+        } else if (command == "DURATION") {
+            ok = (bool)(iss >> duration) && duration > 0.0f;
+        } else if (command == "SPEED") {
+            ok = (bool)(iss >> speed) && speed > 0.0f;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            LOG_ERROR(path << ":" << lineNumber << ": linha invalida: " << line);
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<const BezierTrack> track = createTrack(path, std::move(points), loop != 0, duration, speed);
+    if (track) {
+        std::lock_guard<std::mutex> lock(animationCacheMutex);
+        animationFileTimes[path] = mtime;
+    }
+    return track;
+}
+
+// Valida e pre-processa os pontos de controle de uma pista (arquivo ou extraida da malha)
+// e registra o resultado no trackCache com o nome dado
+std::shared_ptr<const BezierTrack> createTrack(const std::string& path, std::vector<glm::vec3> points,
+                                               bool loop, float duration, float speed) {
+    if (points.size() < 4 || (points.size() - 1) % 3 != 0) {
+        LOG_ERROR(path << ": a pista precisa de 3n+1 pontos de controle (tem " << points.size() << ")");
+        return nullptr;
+    }
+    if (duration <= 0.0f && speed <= 0.0f) {
+        LOG_ERROR(path << ": defina DURATION ou SPEED");
+        return nullptr;
+    }
+
+    // Pista fechada: o ultimo ponto precisa coincidir com o primeiro
+    const float EPSILON = 1e-4f;
+    if (loop && length(points.back() - points.front()) > EPSILON) {
+        LOG_WARN(path << ": LOOP com extremos diferentes, fechando a pista no primeiro ponto");
+        points.back() = points.front();
+    }
+
+    BezierTrack track;
+    track.loop = loop;
+    size_t curveCount = (points.size() - 1) / 3;
+    track.curves.resize(curveCount);
+    for (size_t i = 0; i < curveCount; i++) {
+        BezierCurve& curve = track.curves[i];
+        curve.p0 = points[3 * i];
+        curve.p1 = points[3 * i + 1];
+        curve.p2 = points[3 * i + 2];
+        curve.p3 = points[3 * i + 3];
+        curve.loop = false;
+
+        // Tangente nula nos extremos (controle sobre o ponto) deixa a direcao indefinida:
+        // move o controle um terco em direcao ao outro controle, ou ao outro extremo se esse
+        // tambem coincidir. Os dois reparos usam os pontos originais do arquivo.
+        glm::vec3 p1 = points[3 * i + 1], p2 = points[3 * i + 2];
+        if (length(p1 - curve.p0) < EPSILON) {
+            glm::vec3 toward = length(p2 - curve.p0) < EPSILON ? curve.p3 : p2;
+            curve.p1 = curve.p0 + (toward - curve.p0) / 3.0f;
+        }
+        if (length(curve.p3 - p2) < EPSILON) {
+            glm::vec3 toward = length(curve.p3 - p1) < EPSILON ? curve.p0 : p1;
+            curve.p2 = curve.p3 + (toward - curve.p3) / 3.0f;
+        }
+    }
+
+    // Continuidade das tangentes nas juncoes (e no fechamento, se LOOP): so avisa, a
+    // posicao continua correta mas a orientacao do objeto da um salto
+    int corners = 0;
+    for (size_t i = 0; i < curveCount; i++) {
+        if (i + 1 == curveCount && !track.loop) break;
+        const BezierCurve& a = track.curves[i];
+        const BezierCurve& b = track.curves[(i + 1) % curveCount];
+        glm::vec3 tangentIn = a.p3 - a.p2;
+        glm::vec3 tangentOut = b.p1 - b.p0;
+        // Curva de comprimento nulo (os quatro pontos iguais) nao tem tangente para comparar
+        if (length(tangentIn) < EPSILON || length(tangentOut) < EPSILON) continue;
+        if (dot(normalize(tangentIn), normalize(tangentOut)) < 0.99f) corners++;
+    }
+    if (corners > 0) {
+        LOG_WARN(path << ": " << corners << " juncoes sem continuidade de tangente");
+    }
+
+    buildArcLengthTable(track);
+    track.totalDuration = duration > 0.0f ? duration : (float)(track.totalLength / speed);
+    for (BezierCurve& curve : track.curves) {
+        curve.duration = track.totalDuration / curveCount;  // So usado sem tabela de arco
+    }
+
+    LOG_INFO("Pista " << path << ": " << curveCount << " curvas, comprimento=" << track.totalLength
+             << ", volta=" << track.totalDuration << "s (" << track.arcDistance.size() << " amostras)");
+    std::shared_ptr<const BezierTrack> shared = std::make_shared<const BezierTrack>(std::move(track));
+    std::lock_guard<std::mutex> lock(animationCacheMutex);
+    trackCache[path] = shared;
+    return shared;
+}
+
+static PackedQuat packQuat(glm::quat q) {
+    const float RANGE = 0.70710678f;
+    q = normalize(q);
+    float components[4] = { q.x, q.y, q.z, q.w };
+    int largest = 0;
+    for (int k = 1; k < 4; k++) {
+        if (fabs(components[k]) > fabs(components[largest])) largest = k;
+    }
+    float sign = components[largest] < 0.0f ? -1.0f : 1.0f;   // q e -q sao a mesma rotacao
+
+    PackedQuat packed;
+    int j = 0;
+    for (int k = 0; k < 4; k++) {
+        if (k == largest) continue;
+        float normalized = glm::clamp(sign * components[k] / RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+        packed.data[j++] = (uint16_t)lroundf(normalized * 32767.0f);
+    }
+    packed.data[0] |= (uint16_t)((largest & 1) << 15);
+    packed.data[1] |= (uint16_t)((largest >> 1) << 15);
+    return packed;
+}
+
+static glm::quat unpackQuat(const PackedQuat& packed) {
+    const float RANGE = 0.70710678f;
+    int largest = (packed.data[0] >> 15) | ((packed.data[1] >> 15) << 1);
+    float components[4];
+    float sumSquares = 0.0f;
+    int j = 0;
+    for (int k = 0; k < 4; k++) {
+        if (k == largest) continue;
+        float value = ((packed.data[j++] & 0x7FFF) / 32767.0f * 2.0f - 1.0f) * RANGE;
+        components[k] = value;
+        sumSquares += value * value;
+    }
+    components[largest] = sqrtf(std::max(0.0f, 1.0f - sumSquares));
+    return glm::quat(components[3], components[0], components[1], components[2]);
+}
+
+// Interpolacao normalizada pelo menor arco (erro desprezivel entre chaves proximas)
+static glm::quat nlerpQuat(const glm::quat& a, glm::quat b, float t) {
+    if (dot(a, b) < 0.0f) b = -b;
+    return normalize(a * (1.0f - t) + b * t);
+}
+
+// Angulo entre duas rotacoes; atan2 das normas da diferenca e da soma e estavel para
+// angulos pequenos (acos do produto escalar perde precisao perto de 1)
+static float quatAngleDegrees(const glm::quat& a, glm::quat b) {
+    if (dot(a, b) < 0.0f) b = -b;
+    return 4.0f * atan2f(length(a + (-b)), length(a + b)) * 180.0f / (float)M_PI;
+}
+
+// Angulos de Euler (graus) na ordem de computeModelMatrix: R = Rx * Ry * Rz
+static glm::vec3 quatToModelEuler(const glm::quat& q) {
+    glm::mat3 m = glm::mat3_cast(q);
+    float sinY = glm::clamp(m[2][0], -1.0f, 1.0f);
+    glm::vec3 angles;
+    angles.y = asinf(sinY);
+    if (fabs(sinY) < 0.999999f) {
+        angles.x = atan2f(-m[2][1], m[2][2]);
+        angles.z = atan2f(-m[1][0], m[0][0]);
+    } else {
+        angles.x = atan2f(m[1][2], m[1][1]);   // Gimbal lock: Z absorvido por X
+        angles.z = 0.0f;
+    }
+    return angles * (180.0f / (float)M_PI);
+}
+
+static glm::quat modelEulerToQuat(const glm::vec3& degrees) {
+    glm::vec3 r = glm::radians(degrees);
+    return glm::angleAxis(r.x, glm::vec3(1.0f, 0.0f, 0.0f)) *
+           glm::angleAxis(r.y, glm::vec3(0.0f, 1.0f, 0.0f)) *
+           glm::angleAxis(r.z, glm::vec3(0.0f, 0.0f, 1.0f));
+}
+
+// Mantem so as chaves que a interpolacao entre as vizinhas mantidas nao reproduz dentro
+// da tolerancia (Douglas-Peucker sobre o tempo): divide cada segmento na chave de maior
+// erro ate que todas as intermediarias caibam. Pilha explicita, sem recursao.
+template <typename T, typename Interpolate, typename Error>
+static void reduceKeys(const std::vector<float>& times, const std::vector<T>& values, float tolerance,
+                       Interpolate interpolate, Error error,
+                       std::vector<float>& outTimes, std::vector<T>& outValues) {
+    size_t count = times.size();
+    outTimes.clear();
+    outValues.clear();
+    if (count == 0) return;
+
+    std::vector<char> keep(count, 0);
+    keep[0] = keep[count - 1] = 1;
+    std::vector<std::pair<size_t, size_t>> segments;
+    segments.push_back({ 0, count - 1 });
+    while (!segments.empty()) {
+        size_t first = segments.back().first, last = segments.back().second;
+        segments.pop_back();
+        float span = times[last] - times[first];
+        float worstError = tolerance;
+        size_t worst = 0;
+        for (size_t k = first + 1; k < last; k++) {
+            float t = span > 0.0f ? (times[k] - times[first]) / span : 0.0f;
+            float e = error(interpolate(values[first], values[last], t), values[k]);
+            if (e > worstError) {
+                worstError = e;
+                worst = k;
+            }
+        }
+        if (worst != 0) {
+            keep[worst] = 1;
+            segments.push_back({ first, worst });
+            segments.push_back({ worst, last });
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (keep[i]) {
+            outTimes.push_back(times[i]);
+            outValues.push_back(values[i]);
+        }
+    }
+    // Canal constante: uma chave basta
+    if (outValues.size() == 2 && error(outValues[0], outValues[1]) <= tolerance) {
+        outTimes.pop_back();
+        outValues.pop_back();
+    }
+}
+
+// Indice i do segmento [times[i], times[i+1]) que contem time. Comeca no cursor (proxima
+// chave na reproducao sequencial) e so cai na busca binaria em saltos ou voltas do loop.
+static size_t seekKey(const std::vector<float>& times, float time, size_t& cursor) {
+    size_t count = times.size();
+    if (count < 2) return 0;
+    size_t i = std::min(cursor, count - 2);
+    if (times[i] <= time) {
+        if (time < times[i + 1] || i == count - 2) return cursor = i;
+        if (i + 2 < count && time < times[i + 2]) return cursor = i + 1;
+    }
+    size_t upper = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+    cursor = std::min(upper == 0 ? 0 : upper - 1, count - 2);
+    return cursor;
+}
+
+static float segmentFraction(const std::vector<float>& times, size_t i, float time) {
+    if (times.size() < 2) return 0.0f;
+    float span = times[i + 1] - times[i];
+    return span > 0.0f ? glm::clamp((time - times[i]) / span, 0.0f, 1.0f) : 0.0f;
+}
+
+// Escreve a transformacao da trilha no instante time (segundos) no modelo
+void sampleKeyframeTrack(const KeyframeTrack& track, float time, KeyframeCursor& cursor, Model& out) {
+    if (track.loop && track.duration > 0.0f) {
+        time = fmod(time, track.duration);
+    }
+    time = glm::clamp(time, 0.0f, track.duration);
+
+    if (!track.positions.empty()) {
+        size_t i = seekKey(track.positionTimes, time, cursor.position);
+        out.position = track.positions.size() < 2 ? track.positions[0]
+            : glm::mix(track.positions[i], track.positions[i + 1], segmentFraction(track.positionTimes, i, time));
+    }
+    if (!track.rotations.empty()) {
+        size_t i = seekKey(track.rotationTimes, time, cursor.rotation);
+        glm::quat rotation = unpackQuat(track.rotations[i]);
+        if (track.rotations.size() >= 2) {
+            rotation = nlerpQuat(rotation, unpackQuat(track.rotations[i + 1]), segmentFraction(track.rotationTimes, i, time));
+        }
+        out.rotation = quatToModelEuler(rotation);
+    }
+    if (!track.scales.empty()) {
+        size_t i = seekKey(track.scaleTimes, time, cursor.scale);
+        out.scale = track.scales.size() < 2 ? track.scales[0]
+            : glm::mix(track.scales[i], track.scales[i + 1], segmentFraction(track.scaleTimes, i, time));
+    }
+}
+
+// Carrega uma trilha de keyframes de arquivo texto (uma diretiva por linha, # comenta):
+//   LOOP 0|1                   - repete a trilha (padrao 1)
+//   TOLERANCE pos graus escala - erro maximo aceito ao descartar chaves (padrao 0.001 0.1 0.001)
+//   K t x y z rx ry rz sx sy sz     - chave com rotacao em graus (mesma ordem do OBJECT)
+//   Q t x y z qw qx qy qz sx sy sz  - chave com rotacao em quaternion (ex.: telemetria)
+// Os tempos devem ser crescentes. A trilha e comprimida uma vez e compartilhada pelo
+// keyframeCache entre os objetos que usam o mesmo arquivo.
+std::shared_ptr<const KeyframeTrack> loadKeyframeTrack(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(animationCacheMutex);
+        auto found = keyframeCache.find(path);
+        if (found != keyframeCache.end()) {
+            return found->second;
+        }
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("Arquivo de keyframes nao encontrado: " << path);
+        return nullptr;
+    }
+    struct stat info;
+    time_t mtime = stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+
+    std::vector<float> times;
+    std::vector<glm::vec3> positions, scales;
+    std::vector<glm::quat> rotations;
+    glm::vec3 tolerance(0.001f, 0.1f, 0.001f);
+    int loop = 1;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream iss(line);
+        std::string command;
+        if (!(iss >> command) || command[0] == '#') continue;
+
+        bool ok = true;
+        if (command == "K" || command == "Q") {
+            float time;
+            glm::vec3 position, scale;
+            glm::quat rotation;
+            ok = (bool)(iss >> time >> position.x >> position.y >> position.z);
+            if (ok && command == "K") {
+                glm::vec3 euler;
+                ok = (bool)(iss >> euler.x >> euler.y >> euler.z);
+                rotation = modelEulerToQuat(euler);
+            } else if (ok) {
+                ok = (bool)(iss >> rotation.w >> rotation.x >> rotation.y >> rotation.z) && length(rotation) > 1e-6f;
+            }
+            ok = ok && (bool)(iss >> scale.x >> scale.y >> scale.z) &&
+                 std::isfinite(time) && (times.empty() || time > times.back());
+            times.push_back(time);
+            positions.push_back(position);
+            rotations.push_back(ok ? normalize(rotation) : rotation);
+            scales.push_back(scale);
+        } else if (command == "LOOP") {
+            ok = (bool)(iss >> loop);
+        } else if (command == "TOLERANCE") {
+            ok = (bool)(iss >> tolerance.x >> tolerance.y >> tolerance.z);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            LOG_ERROR(path << ":" << lineNumber << ": linha invalida: " << line);
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<const KeyframeTrack> track = createKeyframeTrack(path, times, positions, rotations, scales,
+                                                                     loop != 0, tolerance);
+    if (track) {
+        std::lock_guard<std::mutex> lock(animationCacheMutex);
+        animationFileTimes[path] = mtime;
+    }
+    return track;
+}
+
+// Tira dos caches as pistas e trilhas cujo arquivo mudou (ou sumiu) desde a leitura: a
+// recarga da configuracao le de novo o TRACK/KEYFRAMES editado. Objetos que ainda usam a
+// versao antiga a mantem viva pelo shared_ptr ate receberem a nova.
+void evictChangedAnimationFiles() {
+    std::lock_guard<std::mutex> lock(animationCacheMutex);
+    for (auto it = animationFileTimes.begin(); it != animationFileTimes.end();) {
+        struct stat info;
+        if (stat(it->first.c_str(), &info) == 0 && info.st_mtime == it->second) {
+            ++it;
+            continue;
+        }
+        LOG_INFO("Hot reload: " << it->first << " mudou, sera lido de novo");
+        trackCache.erase(it->first);
+        keyframeCache.erase(it->first);
+        it = animationFileTimes.erase(it);
+    }
+}
+
+// Reduz e quantiza as chaves (tolerancia: posicao, graus, escala) e registra a trilha no
+// keyframeCache com o nome dado
+std::shared_ptr<const KeyframeTrack> createKeyframeTrack(const std::string& name, const std::vector<float>& times,
+                                                         const std::vector<glm::vec3>& positions,
+                                                         const std::vector<glm::quat>& rotations,
+                                                         const std::vector<glm::vec3>& scales, bool loop,
+                                                         const glm::vec3& tolerance) {
+    if (times.empty()) {
+        LOG_ERROR(name << ": trilha de keyframes sem chaves");
+        return nullptr;
+    }
+
+    auto mixVec3 = [](const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); };
+    auto vec3Error = [](const glm::vec3& a, const glm::vec3& b) { return length(a - b); };
+
+    auto track = std::make_shared<KeyframeTrack>();
+    track->loop = loop;
+    track->duration = times.back();
+    reduceKeys(times, positions, tolerance.x, mixVec3, vec3Error, track->positionTimes, track->positions);
+    reduceKeys(times, scales, tolerance.z, mixVec3, vec3Error, track->scaleTimes, track->scales);
+
+    // A reducao da rotacao compara contra o valor ja quantizado, que e o que sera reproduzido
+    std::vector<glm::quat> quantized(rotations.size());
+    for (size_t i = 0; i < rotations.size(); i++) quantized[i] = unpackQuat(packQuat(rotations[i]));
+    std::vector<glm::quat> keptRotations;
+    reduceKeys(times, quantized, tolerance.y, nlerpQuat, quatAngleDegrees, track->rotationTimes, keptRotations);
+    track->rotations.reserve(keptRotations.size());
+    for (const glm::quat& rotation : keptRotations) track->rotations.push_back(packQuat(rotation));
+
+    size_t rawBytes = times.size() * (sizeof(float) + 2 * sizeof(glm::vec3) + sizeof(glm::quat));
+    size_t packedBytes = track->positions.size() * (sizeof(float) + sizeof(glm::vec3)) +
+                         track->rotations.size() * (sizeof(float) + sizeof(PackedQuat)) +
+                         track->scales.size() * (sizeof(float) + sizeof(glm::vec3));
+    LOG_INFO("Keyframes " << name << ": " << times.size() << " chaves -> posicao " << track->positions.size()
+             << ", rotacao " << track->rotations.size() << ", escala " << track->scales.size()
+             << " (" << rawBytes << " -> " << packedBytes << " bytes)");
+
+    std::shared_ptr<const KeyframeTrack> shared = track;
+    std::lock_guard<std::mutex> lock(animationCacheMutex);
+    keyframeCache[name] = shared;
+    return shared;
+}
+
+// Microbenchmark de keyframes: 500 motos com 60 s de telemetria sintetica a 100 Hz.
+// Mede compressao, reproducao sequencial (cursor) e acesso aleatorio (busca binaria).
+void runKeyframeMicrobenchmark() {
+    const int BIKES = 500;
+    const int SAMPLES = 6000;
+    const float RATE = 100.0f;
+    const int FRAMES = 600;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<ObjectAnimation> bikes(BIKES);
+    size_t rawKeys = 0, keptKeys = 0;
+    float maxPositionError = 0.0f, maxRotationError = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> times(SAMPLES);
+    std::vector<glm::vec3> positions(SAMPLES), scales(SAMPLES, glm::vec3(1.2f));
+    std::vector<glm::quat> rotations(SAMPLES);
+    for (int b = 0; b < BIKES; b++) {
+        // Volta em oval com retas (chaves redundantes) e curvas com inclinacao
+        float radius = 40.0f + 10.0f * unit(rng), phase = unit(rng) * 6.2831853f;
+        for (int s = 0; s < SAMPLES; s++) {
+            float t = s / RATE;
+            float angle = phase + t * 0.5f;
+            float straight = glm::clamp(cosf(angle) * 3.0f, -1.0f, 1.0f);
+            times[s] = t;
+            positions[s] = glm::vec3(radius * straight, 0.8f, radius * 0.5f * sinf(angle));
+            float lean = 40.0f * (1.0f - fabs(straight));
+            rotations[s] = modelEulerToQuat(glm::vec3(-90.0f, angle * 57.29578f, lean));
+        }
+        std::string name = "<telemetria " + std::to_string(b) + ">";
+        bikes[b].type = ANIM_LINEAR;
+        bikes[b].keyframes = createKeyframeTrack(name, times, positions, rotations, scales, true,
+                                                 glm::vec3(0.01f, 0.25f, 0.001f));
+        const KeyframeTrack& track = *bikes[b].keyframes;
+        rawKeys += 3 * SAMPLES;
+        keptKeys += track.positions.size() + track.rotations.size() + track.scales.size();
+
+        // Erro de reconstrucao nas chaves originais (a ultima coincide com o inicio do loop)
+        KeyframeCursor cursor;
+        Model probe;
+        for (int s = 0; s < SAMPLES - 1; s += 7) {
+            sampleKeyframeTrack(track, times[s], cursor, probe);
+            maxPositionError = std::max(maxPositionError, length(probe.position - positions[s]));
+            maxRotationError = std::max(maxRotationError, quatAngleDegrees(modelEulerToQuat(probe.rotation), rotations[s]));
+        }
+    }
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<Model> out(BIKES);
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        float time = frame / 60.0f;
+        for (int b = 0; b < BIKES; b++) {
+            sampleKeyframeTrack(*bikes[b].keyframes, time, bikes[b].cursor, out[b]);
+        }
+    }
+    double sequentialNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (FRAMES * BIKES);
+
+    std::vector<float> randomTimes(FRAMES);
+    for (float& t : randomTimes) t = unit(rng) * SAMPLES / RATE;
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        for (int b = 0; b < BIKES; b++) {
+            sampleKeyframeTrack(*bikes[b].keyframes, randomTimes[frame], bikes[b].cursor, out[b]);
+        }
+    }
+    double randomNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (FRAMES * BIKES);
+
+    LOG_INFO("Microbenchmark de keyframes: " << BIKES << " motos x " << SAMPLES << " amostras");
+    LOG_INFO("  compressao: " << rawKeys << " -> " << keptKeys << " chaves em " << buildMs << " ms");
+    LOG_INFO("  erro maximo: posicao " << maxPositionError << ", rotacao " << maxRotationError << " graus");
+    LOG_INFO("  reproducao sequencial: " << sequentialNs << " ns/amostra");
+    LOG_INFO("  acesso aleatorio: " << randomNs << " ns/amostra");
+    std::lock_guard<std::mutex> lock(animationCacheMutex);
+    for (int b = 0; b < BIKES; b++) {
+        keyframeCache.erase("<telemetria " + std::to_string(b) + ">");
+    }
+}
+
+// Grava uma pista no formato do TRACK (usado como cache da linha extraida da malha, com a
+// chave do cache num comentario "# CHAVE")
+bool writeTrackFile(const std::string& path, const std::vector<glm::vec3>& points, bool loop, float speed,
+                    const std::string& cacheKey) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (out == NULL) {
+        return false;
+    }
+    fprintf(out, "# Linha central extraida da malha (gerada automaticamente)\n");
+    if (!cacheKey.empty()) {
+        fprintf(out, "# CHAVE %s\n", cacheKey.c_str());
+    }
+    fprintf(out, "LOOP %d\nSPEED %.4f\n", loop ? 1 : 0, speed);
+    for (const glm::vec3& point : points) {
+        fprintf(out, "P %.5f %.5f %.5f\n", point.x, point.y, point.z);
+    }
+    fclose(out);
+    return true;
+}
+
+// Parametros da linha extraida da malha (ANIMATION track); entram na chave do cache
+const float RACING_LINE_SPEED = 6.0f;     // Unidades por segundo (~ volta do oval em 16 s)
+const float RACING_LINE_ERROR = 0.05f;    // Distancia maxima entre a Bézier e a linha
+const int RACING_LINE_SLICES = 256;       // Setores angulares da extracao
+const char* const RACING_LINE_CACHE_DIR = "racingline";  // No diretorio de execucao (build), fora de assets/
+
+// Linha central da parte "Asphalt" em coordenadas de mundo (modelMatrix). A pista e fatiada
+// em setores angulares em torno do centroide (plano XZ); em cada setor o ponto medio entre
+// a borda interna e a externa do asfalto e um ponto da linha. Supoe uma pista que da uma
+// volta em torno do centro (oval, circuito sem cruzamentos).
+bool extractTrackCenterline(const Model& model, const mat4& modelMatrix, std::vector<glm::vec3>& centerline) {
+    const int SLICES = RACING_LINE_SLICES;
+    const float SLICE_ANGLE = 2.0f * (float)M_PI / SLICES;
+
+    std::vector<glm::vec3> triangles;
+    for (const ModelPart& part : model.parts) {
+        if (part.materialName != "Asphalt") continue;
+        for (const glm::vec3& vertex : part.vertices) {
+            triangles.push_back(glm::vec3(modelMatrix * glm::vec4(vertex, 1.0f)));
+        }
+    }
+    if (triangles.size() < 3) {
+        return false;
+    }
+
+    glm::vec3 center(0.0f);
+    for (const glm::vec3& vertex : triangles) center += vertex;
+    center /= (float)triangles.size();
+
+    // Raio minimo/maximo do asfalto por setor. As arestas sao amostradas a cada meio
+    // setor para que triangulos grandes tambem marquem os setores que atravessam.
+    std::vector<float> innerRadius(SLICES, FLT_MAX), outerRadius(SLICES, 0.0f);
+    auto addPoint = [&](const glm::vec3& point) {
+        float dx = point.x - center.x, dz = point.z - center.z;
+        float angle = atan2(dz, dx);
+        int slice = (int)floor((angle + (float)M_PI) / SLICE_ANGLE) % SLICES;
+        float radius = sqrt(dx * dx + dz * dz);
+        innerRadius[slice] = std::min(innerRadius[slice], radius);
+        outerRadius[slice] = std::max(outerRadius[slice], radius);
+    };
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        for (int edge = 0; edge < 3; edge++) {
+            const glm::vec3& a = triangles[i + edge];
+            const glm::vec3& b = triangles[i + (edge + 1) % 3];
+            float angleA = atan2(a.z - center.z, a.x - center.x);
+            float angleB = atan2(b.z - center.z, b.x - center.x);
+            float span = fabs(fmod(angleB - angleA + 3.0f * (float)M_PI, 2.0f * (float)M_PI) - (float)M_PI);
+            int steps = std::min(1 + (int)(span / (0.5f * SLICE_ANGLE)), SLICES);
+            for (int k = 0; k <= steps; k++) {
+                addPoint(glm::mix(a, b, (float)k / steps));
+            }
+        }
+    }
+
+    // Setores vazios (buracos na malha) usam os vizinhos preenchidos mais proximos
+    std::vector<float> middle(SLICES, -1.0f);
+    int filled = 0;
+    for (int i = 0; i < SLICES; i++) {
+        if (outerRadius[i] > 0.0f) {
+            middle[i] = 0.5f * (innerRadius[i] + outerRadius[i]);
+            filled++;
+        }
+    }
+    if (filled < SLICES / 4) {
+        return false;
+    }
+    for (int i = 0; i < SLICES; i++) {
+        if (middle[i] >= 0.0f) continue;
+        int before = 1, after = 1;
+        while (middle[(i - before + SLICES) % SLICES] < 0.0f) before++;
+        while (middle[(i + after) % SLICES] < 0.0f) after++;
+        float a = middle[(i - before + SLICES) % SLICES], b = middle[(i + after) % SLICES];
+        middle[i] = a + (b - a) * before / (float)(before + after);
+    }
+
+    // Suaviza o raio (filtro 1-2-1 circular) para tirar o serrilhado dos triangulos
+    for (int pass = 0; pass < 4; pass++) {
+        std::vector<float> smoothed(SLICES);
+        for (int i = 0; i < SLICES; i++) {
+            smoothed[i] = 0.25f * middle[(i + SLICES - 1) % SLICES] + 0.5f * middle[i] + 0.25f * middle[(i + 1) % SLICES];
+        }
+        middle.swap(smoothed);
+    }
+
+    centerline.resize(SLICES);
+    for (int i = 0; i < SLICES; i++) {
+        float angle = -(float)M_PI + (i + 0.5f) * SLICE_ANGLE;
+        centerline[i] = glm::vec3(center.x + middle[i] * cos(angle), center.y, center.z + middle[i] * sin(angle));
+    }
+    return true;
+}
+
+// Ajuste de Bézier cúbicas a uma polilinha (Schneider, "An Algorithm for Automatically
+// Fitting Digitized Curves", Graphics Gems): minimos quadrados com as tangentes dos
+// extremos fixas, reparametrizacao por Newton e divisao no ponto de maior erro.
+static glm::vec3 fitBezierPoint(const glm::vec3 bezier[4], float t) {
+    BezierCurve curve = { bezier[0], bezier[1], bezier[2], bezier[3], 1.0f, false };
+    return bezierPoint(curve, t);
+}
+
+static void fitBezierGenerate(const std::vector<glm::vec3>& d, int first, int last, const std::vector<float>& u,
+                              const glm::vec3& tHat1, const glm::vec3& tHat2, glm::vec3 bezier[4]) {
+    float c[2][2] = { { 0.0f, 0.0f }, { 0.0f, 0.0f } };
+    float x[2] = { 0.0f, 0.0f };
+    for (int i = 0; i <= last - first; i++) {
+        float t = u[i], s = 1.0f - t;
+        float b0 = s * s * s, b1 = 3.0f * t * s * s, b2 = 3.0f * t * t * s, b3 = t * t * t;
+        glm::vec3 a1 = tHat1 * b1, a2 = tHat2 * b2;
+        c[0][0] += dot(a1, a1);
+        c[0][1] += dot(a1, a2);
+        c[1][1] += dot(a2, a2);
+        glm::vec3 tmp = d[first + i] - (d[first] * (b0 + b1) + d[last] * (b2 + b3));
+        x[0] += dot(a1, tmp);
+        x[1] += dot(a2, tmp);
+    }
+    c[1][0] = c[0][1];
+
+    float detC = c[0][0] * c[1][1] - c[1][0] * c[0][1];
+    float alphaL = detC != 0.0f ? (x[0] * c[1][1] - x[1] * c[0][1]) / detC : 0.0f;
+    float alphaR = detC != 0.0f ? (c[0][0] * x[1] - c[1][0] * x[0]) / detC : 0.0f;
+
+    // Solucao degenerada: volta para a heuristica de um terco da corda
+    float segmentLength = length(d[last] - d[first]);
+    float epsilon = 1e-6f * segmentLength;
+    if (alphaL < epsilon || alphaR < epsilon) {
+        alphaL = alphaR = segmentLength / 3.0f;
+    }
+    bezier[0] = d[first];
+    bezier[3] = d[last];
+    bezier[1] = bezier[0] + tHat1 * alphaL;
+    bezier[2] = bezier[3] + tHat2 * alphaR;
+}
+
+static float fitBezierMaxError(const std::vector<glm::vec3>& d, int first, int last, const glm::vec3 bezier[4],
+                               const std::vector<float>& u, int& splitPoint) {
+    float maxDistance = 0.0f;
+    splitPoint = (last - first + 1) / 2 + first;
+    for (int i = first + 1; i < last; i++) {
+        glm::vec3 diff = fitBezierPoint(bezier, u[i - first]) - d[i];
+        float distance = dot(diff, diff);
+        if (distance >= maxDistance) {
+            maxDistance = distance;
+            splitPoint = i;
+        }
+    }
+    return maxDistance;
+}
+
+static void fitBezierRange(const std::vector<glm::vec3>& d, int first, int last, glm::vec3 tHat1, glm::vec3 tHat2,
+                           float maxError, std::vector<glm::vec3>& controlPoints) {
+    glm::vec3 bezier[4];
+    float errorSquared = maxError * maxError;
+
+    if (last - first == 1) {
+        float distance = length(d[last] - d[first]) / 3.0f;
+        controlPoints.push_back(d[first] + tHat1 * distance);
+        controlPoints.push_back(d[last] + tHat2 * distance);
+        controlPoints.push_back(d[last]);
+        return;
+    }
+
+    // Parametrizacao inicial pelo comprimento da corda
+    std::vector<float> u(last - first + 1, 0.0f);
+    for (int i = first + 1; i <= last; i++) {
+        u[i - first] = u[i - first - 1] + length(d[i] - d[i - 1]);
+    }
+    for (float& value : u) value /= u.back();
+
+    fitBezierGenerate(d, first, last, u, tHat1, tHat2, bezier);
+    int splitPoint;
+    float error = fitBezierMaxError(d, first, last, bezier, u, splitPoint);
+
+    // Erro moderado: tenta melhorar os parametros antes de dividir
+    if (error >= errorSquared && error < 4.0f * errorSquared) {
+        for (int iteration = 0; iteration < 4; iteration++) {
+            BezierCurve curve = { bezier[0], bezier[1], bezier[2], bezier[3], 1.0f, false };
+            for (int i = first; i <= last; i++) {
+                float t = u[i - first];
+                glm::vec3 q = bezierPoint(curve, t), q1 = bezierDerivative(curve, t);
+                float tu = 1.0f - t;
+                glm::vec3 q2 = 6.0f * tu * (bezier[2] - 2.0f * bezier[1] + bezier[0]) + 6.0f * t * (bezier[3] - 2.0f * bezier[2] + bezier[1]);
+                float denominator = dot(q1, q1) + dot(q - d[i], q2);
+                if (denominator != 0.0f) {
+                    u[i - first] = glm::clamp(t - dot(q - d[i], q1) / denominator, 0.0f, 1.0f);
+                }
+            }
+            fitBezierGenerate(d, first, last, u, tHat1, tHat2, bezier);
+            error = fitBezierMaxError(d, first, last, bezier, u, splitPoint);
+            if (error < errorSquared) break;
+        }
+    }
+
+    if (error < errorSquared) {
+        controlPoints.push_back(bezier[1]);
+        controlPoints.push_back(bezier[2]);
+        controlPoints.push_back(bezier[3]);
+        return;
+    }
+
+    // Divide no ponto de maior erro com tangente central compartilhada (continuidade C1)
+    glm::vec3 tHatCenter = normalize(d[splitPoint - 1] - d[splitPoint + 1]);
+    fitBezierRange(d, first, splitPoint, tHat1, tHatCenter, maxError, controlPoints);
+    fitBezierRange(d, splitPoint, last, -tHatCenter, tHat2, maxError, controlPoints);
+}
+
+// Ajusta uma pista fechada: a polilinha e aberta no primeiro ponto, que recebe a mesma
+// tangente nos dois extremos. Saida no formato do TRACK (3n+1 pontos de controle).
+void fitBezierPath(const std::vector<glm::vec3>& points, float maxError, std::vector<glm::vec3>& controlPoints) {
+    controlPoints.clear();
+    if (points.size() < 3) {
+        return;
+    }
+    std::vector<glm::vec3> closed(points);
+    closed.push_back(points.front());
+    glm::vec3 tangent = normalize(points[1] - points.back());
+
+    controlPoints.push_back(closed.front());
+    fitBezierRange(closed, 0, (int)closed.size() - 1, tangent, -tangent, maxError, controlPoints);
+}
+
+// Arquivo de cache da linha de um OBJ: nome do OBJ mais um hash do caminho completo
+// (OBJs de mesmo nome em pastas diferentes nao colidem)
+static std::string racingLineCachePath(const std::string& objPath) {
+    uint32_t hash = 2166136261u;              // FNV-1a
+    for (char c : objPath) {
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    }
+    size_t slash = objPath.find_last_of("/\\");
+    std::string base = objPath.substr(slash == std::string::npos ? 0 : slash + 1);
+    size_t dot = base.find_last_of('.');
+    if (dot != std::string::npos) {
+        base.resize(dot);
+    }
+    char suffix[24];
+    snprintf(suffix, sizeof(suffix), "-%08x.track", hash);
+    return std::string(RACING_LINE_CACHE_DIR) + "/" + base + suffix;
+}
+
+// Chave do cache: tudo de que a linha depende (OBJ e a data dele, matriz de modelo e
+// parametros do ajuste). Mover, girar ou escalar a pista muda a chave e refaz o ajuste.
+static std::string racingLineCacheKey(const std::string& objPath, const mat4& modelMatrix) {
+    struct stat objStat;
+    long long mtime = stat(objPath.c_str(), &objStat) == 0 ? (long long)objStat.st_mtime : 0;
+    char text[128];
+    snprintf(text, sizeof(text), " mtime=%lld erro=%g fatias=%d velocidade=%g matriz=", mtime,
+             RACING_LINE_ERROR, RACING_LINE_SLICES, RACING_LINE_SPEED);
+    std::string key = "obj=" + objPath + text;
+    const float* m = value_ptr(modelMatrix);
+    for (int i = 0; i < 16; i++) {
+        snprintf(text, sizeof(text), i ? ",%.6g" : "%.6g", m[i]);
+        key += text;
+    }
+    return key;
+}
+
+// Chave gravada no cache (linha "# CHAVE" do cabecalho); vazia se nao houver
+static std::string readRacingLineCacheKey(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line) && !line.empty() && line[0] == '#') {
+        if (line.compare(0, 8, "# CHAVE ") == 0) {
+            return line.substr(8);
+        }
+    }
+    return "";
+}
+
+// Linha da pista de um modelo com parte Asphalt na posicao dada por modelMatrix: vem do
+// cache em RACING_LINE_CACHE_DIR se a chave bater, senao e extraida, ajustada e gravada.
+// Retorna nullptr se a malha nao permitir a extracao.
+std::shared_ptr<const BezierTrack> fitRacingLine(const Model& model, const std::string& objPath, const mat4& modelMatrix) {
+    std::string cachePath = racingLineCachePath(objPath);
+    std::string key = racingLineCacheKey(objPath, modelMatrix);
+    if (readRacingLineCacheKey(cachePath) == key) {
+        std::shared_ptr<const BezierTrack> cached = loadTrack(cachePath);
+        if (cached) {
+            return cached;
+        }
+    }
+
+    PROFILE_SCOPE("Racing line fit");
+    auto start = std::chrono::steady_clock::now();
+    std::vector<glm::vec3> centerline, controlPoints;
+    if (!extractTrackCenterline(model, modelMatrix, centerline)) {
+        return nullptr;
+    }
+    fitBezierPath(centerline, RACING_LINE_ERROR, controlPoints);
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("Linha central extraida de " << objPath << ": " << (controlPoints.size() - 1) / 3
+             << " curvas em " << elapsedMs << " ms");
+
+    // Sem o arquivo gravado, um cache antigo com a mesma chave nao pode sobrar
+    if (!ensureDirectory(RACING_LINE_CACHE_DIR) ||
+        !writeTrackFile(cachePath, controlPoints, true, RACING_LINE_SPEED, key)) {
+        LOG_WARN("Nao foi possivel gravar o cache da linha da pista em " << cachePath);
+        std::remove(cachePath.c_str());
+    }
+    // createTrack substitui a entrada do trackCache; loadTrack devolveria a linha anterior
+    return createTrack(cachePath, std::move(controlPoints), true, 0.0f, RACING_LINE_SPEED);
+}
+
+// Malha que pode servir de pista (tem parte Asphalt)
+bool hasAsphaltPart(const Model& model) {
+    for (const ModelPart& part : model.parts) {
+        if (part.materialName == "Asphalt") {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A malha de onde sai a linha de alguma "ANIMATION track" guarda as posicoes das partes
+// Asphalt na CPU (releaseMeshCopies), para a linha poder ser extraida de novo numa recarga
+void keepTrackPositions(Model& model) {
+    for (ModelPart& part : model.parts) {
+        part.keepPositions = part.keepPositions || part.materialName == "Asphalt";
+    }
+}
+
+// Linha da pista da malha com Asphalt (fitRacingLine) ou, se a extracao falhar, o oval
+// embutido, avisando o motivo. Roda na carga inicial e na thread de recarga.
+std::shared_ptr<const BezierTrack> meshRacingLine(const Model& model, const std::string& objPath, const mat4& modelMatrix) {
+    std::shared_ptr<const BezierTrack> track = fitRacingLine(model, objPath, modelMatrix);
+    if (track) {
+        return track;
+    }
+    bool released = false;
+    for (const ModelPart& part : model.parts) {
+        released = released || (part.materialName == "Asphalt" && part.VAO != 0 && part.vertices.empty());
+    }
+    if (released) {
+        LOG_ERROR("Linha da pista de " << objPath << " sem cache valido (" << racingLineCachePath(objPath)
+                  << ") e a malha ja foi liberada da CPU (--residency gpu): usando o oval embutido."
+                  << " Rode com --residency cpu ou compact para extrair de novo");
+    } else {
+        LOG_WARN("Nao foi possivel extrair a linha central de " << objPath);
+    }
+    return builtinDriftTrack();
+}
+
+// Resolve as animacoes "ANIMATION track": a pista vem da parte Asphalt da primeira malha
+// que a tiver (fitRacingLine, com cache por OBJ e posicao). Sem Asphalt, usa o oval embutido.
+void resolveMeshTracks() {
+    bool needed = false;
+    for (const ObjectAnimation& animation : objectAnimations) {
+        needed = needed || (animation.trackFromMesh && !animation.bezierTrack);
+    }
+    if (!needed) {
+        return;
+    }
+
+    std::shared_ptr<const BezierTrack> track;
+    for (Model& model : models) {
+        if (hasAsphaltPart(model)) {
+            keepTrackPositions(model);
+            track = meshRacingLine(model, model.name, computeModelMatrix(model));
+            break;
+        }
+    }
+    if (!track) {
+        track = builtinDriftTrack();
+    }
+
+    for (ObjectAnimation& animation : objectAnimations) {
+        if (animation.trackFromMesh && !animation.bezierTrack) {
+            animation.bezierTrack = track;
+        }
+    }
+}
+
+// Carrega a textura do material; na carga em fundo so decodifica e deixa o upload anotado
+static bool loadMaterialTexture(Material& material, const std::string& path) {
+    int width, height;
+    material.texturePath = path;
+    if (assetStaging == nullptr) {
+        material.textureID = loadTexture(path, width, height);
+        return material.textureID != 0;
+    }
+    StagedTexture staged;
+    staged.material = material.name;
+    {
+        PROFILE_SCOPE("Texture decode");
+        staged.pixels = stbi_load(path.c_str(), &staged.width, &staged.height, &staged.channels, 0);
+    }
+    if (staged.pixels == nullptr) {
+        LOG_ERROR("Failed to load texture " << path);
+    }
+    assetStaging->textures.push_back(staged);
+    return true;
+}
+
 void loadMaterialTextures(std::vector<Material>& materials, const std::string& mtlFile) {
     
     // Extrair diretório base do arquivo MTL
@@ -2010,9 +8824,7 @@ void loadMaterialTextures(std::vector<Material>& materials, const std::string& m
                 std::ifstream file(exactPath);
                 if (file.good()) {
                     file.close();
-                    int width, height;
-                    material.textureID = loadTexture(exactPath, width, height);
-                    if (material.textureID != 0) {
+                    if (loadMaterialTexture(material, exactPath)) {
                         found = true;
                         break;
                     }
@@ -2028,9 +8840,7 @@ void loadMaterialTextures(std::vector<Material>& materials, const std::string& m
                         std::ifstream file(altPath);
                         if (file.good()) {
                             file.close();
-                            int width, height;
-                            material.textureID = loadTexture(altPath, width, height);
-                            if (material.textureID != 0) {
+                            if (loadMaterialTexture(material, altPath)) {
                                 found = true;
                                 break;
                             }
@@ -0,0 +1,90 @@
+// Contagem de alocacoes por thread para o microbenchmark objload do GrauB2Bench.
+// Substitui o operator new/delete global, entao so entra no executavel de benchmark
+// (GRAUB2_COUNT_ALLOCATIONS). Fica numa unidade separada: com a definicao visivel no
+// GrauB2.cpp o compilador casava cada delete inline com o malloc e acusava
+// -Wmismatched-new-delete.
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static thread_local size_t allocationCount = 0;
+
+// Lido pelo GrauB2.cpp antes e depois de cada carga
+size_t allocationCounter() { return allocationCount; }
+
+static void* countedAlloc(size_t size) {
+    allocationCount++;
+    return malloc(size ? size : 1);
+}
+
+static void* countedAlignedAlloc(size_t size, std::align_val_t alignment) {
+    allocationCount++;
+    size_t align = (size_t)alignment;
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc exige tamanho multiplo do alinhamento
+    size_t rounded = ((size ? size : 1) + align - 1) & ~(align - 1);
+    return aligned_alloc(align, rounded);
+#endif
+}
+
+static void alignedFree(void* memory) {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+void* operator new(size_t size) {
+    void* memory = countedAlloc(size);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+void* operator new[](size_t size) {
+    void* memory = countedAlloc(size);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* memory = countedAlignedAlloc(size, alignment);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    void* memory = countedAlignedAlloc(size, alignment);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAlignedAlloc(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { free(memory); }
+
+void operator delete(void* memory, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(memory); }